@@ -0,0 +1,84 @@
+/* knapsack.c (solve 0-1 knapsack problem) */
+
+/***********************************************************************
+*  This code is part of GLPK (GNU Linear Programming Kit).
+*
+*  GLPK is free software: you can redistribute it and/or modify it
+*  under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  GLPK is distributed in the hope that it will be useful, but WITHOUT
+*  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+*  License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with GLPK. If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************/
+
+#include "env.h"
+#include "glpk.h"
+#include "ks.h"
+
+/***********************************************************************
+*  NAME
+*
+*  glp_knapsack - solve 0-1 knapsack problem
+*
+*  SYNOPSIS
+*
+*  int glp_knapsack(int n, const int a[], int b, const int c[],
+*     char x[], int meth, int *lim);
+*
+*  DESCRIPTION
+*
+*  The routine glp_knapsack solves 0-1 knapsack problem:
+*
+*     maximize z = sum{j in 1..n} c[j]x[j]
+*
+*         s.t. sum{j in 1..n} a[j]x[j] <= b
+*
+*              x[j] in {0, 1} for all j in 1..n
+*
+*  The instance is specified by parameters n, a[1..n], b, and c[1..n],
+*  which may have any sign, i.e. normalization is not needed.
+*
+*  The parameter meth specifies the method used:
+*
+*  GLP_KS_MT1    - Martello & Toth algorithm MT1 (optimal solution);
+*  GLP_KS_GREEDY - greedy heuristic (suboptimal solution).
+*
+*  If lim is not NULL and *lim > 0, the method MT1 performs at most
+*  *lim backtracking steps. If the limit is reached, the routine sets
+*  *lim to -1 and the point found is feasible, but not necessarily
+*  optimal. The parameter lim is ignored by the greedy heuristic.
+*
+*  On exit the routine stores the point found in locations x[1], ...,
+*  x[n].
+*
+*  RETURNS
+*
+*  The routine returns the objective value at the point found. However,
+*  if the instance is infeasible, the routine returns INT_MIN. */
+
+int glp_knapsack(int n, const int a[], int b, const int c[], char x[],
+      int meth, int *lim)
+{     int z = 0, nolim = 0;
+      if (n < 0)
+         xerror("glp_knapsack: n = %d; invalid number of items\n", n);
+      switch (meth)
+      {  case GLP_KS_MT1:
+            z = ks_mt1_lim(n, a, b, c, x, lim == NULL ? &nolim : lim);
+            break;
+         case GLP_KS_GREEDY:
+            z = ks_greedy(n, a, b, c, x);
+            break;
+         default:
+            xerror("glp_knapsack: meth = %d; invalid parameter\n",
+               meth);
+      }
+      return z;
+}
+
+/* eof */
@@ -1074,6 +1074,106 @@ void glp_load_matrix(glp_prob *lp, int ne, const int ia[],
       return;
 }
 
+/***********************************************************************
+*  NAME
+*
+*  glp_load_cols - load (replace) the whole constraint matrix by columns
+*
+*  SYNOPSIS
+*
+*  void glp_load_cols(glp_prob *lp, const int ptr[], const int ind[],
+*     const double val[]);
+*
+*  DESCRIPTION
+*
+*  The routine glp_load_cols loads the constraint matrix passed in the
+*  column-wise (compressed sparse column) format into the specified
+*  problem object. Before loading the current contents of the
+*  constraint matrix is destroyed.
+*
+*  Elements of j-th column, j = 1, ..., n, are stored in locations
+*  ind[k] (row index) and val[k] (numeric value), k = ptr[j], ...,
+*  ptr[j+1]-1, where n is the number of columns in the problem object.
+*  Thus, the array ptr must have 1+n+1 locations, ptr[1] = 1, and the
+*  total number of elements is ptr[n+1]-1.
+*
+*  Unlike glp_load_matrix, this routine builds the row and column lists
+*  directly in O(nnz) time without an intermediate triplet list and
+*  does NOT check for elements with identical indices, which must not
+*  be present (if necessary, the matrix can be checked in advance with
+*  glp_check_dup). Zero coefficients are allowed, however, they are not
+*  stored in the constraint matrix. */
+
+void glp_load_cols(glp_prob *lp, const int ptr[], const int ind[],
+      const double val[])
+{     glp_tree *tree = lp->tree;
+      GLPROW *row;
+      GLPCOL *col;
+      GLPAIJ *aij;
+      int i, j, k, ne;
+      if (tree != NULL && tree->reason != 0)
+         xerror("glp_load_cols: operation not allowed\n");
+      /* clear the constraint matrix */
+      for (i = 1; i <= lp->m; i++)
+      {  row = lp->row[i];
+         while (row->ptr != NULL)
+         {  aij = row->ptr;
+            row->ptr = aij->r_next;
+            dmp_free_atom(lp->pool, aij, sizeof(GLPAIJ)), lp->nnz--;
+         }
+      }
+      xassert(lp->nnz == 0);
+      for (j = 1; j <= lp->n; j++) lp->col[j]->ptr = NULL;
+      if (lp->n == 0) goto done;
+      /* check the column pointers */
+      if (ptr[1] != 1)
+         xerror("glp_load_cols: ptr[1] = %d; invalid column pointer\n",
+            ptr[1]);
+      for (j = 1; j <= lp->n; j++)
+      {  if (ptr[j+1] < ptr[j])
+            xerror("glp_load_cols: ptr[%d] = %d; invalid column pointe"
+               "r\n", j+1, ptr[j+1]);
+      }
+      ne = ptr[lp->n+1] - 1;
+      if (ne > NNZ_MAX)
+         xerror("glp_load_cols: ne = %d; too many constraint coefficie"
+            "nts\n", ne);
+      /* load the new contents of the constraint matrix; elements of
+         each column are added in reverse order to the beginning of the
+         column list, so the list keeps the order of the array ind */
+      for (j = 1; j <= lp->n; j++)
+      {  col = lp->col[j];
+         for (k = ptr[j+1] - 1; k >= ptr[j]; k--)
+         {  if (val[k] == 0.0) continue;
+            /* obtain pointer to i-th row */
+            i = ind[k];
+            if (!(1 <= i && i <= lp->m))
+               xerror("glp_load_cols: ind[%d] = %d; row index out of ra"
+                  "nge\n", k, i);
+            row = lp->row[i];
+            /* create new element */
+            aij = dmp_get_atom(lp->pool, sizeof(GLPAIJ)), lp->nnz++;
+            aij->row = row;
+            aij->col = col;
+            aij->val = val[k];
+            /* add the new element to the beginning of i-th row list */
+            aij->r_prev = NULL;
+            aij->r_next = row->ptr;
+            if (aij->r_next != NULL) aij->r_next->r_prev = aij;
+            row->ptr = aij;
+            /* add the new element to the beginning of j-th column
+               list */
+            aij->c_prev = NULL;
+            aij->c_next = col->ptr;
+            if (aij->c_next != NULL) aij->c_next->c_prev = aij;
+            col->ptr = aij;
+         }
+      }
+done: /* invalidate the basis factorization */
+      lp->valid = 0;
+      return;
+}
+
 /***********************************************************************
 *  NAME
 *
@@ -0,0 +1,128 @@
+/* rand.c (pseudo-random number generator) */
+
+/***********************************************************************
+*  This code is part of GLPK (GNU Linear Programming Kit).
+*
+*  GLPK is free software: you can redistribute it and/or modify it
+*  under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  GLPK is distributed in the hope that it will be useful, but WITHOUT
+*  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+*  License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with GLPK. If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************/
+
+#include "env.h"
+#include "glpk.h"
+#include "rng.h"
+
+/***********************************************************************
+*  NAME
+*
+*  glp_rng_create - create pseudo-random number generator
+*
+*  SYNOPSIS
+*
+*  glp_rng *glp_rng_create(int seed);
+*
+*  DESCRIPTION
+*
+*  The routine glp_rng_create creates Knuth's portable pseudo-random
+*  number generator (see misc/rng.c) and initializes it with the seed
+*  specified. Every generator is an independent stream, so different
+*  threads may use different generators at the same time. However, the
+*  generator is allocated in the GLPK environment of the calling thread
+*  and therefore must be used and deleted by that thread.
+*
+*  RETURNS
+*
+*  The routine returns a pointer to the generator created. */
+
+glp_rng *glp_rng_create(int seed)
+{     RNG *rand;
+      rand = rng_create_rand();
+      rng_init_rand(rand, seed);
+      return (glp_rng *)rand;
+}
+
+/***********************************************************************
+*  NAME
+*
+*  glp_rng_init - reinitialize pseudo-random number generator
+*
+*  SYNOPSIS
+*
+*  void glp_rng_init(glp_rng *rng, int seed);
+*
+*  DESCRIPTION
+*
+*  The routine glp_rng_init restarts the generator with a new seed. */
+
+void glp_rng_init(glp_rng *rng, int seed)
+{     rng_init_rand((RNG *)rng, seed);
+      return;
+}
+
+/***********************************************************************
+*  NAME
+*
+*  glp_rng_unif - obtain pseudo-random integer in the range [0, m-1]
+*
+*  SYNOPSIS
+*
+*  int glp_rng_unif(glp_rng *rng, int m);
+*
+*  RETURNS
+*
+*  The routine returns a next pseudo-random integer uniformly
+*  distributed in the range [0, m-1], where 1 <= m < 2^31. */
+
+int glp_rng_unif(glp_rng *rng, int m)
+{     if (m < 1)
+         xerror("glp_rng_unif: m = %d; invalid parameter\n", m);
+      return rng_unif_rand((RNG *)rng, m);
+}
+
+/***********************************************************************
+*  NAME
+*
+*  glp_rng_unif_01 - obtain pseudo-random number in the range [0, 1]
+*
+*  SYNOPSIS
+*
+*  double glp_rng_unif_01(glp_rng *rng);
+*
+*  RETURNS
+*
+*  The routine returns a next pseudo-random number uniformly
+*  distributed in the range [0, 1]. */
+
+double glp_rng_unif_01(glp_rng *rng)
+{     return rng_unif_01((RNG *)rng);
+}
+
+/***********************************************************************
+*  NAME
+*
+*  glp_rng_delete - delete pseudo-random number generator
+*
+*  SYNOPSIS
+*
+*  void glp_rng_delete(glp_rng *rng);
+*
+*  DESCRIPTION
+*
+*  The routine glp_rng_delete frees all the memory allocated to the
+*  generator. */
+
+void glp_rng_delete(glp_rng *rng)
+{     rng_delete_rand((RNG *)rng);
+      return;
+}
+
+/* eof */
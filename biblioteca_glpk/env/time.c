@@ -126,6 +126,60 @@ double glp_time(void)
 
 #endif
 
+/***********************************************************************
+*  NAME
+*
+*  glp_mono_time - determine current monotonic time
+*
+*  SYNOPSIS
+*
+*  double glp_mono_time(void);
+*
+*  RETURNS
+*
+*  The routine glp_mono_time returns the time, in milliseconds (with
+*  sub-millisecond resolution), elapsed since an arbitrary fixed point.
+*  Unlike glp_time it is not affected by changes of the system clock,
+*  so it should be used to measure intervals (with glp_difftime).
+*  Where no monotonic clock is available it falls back to glp_time. */
+
+#include <time.h>
+
+double glp_mono_time(void)
+{
+#if defined(CLOCK_MONOTONIC)
+      struct timespec ts;
+      if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+         return 1000.0 * (double)ts.tv_sec + (double)ts.tv_nsec / 1e6;
+#endif
+      return glp_time();
+}
+
+/***********************************************************************
+*  NAME
+*
+*  glp_cpu_time - determine CPU time used by the calling thread
+*
+*  SYNOPSIS
+*
+*  double glp_cpu_time(void);
+*
+*  RETURNS
+*
+*  The routine glp_cpu_time returns the CPU time, in milliseconds, used
+*  so far by the calling thread. Where per-thread CPU time is not
+*  available, the CPU time of the whole process is returned. */
+
+double glp_cpu_time(void)
+{
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+      struct timespec ts;
+      if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+         return 1000.0 * (double)ts.tv_sec + (double)ts.tv_nsec / 1e6;
+#endif
+      return 1000.0 * (double)clock() / (double)CLOCKS_PER_SEC;
+}
+
 /***********************************************************************
 *  NAME
 *
@@ -349,6 +349,10 @@ void glp_load_matrix(glp_prob *P, int ne, const int ia[],
       const int ja[], const double ar[]);
 /* load (replace) the whole constraint matrix */
 
+void glp_load_cols(glp_prob *P, const int ptr[], const int ind[],
+      const double val[]);
+/* load (replace) the whole constraint matrix by columns */
+
 int glp_check_dup(int m, int n, int ne, const int ia[], const int ja[]);
 /* check for duplicate elements in sparse matrix */
 
@@ -951,6 +955,12 @@ void glp_mem_usage(int *count, int *cpeak, size_t *total,
 double glp_time(void);
 /* determine current universal time */
 
+double glp_mono_time(void);
+/* determine current monotonic time */
+
+double glp_cpu_time(void);
+/* determine CPU time used by the calling thread */
+
 double glp_difftime(double t1, double t0);
 /* compute difference between two time values */
 
@@ -1164,6 +1174,31 @@ int glp_top_sort(glp_graph *G, int v_num);
 int glp_wclique_exact(glp_graph *G, int v_wgt, double *sol, int v_set);
 /* find maximum weight clique with exact algorithm */
 
+#define GLP_KS_MT1         1  /* Martello & Toth algorithm MT1 */
+#define GLP_KS_GREEDY      2  /* greedy heuristic */
+
+int glp_knapsack(int n, const int a[], int b, const int c[], char x[],
+      int meth, int *lim);
+/* solve 0-1 knapsack problem */
+
+typedef struct glp_rng glp_rng;
+/* pseudo-random number generator */
+
+glp_rng *glp_rng_create(int seed);
+/* create pseudo-random number generator */
+
+void glp_rng_init(glp_rng *rng, int seed);
+/* reinitialize pseudo-random number generator */
+
+int glp_rng_unif(glp_rng *rng, int m);
+/* obtain pseudo-random integer in the range [0, m-1] */
+
+double glp_rng_unif_01(glp_rng *rng);
+/* obtain pseudo-random number in the range [0, 1] */
+
+void glp_rng_delete(glp_rng *rng);
+/* delete pseudo-random number generator */
+
 #ifdef __cplusplus
 }
 #endif
@@ -292,6 +292,12 @@ static void free_ks(struct ks *ks)
 *  x[1], ..., x[n] and returns the optimal objective value. However, if
 *  the instance is infeasible, the routine returns INT_MIN.
 *
+*  The routine ks_mt1_lim is the same as ks_mt1, except that at most
+*  *lim backtracking steps of MT1 are performed (no limit if *lim <= 0).
+*  If the limit is reached, *lim is set to -1 and the point returned is
+*  the best one found so far, which is feasible but not necessarily
+*  optimal.
+*
 *  REFERENCES
 *
 *  S.Martello, P.Toth. Knapsack Problems: Algorithms and Computer Imp-
@@ -311,7 +317,8 @@ static int CDECL fcmp(const void *p1, const void *p2)
          return 0;
 }
 
-static int mt1a(int n, const int a[], int b, const int c[], char x[])
+static int mt1a(int n, const int a[], int b, const int c[], char x[],
+      int *lim)
 {     /* interface routine to MT1 */
       struct mt *mt;
       int j, z, *p, *w, *x1, *xx, *min, *psign, *wsign, *zsign;
@@ -338,7 +345,7 @@ static int mt1a(int n, const int a[], int b, const int c[], char x[])
          w[j] = a[mt[j].j];
       }
       /* find optimal solution */
-      z = mt1(n, p, w, b, x1, 1, xx, min, psign, wsign, zsign);
+      z = mt1(n, p, w, b, x1, 1, xx, min, psign, wsign, zsign, lim);
       xassert(z >= 0);
       /* store optimal point found */
       for (j = 1; j <= n; j++)
@@ -360,6 +367,12 @@ static int mt1a(int n, const int a[], int b, const int c[], char x[])
 
 int ks_mt1(int n, const int a[/*1+n*/], int b, const int c[/*1+n*/],
       char x[/*1+n*/])
+{     int lim = 0;
+      return ks_mt1_lim(n, a, b, c, x, &lim);
+}
+
+int ks_mt1_lim(int n, const int a[/*1+n*/], int b,
+      const int c[/*1+n*/], char x[/*1+n*/], int *lim)
 {     struct ks *ks;
       int j, s1, s2, z;
       xassert(n >= 0);
@@ -371,7 +384,7 @@ int ks_mt1(int n, const int a[/*1+n*/], int b, const int c[/*1+n*/],
       }
       /* find optimal solution to reduced instance */
       if (ks->n > 0)
-         mt1a(ks->n, ks->a, ks->b, ks->c, x);
+         mt1a(ks->n, ks->a, ks->b, ks->c, x, lim);
       /* restore solution to original instance */
       z = restore(ks, x);
       memcpy(&x[1], &ks->x[1], n * sizeof(char));
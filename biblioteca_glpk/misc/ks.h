@@ -32,6 +32,11 @@ int ks_mt1(int n, const int a[/*1+n*/], int b, const int c[/*1+n*/],
       char x[/*1+n*/]);
 /* solve 0-1 knapsack problem with Martello & Toth algorithm */
 
+#define ks_mt1_lim _glp_ks_mt1_lim
+int ks_mt1_lim(int n, const int a[/*1+n*/], int b,
+      const int c[/*1+n*/], char x[/*1+n*/], int *lim);
+/* same as ks_mt1 with limited number of backtracking steps */
+
 #define ks_greedy _glp_ks_greedy
 int ks_greedy(int n, const int a[/*1+n*/], int b, const int c[/*1+n*/],
       char x[/*1+n*/]);
@@ -60,18 +60,25 @@ static
 #endif
 /* Subroutine */ int mt1_(integer *n, integer *p, integer *w, integer *c__,
 	integer *z__, integer *x, integer *jdim, integer *jck, integer *xx,
-	integer *min__, integer *psign, integer *wsign, integer *zsign)
+	integer *min__, integer *psign, integer *wsign, integer *zsign
+#if 1 /* backtracking limit */
+	, integer *maxbt
+#endif
+	)
 {
     /* System generated locals */
     integer i__1;
 
     /* Local variables */
-    static real a, b;
-    static integer j, r__, t, j1, n1, ch, ii, jj, kk, in, ll, ip, nn, iu, ii1,
+#if 1 /* locals are automatic to make the routine reentrant */
+    real a, b;
+    integer j, r__, t, j1, n1, ch, ii, jj, kk, in, ll, ip, nn, iu, ii1,
 	     chs, lim, lim1, diff, lold, mink;
     extern /* Subroutine */ int chmt1_(integer *, integer *, integer *,
 	    integer *, integer *, integer *);
-    static integer profit;
+    integer profit;
+    integer nbt = 0;
+#endif
 
 
 /* THIS SUBROUTINE SOLVES THE 0-1 SINGLE KNAPSACK PROBLEM */
@@ -697,6 +704,12 @@ L270:
 /*<   280 NN = II - 1 >*/
 #line 191 ""
 L280:
+#if 1 /* backtracking limit */
+    if (*maxbt > 0 && ++nbt > *maxbt) {
+	*maxbt = -1;
+	return 0;
+    }
+#endif
 #line 191 ""
     nn = ii - 1;
 /*<       IF ( NN .EQ. 0 ) RETURN >*/
@@ -952,9 +965,9 @@ static
     integer i__1;
 
     /* Local variables */
-    static integer j;
-    static real r__, rr;
-    static integer jsw;
+    integer j;
+    real r__, rr;
+    integer jsw;
 
 
 /* CHECK THE INPUT DATA. */
@@ -1089,11 +1102,14 @@ L50:
 
 #if 1 /* by mao */
 int mt1(int n, int p[], int w[], int c, int x[], int jck, int xx[],
-      int min[], int psign[], int wsign[], int zsign[])
+      int min[], int psign[], int wsign[], int zsign[], int *lim)
 {     /* solve 0-1 knapsack problem */
       int z, jdim = n+1, j, s1, s2;
+      /* if the search is interrupted, x keeps the best point found */
+      for (j = 1; j <= n; j++)
+         x[j] = 0;
       mt1_(&n, &p[1], &w[1], &c, &z, &x[1], &jdim, &jck, &xx[1],
-         &min[1], &psign[1], &wsign[1], &zsign[1]);
+         &min[1], &psign[1], &wsign[1], &zsign[1], lim);
       /* check solution found */
       s1 = s2 = 0;
       for (j = 1; j <= n; j++)
@@ -24,8 +24,10 @@
 
 #define mt1 _glp_mt1
 int mt1(int n, int p[], int w[], int c, int x[], int jck, int xx[],
-      int min[], int psign[], int wsign[], int zsign[]);
-/* solve 0-1 single knapsack problem */
+      int min[], int psign[], int wsign[], int zsign[], int *lim);
+/* solve 0-1 single knapsack problem; if *lim > 0, at most *lim
+   backtracking steps are done and *lim is set to -1 when the limit is
+   reached (the point found is then not proven optimal) */
 
 #endif
 
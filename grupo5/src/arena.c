@@ -0,0 +1,181 @@
+/* arena.c
+memoria de trabalho das heuristicas e da carga dos modelos
+
+Os metodos (heuristicas, busca local, carga dos modelos do GLPK,
+preprocessamento, heuristica e cortes nos nos, bb_mkp, lagrangiana, geracao
+de colunas e programacao dinamica) alocam vetores de trabalho que vivem so
+durante a chamada. Em vez de um malloc/free para cada vetor, eles saem de
+uma arena: um bloco de memoria
+reservado uma vez, do qual cada alocacao toma os bytes seguintes. Quem aloca
+marca a arena antes (arena_marca) e a devolve de uma vez no fim (arena_volta),
+em O(1) e na ordem inversa das marcas (pilha).
+
+Cada thread que executa metodos (a principal, as do modo em lote e as do modo
+servico) tem a sua arena, passada aos metodos em info->arena. No inicio de
+cada instancia, arena_prepara zera a arena em O(1) e garante um primeiro bloco
+do tamanho estimado para (n, k), de modo que, entre instancias de tamanho
+parecido, nenhum bloco novo eh alocado. Se a estimativa nao bastar, blocos
+extras sao encadeados e, na instancia seguinte, trocados por um bloco unico.
+As threads criadas pelos metodos (multi-start, portfolio) tem arenas proprias,
+cujos picos sao somados ao da arena do metodo (arena_pico_auxiliar). As
+threads da lagrangiana nao alocam: as suas areas de trabalho saem da arena da
+thread principal antes de elas comecarem.
+
+Ficam fora da arena so as estruturas que crescem sem tamanho conhecido: o pool
+de colunas da geracao de colunas e as camadas e tabelas da programacao
+dinamica, cujos tamanhos tambem sao somados ao pico (arena_pico_auxiliar).
+A memoria interna do GLPK nao eh contada.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "mochila_multipla.h"
+
+#define ARENA_ALINHAMENTO 16 /* alinhamento de cada alocacao (em bytes) */
+
+// estimativa da memoria de trabalho para n itens e k mochilas: os vetores
+// de triplas do modelo (28 bytes por coluna) ou a relaxacao e a solucao
+// inicial da gulosa melhorada (16 bytes por coluna), mais os vetores
+// separados dos itens e a ordenacao (48 bytes por item) e as arvores das
+// capacidades (28 bytes por mochila)
+#define ARENA_ESTIMATIVA(n, k) (32 * (size_t)(n) * (k) + 64 * (size_t)(n) + 32 * (size_t)(k) + 4096)
+
+#define ALINHA(t) (((t) + ARENA_ALINHAMENTO - 1) & ~(size_t)(ARENA_ALINHAMENTO - 1))
+
+struct Tbloco
+{
+  Tbloco *prox;
+  size_t tam; /* bytes uteis do bloco */
+};
+
+/* bytes uteis de b (depois do cabecalho alinhado) */
+static char *dados(Tbloco *b)
+{
+  return (char *)b + ALINHA(sizeof(Tbloco));
+}
+
+static Tbloco *novo_bloco(Tarena *A, size_t tam)
+{
+  Tbloco *b = (Tbloco *)malloc(ALINHA(sizeof(Tbloco)) + tam);
+
+  if (b == NULL)
+    return NULL;
+  b->prox = NULL;
+  b->tam = tam;
+  A->reservada += tam;
+  return b;
+}
+
+/* arena vazia, sem blocos */
+void arena_cria(Tarena *A)
+{
+  A->primeiro = A->atual = NULL;
+  A->usado = A->em_uso = A->pico = A->reservada = 0;
+}
+
+/* libera os blocos */
+void arena_libera(Tarena *A)
+{
+  Tbloco *b, *prox;
+
+  for (b = A->primeiro; b != NULL; b = prox)
+  {
+    prox = b->prox;
+    free(b);
+  }
+  arena_cria(A);
+}
+
+/* zera a arena para uma instancia de n itens e k mochilas; o primeiro bloco
+   so eh trocado se for menor que a estimativa ou se houver blocos extras */
+void arena_prepara(Tarena *A, int n, int k)
+{
+  size_t tam = ARENA_ESTIMATIVA(n, k);
+
+  if (A->primeiro == NULL || A->primeiro->tam < tam || A->primeiro->prox != NULL)
+  {
+    if (A->reservada > tam)
+      tam = A->reservada;
+    arena_libera(A);
+    A->primeiro = novo_bloco(A, tam);
+  }
+  A->atual = A->primeiro;
+  A->usado = A->em_uso = A->pico = 0;
+}
+
+/* tam bytes da arena (NULL se faltar memoria) */
+void *arena_aloca(Tarena *A, size_t tam)
+{
+  Tbloco *b;
+  char *p;
+
+  tam = ALINHA(tam);
+  if (A->atual == NULL || A->usado + tam > A->atual->tam)
+  {
+    // o bloco seguinte, se couber, ou um bloco novo depois do atual
+    b = (A->atual != NULL) ? A->atual->prox : A->primeiro;
+    if (b == NULL || b->tam < tam)
+    {
+      b = novo_bloco(A, tam > A->reservada ? tam : A->reservada);
+      if (b == NULL)
+        return NULL;
+      if (A->atual != NULL)
+      {
+        b->prox = A->atual->prox;
+        A->atual->prox = b;
+      }
+      else
+      {
+        b->prox = A->primeiro;
+        A->primeiro = b;
+      }
+    }
+    A->atual = b;
+    A->usado = 0;
+  }
+  p = dados(A->atual) + A->usado;
+  A->usado += tam;
+  A->em_uso += tam;
+  if (A->em_uso > A->pico)
+    A->pico = A->em_uso;
+  return p;
+}
+
+/* tam bytes zerados da arena */
+void *arena_aloca_zerada(Tarena *A, size_t tam)
+{
+  void *p = arena_aloca(A, tam);
+
+  if (p != NULL)
+    memset(p, 0, tam);
+  return p;
+}
+
+/* posicao atual da arena */
+Tmarca arena_marca(Tarena *A)
+{
+  Tmarca m;
+
+  m.bloco = A->atual;
+  m.usado = A->usado;
+  m.em_uso = A->em_uso;
+  return m;
+}
+
+/* devolve tudo o que foi alocado depois da marca m */
+void arena_volta(Tarena *A, Tmarca m)
+{
+  A->atual = m.bloco;
+  A->usado = m.usado;
+  A->em_uso = m.em_uso;
+}
+
+/* soma ao pico de A o pico das arenas das threads auxiliares de um metodo
+   (que usaram a sua memoria ao mesmo tempo que a de A) */
+void arena_pico_auxiliar(Tarena *A, size_t pico)
+{
+  if (A->em_uso + pico > A->pico)
+    A->pico = A->em_uso + pico;
+}
+
+/* eof */
@@ -0,0 +1,440 @@
+/* bb_mkp.c
+branch-and-bound especifico para a mochila multipla (tipo 7), no estilo do
+algoritmo MTM de Martello e Toth.
+
+Os itens sao decididos um a um, em ordem decrescente de valor/peso. Em cada no
+o item da vez eh colocado em cada mochila em que cabe (mochilas com a mesma
+capacidade residual sao equivalentes e so a primeira eh tentada) ou deixado de
+fora. O limitante superior do no eh dado pela relaxacao surrogate (todas as
+mochilas viram uma unica mochila com a soma das capacidades residuais):
+primeiro o limitante de Dantzig (relaxacao linear da surrogate) e, se ele nao
+podar o no, a surrogate inteira resolvida por MT1 (glp_knapsack). O MT1 tem
+um limite de retrocessos (BB_MT1_LIMITE); se ele for atingido, o no fica so
+com o limitante de Dantzig. Se os itens
+escolhidos pela surrogate couberem nas mochilas (first-fit decrescente), a
+solucao eh viavel e otima para o no, que nao precisa ser ramificado.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <glpk.h>
+#include "mochila_multipla.h"
+
+#define BB_CHECA_TEMPO 16     /* nos entre duas consultas ao relogio */
+#define BB_MT1_LIMITE 20000   /* retrocessos de cada chamada do MT1 */
+
+// estado do branch-and-bound
+typedef struct
+{
+  Tinstance I;
+  int n;            /* total de itens considerados (os que cabem em alguma mochila) */
+  int *ord;         /* itens considerados em ordem decrescente de valor/peso */
+  int *res;         /* capacidade residual de cada mochila */
+  int *sol;         /* mochila de cada item no caminho atual (0 = fora) */
+  int *melhor;      /* mochila de cada item na melhor solucao */
+  double z_melhor;  /* valor da melhor solucao */
+  int inteiro;      /* 1 se todos os valores sao inteiros */
+  // area de trabalho da surrogate (vetores de 1 a n, como no glp_knapsack)
+  int *a, *c, *pos;
+  char *x;
+  int *escolhidos, *aux_res, *ordm;
+  Tchave *chaves;
+  // controle
+  double inicio, limite;
+  int parou;        /* 1 se o tempo limite foi atingido */
+  int nos;          /* nos explorados */
+  int abertos;      /* nos deixados sem explorar por causa do tempo limite */
+  double ub_aberto; /* maior limitante entre os nos deixados sem explorar */
+} Tbb;
+
+/* verifica se o no com limitante ub pode ser podado */
+static int poda(Tbb *B, double ub)
+{
+  if (B->inteiro)
+    ub = floor(ub + EPSILON);
+  return ub <= B->z_melhor + EPSILON;
+}
+
+/* guarda a solucao do caminho atual como a melhor encontrada */
+static void atualiza_melhor(Tbb *B, double z)
+{
+  memcpy(B->melhor, B->sol, sizeof(int) * B->I.n);
+  B->z_melhor = z;
+  PRINTF("bb_mkp: nova solucao %.0lf (nos=%d)\n", z, B->nos);
+}
+
+/* maior capacidade residual e soma das capacidades residuais */
+static int residuais(Tbb *B, long long *soma)
+{
+  int j, max = 0;
+
+  *soma = 0;
+  for (j = 0; j < B->I.k; j++)
+  {
+    *soma += B->res[j];
+    if (B->res[j] > max)
+      max = B->res[j];
+  }
+  return max;
+}
+
+/* limitante de Dantzig da surrogate dos itens ord[d..n-1] */
+static double limite_dantzig(Tbb *B, int d)
+{
+  long long cap;
+  double ub = 0.0;
+  int t, i, max;
+
+  max = residuais(B, &cap);
+  for (t = d; t < B->n && cap > 0; t++)
+  {
+    i = B->ord[t];
+    if (B->I.item[i].peso > max)
+      continue; // nao cabe em nenhuma mochila
+    if (B->I.item[i].peso <= cap)
+    {
+      cap -= B->I.item[i].peso;
+      ub += B->I.item[i].valor;
+    }
+    else
+    {
+      ub += B->I.item[i].valor * cap / B->I.item[i].peso;
+      break;
+    }
+  }
+  return ub;
+}
+
+/* tenta colocar os itens escolhidos pela surrogate nas mochilas (first-fit
+   decrescente); se conseguir, completa sol e devolve 1 */
+static int empacota(Tbb *B, int m)
+{
+  int t, j, i;
+
+  for (t = 0; t < m; t++)
+  {
+    B->chaves[t].chave = B->I.item[B->escolhidos[t]].peso;
+    B->chaves[t].i = B->escolhidos[t];
+  }
+  qsort(B->chaves, m, sizeof(Tchave), comparador_chave);
+  for (t = 0; t < m; t++)
+    B->escolhidos[t] = B->chaves[t].i;
+  memcpy(B->aux_res, B->res, sizeof(int) * B->I.k);
+  for (t = 0; t < m; t++)
+  {
+    i = B->escolhidos[t];
+    for (j = 0; j < B->I.k && B->aux_res[j] < B->I.item[i].peso; j++)
+      ;
+    if (j == B->I.k)
+    {
+      // desfaz as atribuicoes
+      while (--t >= 0)
+        B->sol[B->escolhidos[t]] = 0;
+      return 0;
+    }
+    B->aux_res[j] -= B->I.item[i].peso;
+    B->sol[i] = j + 1;
+  }
+  return 1;
+}
+
+/* limitante da surrogate inteira dos itens ord[d..n-1] (MT1); se a solucao da
+   surrogate for viavel para as mochilas, *resolvido recebe 1. Se o MT1 for
+   interrompido, ou se a capacidade ou as somas dos pesos e dos valores nao
+   couberem em int (os tipos do MT1), devolve ub_lp (limitante de Dantzig do
+   no) */
+static double limite_surrogate(Tbb *B, int d, double zc, double ub_lp, int *resolvido)
+{
+  long long cap, soma_peso = 0, soma_valor = 0;
+  double ub = 0.0, valor = 0.0;
+  int t, i, m = 0, max, z, lim = BB_MT1_LIMITE;
+
+  *resolvido = 0;
+  max = residuais(B, &cap);
+  for (t = d; t < B->n; t++)
+  {
+    i = B->ord[t];
+    if (B->I.item[i].peso > max)
+      continue;
+    m++;
+    B->pos[m] = i;
+    B->a[m] = B->I.item[i].peso;
+    B->c[m] = (int)ceil(B->I.item[i].valor - EPSILON);
+    soma_peso += B->a[m];
+    soma_valor += B->c[m];
+  }
+  if (m == 0)
+  {
+    *resolvido = 1;
+    return 0.0;
+  }
+  if (soma_peso <= cap)
+    memset(&B->x[1], 1, m); // todos os itens cabem na surrogate
+  else if (soma_peso > INT_MAX || soma_valor > INT_MAX)
+    return ub_lp; // cap < soma_peso: o MT1 somaria alem de int
+  else
+    glp_knapsack(m, B->a, (int)cap, B->c, B->x, GLP_KS_MT1, &lim);
+
+  z = 0;
+  for (t = 1; t <= m; t++)
+  {
+    if (B->x[t])
+    {
+      B->escolhidos[z++] = B->pos[t];
+      ub += B->c[t];
+      valor += B->I.item[B->pos[t]].valor;
+    }
+  }
+
+  // a solucao da surrogate cabe nas mochilas? entao eh viavel e, com
+  // valores inteiros, otima para o no
+  if (empacota(B, z))
+  {
+    if (zc + valor > B->z_melhor + EPSILON)
+      atualiza_melhor(B, zc + valor);
+    for (t = 0; t < z; t++)
+      B->sol[B->escolhidos[t]] = 0;
+    *resolvido = B->inteiro && lim != -1;
+  }
+  return (lim == -1) ? ub_lp : ub;
+}
+
+/* limitante inferior de MTM: enche as mochilas uma a uma, em ordem crescente
+   de capacidade residual, resolvendo uma mochila 0-1 (MT1) para cada uma com
+   os itens ord[d..n-1] ainda nao usados; atualiza a melhor solucao */
+static double heuristica_mtm(Tbb *B, int d, double zc)
+{
+  double valor = 0.0;
+  long long soma_peso, soma_valor;
+  int t, j, m, i, usados = 0, lim, resto;
+
+  // mochilas em ordem crescente de capacidade residual
+  for (j = 0; j < B->I.k; j++)
+  {
+    B->chaves[j].chave = -B->res[j];
+    B->chaves[j].i = j;
+  }
+  qsort(B->chaves, B->I.k, sizeof(Tchave), comparador_chave);
+  for (j = 0; j < B->I.k; j++)
+    B->ordm[j] = B->chaves[j].i;
+
+  for (t = 0; t < B->I.k; t++)
+  {
+    j = B->ordm[t];
+    m = 0;
+    soma_peso = soma_valor = 0;
+    for (i = d; i < B->n; i++)
+    {
+      if (B->sol[B->ord[i]] == 0 && B->I.item[B->ord[i]].peso <= B->res[j])
+      {
+        m++;
+        B->pos[m] = B->ord[i];
+        B->a[m] = B->I.item[B->ord[i]].peso;
+        B->c[m] = (int)ceil(B->I.item[B->ord[i]].valor - EPSILON);
+        soma_peso += B->a[m];
+        soma_valor += B->c[m];
+      }
+    }
+    if (m == 0)
+      continue;
+    if (soma_peso > INT_MAX || soma_valor > INT_MAX)
+    {
+      // o MT1 somaria alem de int: os itens entram em ordem de valor/peso
+      resto = B->res[j];
+      for (i = 1; i <= m; i++)
+      {
+        B->x[i] = (B->a[i] <= resto);
+        if (B->x[i])
+          resto -= B->a[i];
+      }
+    }
+    else
+    {
+      lim = BB_MT1_LIMITE;
+      glp_knapsack(m, B->a, B->res[j], B->c, B->x, GLP_KS_MT1, &lim);
+    }
+    for (i = 1; i <= m; i++)
+    {
+      if (B->x[i])
+      {
+        B->sol[B->pos[i]] = j + 1;
+        B->escolhidos[usados++] = B->pos[i];
+        valor += B->I.item[B->pos[i]].valor;
+      }
+    }
+  }
+
+  if (zc + valor > B->z_melhor + EPSILON)
+    atualiza_melhor(B, zc + valor);
+  for (t = 0; t < usados; t++)
+    B->sol[B->escolhidos[t]] = 0;
+  return valor;
+}
+
+/* registra um no que nao sera explorado por causa do tempo limite */
+static void no_aberto(Tbb *B, double ub)
+{
+  B->abertos++;
+  if (ub > B->ub_aberto)
+    B->ub_aberto = ub;
+}
+
+/* explora o no em que os itens ord[0..d-1] ja foram decididos */
+static void bb_no(Tbb *B, int d, double zc)
+{
+  int i, j, j2, p, repetida, resolvido;
+  double ub, ub_lp;
+
+  B->nos++;
+  if (zc > B->z_melhor + EPSILON)
+    atualiza_melhor(B, zc);
+  if (d == B->n)
+    return;
+
+  if (B->nos % BB_CHECA_TEMPO == 0 && glp_difftime(glp_mono_time(), B->inicio) * 1000 >= B->limite)
+    B->parou = 1;
+
+  // limitantes
+  ub_lp = limite_dantzig(B, d);
+  if (poda(B, zc + ub_lp))
+    return;
+  ub = zc + limite_surrogate(B, d, zc, ub_lp, &resolvido);
+  if (resolvido || poda(B, ub))
+    return;
+  // limitante inferior (heuristica de MTM): se atingir o superior, o no
+  // esta resolvido
+  heuristica_mtm(B, d, zc);
+  if (poda(B, ub))
+    return;
+
+  // ramifica sobre a mochila do item ord[d]
+  i = B->ord[d];
+  p = B->I.item[i].peso;
+  for (j = 0; j < B->I.k; j++)
+  {
+    if (B->res[j] < p)
+      continue;
+    // mochilas com a mesma capacidade residual levam a subproblemas iguais
+    repetida = 0;
+    for (j2 = 0; j2 < j && !repetida; j2++)
+      repetida = (B->res[j2] == B->res[j]);
+    if (repetida)
+      continue;
+
+    B->res[j] -= p;
+    B->sol[i] = j + 1;
+    if (B->parou)
+      no_aberto(B, zc + B->I.item[i].valor + limite_dantzig(B, d + 1));
+    else
+      bb_no(B, d + 1, zc + B->I.item[i].valor);
+    B->sol[i] = 0;
+    B->res[j] += p;
+  }
+
+  // item fora das mochilas
+  if (B->parou)
+    no_aberto(B, zc + limite_dantzig(B, d + 1));
+  else
+    bb_no(B, d + 1, zc);
+}
+
+/* resolve a instancia com o branch-and-bound especifico; a melhor solucao
+   encontrada fica em I.item[].index e os limitantes em info */
+double bb_mkp(Tinstance I, double limite, my_infoT *info)
+{
+  Tbb B;
+  int i, j, maxC;
+  double ub;
+  Tarena *A = info->arena;
+  Tmarca m = arena_marca(A);
+
+  B.I = I;
+  B.limite = limite;
+  B.inicio = glp_mono_time();
+  B.parou = 0;
+  B.nos = 0;
+  B.abertos = 0;
+  B.ub_aberto = 0.0;
+
+  B.ord = (int *)arena_aloca(A, sizeof(int) * I.n);
+  B.res = (int *)arena_aloca(A, sizeof(int) * I.k);
+  B.sol = (int *)arena_aloca_zerada(A, sizeof(int) * I.n);
+  B.melhor = (int *)arena_aloca_zerada(A, sizeof(int) * I.n);
+  B.a = (int *)arena_aloca(A, sizeof(int) * (I.n + 1));
+  B.c = (int *)arena_aloca(A, sizeof(int) * (I.n + 1));
+  B.pos = (int *)arena_aloca(A, sizeof(int) * (I.n + 1));
+  B.x = (char *)arena_aloca(A, sizeof(char) * (I.n + 1));
+  B.escolhidos = (int *)arena_aloca(A, sizeof(int) * I.n);
+  B.aux_res = (int *)arena_aloca(A, sizeof(int) * I.k);
+  B.chaves = (Tchave *)arena_aloca(A, sizeof(Tchave) * (I.n > I.k ? I.n : I.k));
+  B.ordm = (int *)arena_aloca(A, sizeof(int) * I.k);
+
+  // itens que cabem em alguma mochila, em ordem de valor/peso
+  maxC = 0;
+  for (j = 0; j < I.k; j++)
+  {
+    B.res[j] = I.C[j];
+    if (I.C[j] > maxC)
+      maxC = I.C[j];
+  }
+  B.n = 0;
+  B.inteiro = 1;
+  for (i = 0; i < I.n; i++)
+  {
+    if (I.item[i].valor != floor(I.item[i].valor))
+      B.inteiro = 0;
+    if (I.item[i].peso <= maxC && I.item[i].valor > 0)
+    {
+      B.chaves[B.n].chave = I.item[i].valor / I.item[i].peso;
+      B.chaves[B.n].i = i;
+      B.n++;
+    }
+  }
+  qsort(B.chaves, B.n, sizeof(Tchave), comparador_chave);
+  for (i = 0; i < B.n; i++)
+    B.ord[i] = B.chaves[i].i;
+
+  // solucao inicial: gulosa por valor/peso com first-fit
+  B.z_melhor = 0.0;
+  for (i = 0; i < B.n; i++)
+  {
+    for (j = 0; j < I.k; j++)
+    {
+      if (I.item[B.ord[i]].peso <= B.res[j])
+      {
+        B.res[j] -= I.item[B.ord[i]].peso;
+        B.melhor[B.ord[i]] = j + 1;
+        B.z_melhor += I.item[B.ord[i]].valor;
+        break;
+      }
+    }
+  }
+  for (j = 0; j < I.k; j++)
+    B.res[j] = I.C[j];
+
+  bb_no(&B, 0, 0.0);
+
+  // limitante dual: a solucao eh otima, a menos que o tempo tenha acabado
+  ub = B.z_melhor;
+  if (B.parou && B.ub_aberto > ub)
+    ub = B.inteiro ? floor(B.ub_aberto + EPSILON) : B.ub_aberto;
+
+  for (i = 0; i < I.n; i++)
+    I.item[i].index = B.melhor[i];
+
+  info->nodes = B.nos;
+  info->ativos = B.abertos;
+  info->best_primalBound = B.z_melhor;
+  info->best_dualBound = ub;
+  info->gap = (ub - B.z_melhor) / (B.z_melhor + 2.2204460492503131e-16); // como em glp_ios_mip_gap
+
+  PRINTF("bb_mkp: z=%.0lf ub=%.0lf nos=%d abertos=%d\n", B.z_melhor, ub, B.nos, B.abertos);
+
+  arena_volta(A, m);
+  return B.z_melhor;
+}
+
+/* eof */
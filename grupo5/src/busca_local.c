@@ -0,0 +1,358 @@
+/* busca_local.c
+busca local sobre a atribuicao dos itens as mochilas (Titem.index), usada
+depois das heuristicas construtivas (tipos 10 a 14)
+
+Movimentos (todos com ganho calculado em O(1) a partir dos valores dos itens e
+das capacidades residuais):
+ - insercao: um item livre entra em uma mochila com espaco;
+ - troca (swap): um item da mochila a sai e um item livre de valor maior entra
+   no seu lugar;
+ - ejecao 2-por-1: um item da mochila a sai e dois itens livres entram;
+ - deslocamento (shift) + insercao: um item da mochila a vai para outra mochila
+   e abre espaco para um item livre em a (cadeia de ejecao de tamanho 2).
+
+Listas de candidatos ordenadas por peso evitam varreduras O(n^2):
+ - os itens livres ficam em uma arvore de segmentos indexada pela ordem
+   crescente de peso, que guarda o item livre de maior valor de cada intervalo;
+   o melhor item livre que cabe em um espaco r eh o maximo do prefixo dos itens
+   de peso <= r (O(log n));
+ - os itens de cada mochila ficam em um vetor ordenado por peso; o menor item
+   da mochila a que, ao sair, abre espaco para um item livre eh encontrado por
+   busca binaria.
+A busca para no primeiro otimo local (nenhum movimento melhora) ou no tempo
+limite.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glpk.h>
+#include "mochila_multipla.h"
+
+#define BL_CHECA_TEMPO 1024 /* avaliacoes entre duas consultas ao relogio */
+
+// estado da busca local
+typedef struct
+{
+  Tinstance I;
+  int *res;        /* capacidade residual de cada mochila */
+  int *ordp;       /* itens em ordem crescente de peso */
+  int *pos;        /* posicao de cada item em ordp */
+  int *peso_ord;   /* peso de ordp[p] (para a busca binaria) */
+  int folhas;      /* folhas da arvore de segmentos (potencia de 2) */
+  int *arv;        /* arvore de segmentos: posicao do item livre de maior valor (-1 = nenhum) */
+  int **lista;     /* itens de cada mochila, em ordem crescente de peso (n posicoes cada) */
+  int *tam;        /* total de itens de cada mochila */
+  double z;        /* valor da solucao */
+  double inicio, limite;
+  int avaliacoes;  /* movimentos avaliados (para consultar o relogio) */
+  int parou;       /* 1 se o tempo limite foi atingido */
+  int b1, b2;      /* mochilas de maior capacidade residual */
+  int movimentos[4]; /* movimentos aplicados: insercao, troca, 2-por-1, deslocamento */
+} Tbusca;
+
+/* verifica o tempo limite de tempos em tempos */
+static int tempo_esgotado(Tbusca *B)
+{
+  if (++B->avaliacoes % BL_CHECA_TEMPO == 0 && glp_difftime(glp_mono_time(), B->inicio) * 1000 >= B->limite)
+    B->parou = 1;
+  return B->parou;
+}
+
+/* posicao de maior valor entre p1 e p2 (-1 = nenhuma) */
+static int maior(Tbusca *B, int p1, int p2)
+{
+  if (p1 < 0)
+    return p2;
+  if (p2 < 0)
+    return p1;
+  return (B->I.item[B->ordp[p2]].valor > B->I.item[B->ordp[p1]].valor) ? p2 : p1;
+}
+
+/* marca o item i como livre (livre = 1) ou usado (livre = 0) na arvore */
+static void atualiza_livre(Tbusca *B, int i, int livre)
+{
+  int no = B->folhas + B->pos[i];
+
+  B->arv[no] = livre ? B->pos[i] : -1;
+  for (no /= 2; no >= 1; no /= 2)
+    B->arv[no] = maior(B, B->arv[2 * no], B->arv[2 * no + 1]);
+}
+
+/* item livre de maior valor com peso <= r (-1 = nenhum) */
+static int melhor_livre(Tbusca *B, int r)
+{
+  int ini = 0, fim = B->I.n, meio, esq, dir, p = -1;
+
+  // fim = primeira posicao com peso > r
+  while (ini < fim)
+  {
+    meio = (ini + fim) / 2;
+    if (B->peso_ord[meio] <= r)
+      ini = meio + 1;
+    else
+      fim = meio;
+  }
+  // maximo no intervalo [0, fim)
+  for (esq = B->folhas, dir = B->folhas + fim; esq < dir; esq /= 2, dir /= 2)
+  {
+    if (esq & 1)
+      p = maior(B, p, B->arv[esq++]);
+    if (dir & 1)
+      p = maior(B, p, B->arv[--dir]);
+  }
+  return (p < 0) ? -1 : B->ordp[p];
+}
+
+/* posicao do primeiro item da mochila j com peso >= w (ou posicao de w) */
+static int busca_lista(Tbusca *B, int j, int w, int desempate)
+{
+  int ini = 0, fim = B->tam[j], meio, i;
+
+  while (ini < fim)
+  {
+    meio = (ini + fim) / 2;
+    i = B->lista[j][meio];
+    if (B->I.item[i].peso < w || (B->I.item[i].peso == w && i < desempate))
+      ini = meio + 1;
+    else
+      fim = meio;
+  }
+  return ini;
+}
+
+/* coloca o item livre i na mochila j */
+static void insere(Tbusca *B, int i, int j)
+{
+  int p;
+
+  p = busca_lista(B, j, B->I.item[i].peso, i);
+  memmove(&B->lista[j][p + 1], &B->lista[j][p], sizeof(int) * (B->tam[j] - p));
+  B->lista[j][p] = i;
+  B->tam[j]++;
+  B->I.item[i].index = j + 1;
+  B->res[j] -= B->I.item[i].peso;
+  B->z += B->I.item[i].valor;
+  atualiza_livre(B, i, 0);
+}
+
+/* tira o item i da sua mochila */
+static void retira(Tbusca *B, int i)
+{
+  int j = B->I.item[i].index - 1, p;
+
+  p = busca_lista(B, j, B->I.item[i].peso, i);
+  memmove(&B->lista[j][p], &B->lista[j][p + 1], sizeof(int) * (B->tam[j] - p - 1));
+  B->tam[j]--;
+  B->I.item[i].index = 0;
+  B->res[j] += B->I.item[i].peso;
+  B->z -= B->I.item[i].valor;
+  atualiza_livre(B, i, 1);
+}
+
+/* insercao: enche a mochila j com os melhores itens livres que cabem */
+static int enche(Tbusca *B, int j)
+{
+  int i, melhorou = 0;
+
+  while ((i = melhor_livre(B, B->res[j])) >= 0)
+  {
+    insere(B, i, j);
+    B->movimentos[0]++;
+    melhorou = 1;
+  }
+  return melhorou;
+}
+
+/* troca e ejecao 2-por-1 saindo o item i (da mochila a) */
+static int troca_item(Tbusca *B, int i)
+{
+  int a = B->I.item[i].index - 1, r, u1, u2;
+  double ganho1, ganho2;
+
+  r = B->res[a] + B->I.item[i].peso;
+  u1 = melhor_livre(B, r);
+  if (u1 < 0)
+    return 0;
+  ganho1 = B->I.item[u1].valor - B->I.item[i].valor;
+
+  // segundo item livre no espaco que sobra
+  atualiza_livre(B, u1, 0);
+  u2 = melhor_livre(B, r - B->I.item[u1].peso);
+  atualiza_livre(B, u1, 1);
+  ganho2 = (u2 < 0) ? 0.0 : ganho1 + B->I.item[u2].valor;
+
+  if (ganho1 <= EPSILON && ganho2 <= EPSILON)
+    return 0;
+  retira(B, i);
+  insere(B, u1, a);
+  if (ganho2 > ganho1 + EPSILON)
+  {
+    insere(B, u2, a);
+    B->movimentos[2]++;
+  }
+  else
+    B->movimentos[1]++;
+  enche(B, a);
+  return 1;
+}
+
+/* as duas mochilas de maior capacidade residual */
+static void maiores_residuos(Tbusca *B)
+{
+  int b;
+
+  B->b1 = B->b2 = -1;
+  for (b = 0; b < B->I.k; b++)
+  {
+    if (B->b1 < 0 || B->res[b] > B->res[B->b1])
+    {
+      B->b2 = B->b1;
+      B->b1 = b;
+    }
+    else if (B->b2 < 0 || B->res[b] > B->res[B->b2])
+      B->b2 = b;
+  }
+}
+
+/* deslocamento + insercao para o item livre u: um item de alguma mochila a vai
+   para a mochila de maior capacidade residual e u entra em a */
+static int desloca(Tbusca *B, int u)
+{
+  int a, b, p, i, falta;
+
+  // u so entra se couber no espaco somado de duas mochilas
+  if (B->b2 < 0 || B->I.item[u].peso > B->res[B->b1] + B->res[B->b2])
+    return 0;
+
+  for (a = 0; a < B->I.k; a++)
+  {
+    falta = B->I.item[u].peso - B->res[a];
+    if (falta <= 0 || B->tam[a] == 0)
+      continue;
+    b = (a == B->b1) ? B->b2 : B->b1;
+    if (falta > B->res[b] || falta > B->I.item[B->lista[a][B->tam[a] - 1]].peso)
+      continue;
+    // menor item de a que abre o espaco e que cabe em b
+    p = busca_lista(B, a, falta, -1);
+    if (p == B->tam[a])
+      continue;
+    i = B->lista[a][p];
+    if (B->I.item[i].peso > B->res[b])
+      continue;
+    retira(B, i);
+    insere(B, i, b);
+    insere(B, u, a);
+    B->movimentos[3]++;
+    maiores_residuos(B);
+    return 1;
+  }
+  return 0;
+}
+
+/* busca local a partir da solucao em I.item[].index (com as capacidades
+   originais em I.C); devolve o valor da solucao final */
+double busca_local(Tinstance I, double limite, my_infoT *info)
+{
+  Tbusca B;
+  Tchave *chaves;
+  int i, j, p, melhorou, passos = 0;
+  Tarena *A = info->arena;
+  Tmarca m = arena_marca(A);
+
+  FASE_INICIO(info->crono, FASE_BUSCA);
+  B.I = I;
+  B.inicio = glp_mono_time();
+  B.limite = limite;
+  B.avaliacoes = 0;
+  B.parou = 0;
+  memset(B.movimentos, 0, sizeof(B.movimentos));
+
+  // itens em ordem crescente de peso
+  B.ordp = (int *)arena_aloca(A, sizeof(int) * I.n);
+  B.pos = (int *)arena_aloca(A, sizeof(int) * I.n);
+  B.peso_ord = (int *)arena_aloca(A, sizeof(int) * I.n);
+  chaves = (Tchave *)arena_aloca(A, sizeof(Tchave) * I.n);
+  for (i = 0; i < I.n; i++)
+  {
+    chaves[i].chave = -I.item[i].peso;
+    chaves[i].i = i;
+  }
+  qsort(chaves, I.n, sizeof(Tchave), comparador_chave);
+  for (p = 0; p < I.n; p++)
+  {
+    B.ordp[p] = chaves[p].i;
+    B.pos[chaves[p].i] = p;
+    B.peso_ord[p] = I.item[chaves[p].i].peso;
+  }
+
+  // arvore de segmentos dos itens livres (todos usados por enquanto)
+  for (B.folhas = 1; B.folhas < I.n; B.folhas *= 2)
+    ;
+  B.arv = (int *)arena_aloca(A, sizeof(int) * 2 * B.folhas);
+  for (p = 0; p < 2 * B.folhas; p++)
+    B.arv[p] = -1;
+
+  // mochilas (cada lista com espaco para todos os itens, sem realocacoes)
+  B.res = (int *)arena_aloca(A, sizeof(int) * I.k);
+  B.lista = (int **)arena_aloca(A, sizeof(int *) * I.k);
+  B.tam = (int *)arena_aloca_zerada(A, sizeof(int) * I.k);
+  for (j = 0; j < I.k; j++)
+  {
+    B.res[j] = I.C[j];
+    B.lista[j] = (int *)arena_aloca(A, sizeof(int) * (I.n > 0 ? I.n : 1));
+  }
+  B.z = 0.0;
+  for (p = 0; p < I.n; p++)
+  {
+    i = B.ordp[p];
+    j = I.item[i].index - 1;
+    if (j < 0)
+    {
+      B.arv[B.folhas + p] = p;
+      continue;
+    }
+    B.lista[j][B.tam[j]++] = i; // ja em ordem de peso
+    B.res[j] -= I.item[i].peso;
+    B.z += I.item[i].valor;
+  }
+  for (p = B.folhas - 1; p >= 1; p--)
+    B.arv[p] = maior(&B, B.arv[2 * p], B.arv[2 * p + 1]);
+
+  // itens em ordem decrescente de valor (para os deslocamentos)
+  for (i = 0; i < I.n; i++)
+  {
+    chaves[i].chave = I.item[i].valor;
+    chaves[i].i = i;
+  }
+  qsort(chaves, I.n, sizeof(Tchave), comparador_chave);
+
+  PRINTF("busca_local: solucao inicial %.0lf\n", B.z);
+  do
+  {
+    melhorou = 0;
+    passos++;
+    for (j = 0; j < I.k; j++)
+      melhorou |= enche(&B, j);
+    for (i = 0; i < I.n && !tempo_esgotado(&B); i++)
+      if (I.item[i].index != 0)
+        melhorou |= troca_item(&B, i);
+    maiores_residuos(&B);
+    for (p = 0; p < I.n && !tempo_esgotado(&B); p++)
+      if (I.item[chaves[p].i].index == 0)
+        melhorou |= desloca(&B, chaves[p].i);
+    PRINTF("busca_local: passo %d z=%.0lf\n", passos, B.z);
+  } while (melhorou && !B.parou);
+
+  PRINTF("busca_local: z=%.0lf insercoes=%d trocas=%d 2-por-1=%d deslocamentos=%d%s\n", B.z, B.movimentos[0], B.movimentos[1], B.movimentos[2], B.movimentos[3], B.parou ? " (tempo limite)" : "");
+
+  info->nodes = B.movimentos[0] + B.movimentos[1] + B.movimentos[2] + B.movimentos[3];
+  info->ativos = 0;
+  info->best_primalBound = B.z;
+
+  arena_volta(A, m);
+  FASE_FIM(info->crono);
+  return B.z;
+}
+
+/* eof */
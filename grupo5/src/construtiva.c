@@ -0,0 +1,262 @@
+/* construtiva.c
+heuristicas construtivas com as capacidades residuais em arvores (tipos 17 a 28)
+
+Os itens sao tomados em uma ordem (valor, valor/peso, peso ou guiada pela
+relaxacao linear) e cada um vai para a mochila escolhida pelo encaixe:
+
+   primeira (first-fit): a mochila de menor indice em que o item cabe
+   melhor  (best-fit):  a de menor residuo em que o item cabe
+   pior    (worst-fit): a de maior residuo
+   ultima:              a de maior indice em que o item cabe (repair_rins)
+
+As capacidades residuais ficam em uma arvore de segmentos sobre os indices das
+mochilas (maior residuo de cada intervalo), que responde a primeira, a ultima
+e a pior mochila descendo da raiz, e, para a melhor, em uma treap ordenada por
+(residuo, indice). Escolher e atualizar custa O(log k), em vez do O(k) da
+varredura das mochilas, e a heuristica toda custa O(n log n + n log k).
+
+A ordem guiada pela relaxacao usa os custos reduzidos v_i - pi p_i, onde pi eh
+a razao do item critico da mochila de capacidade igual a soma das capacidades
+(a relaxacao linear do modelo F1 se reduz a ela, sem simplex): os itens da
+solucao da relaxacao vem antes, os de maior margem primeiro.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mochila_multipla.h"
+
+// nomes das ordens e dos encaixes (arquivo .out)
+static const char *nome_ordem[ORDENS] = {"valor", "valor/peso", "peso", "relaxacao"};
+static const char *nome_encaixe[ENCAIXES] = {"primeira", "melhor", "pior"};
+
+/* a mochila a vem antes da b na treap */
+static int antes(const Tcapacidades *T, int a, int b)
+{
+  return T->C[a] < T->C[b] || (T->C[a] == T->C[b] && a < b);
+}
+
+/* separa a treap t nas mochilas que vem antes de j (*e) e nas demais (*d) */
+static void separa(Tcapacidades *T, int t, int j, int *e, int *d)
+{
+  if (t < 0)
+  {
+    *e = *d = -1;
+    return;
+  }
+  if (antes(T, t, j))
+  {
+    separa(T, T->dir[t], j, &T->dir[t], d);
+    *e = t;
+  }
+  else
+  {
+    separa(T, T->esq[t], j, e, &T->esq[t]);
+    *d = t;
+  }
+}
+
+/* junta as treaps e e d (todas as mochilas de e vem antes das de d) */
+static int junta(Tcapacidades *T, int e, int d)
+{
+  if (e < 0)
+    return d;
+  if (d < 0)
+    return e;
+  if (T->prio[e] > T->prio[d])
+  {
+    T->dir[e] = junta(T, T->dir[e], d);
+    return e;
+  }
+  T->esq[d] = junta(T, e, T->esq[d]);
+  return d;
+}
+
+/* insere a mochila j na treap (com o residuo atual) */
+static void treap_insere(Tcapacidades *T, int j)
+{
+  int e, d;
+
+  T->esq[j] = T->dir[j] = -1;
+  separa(T, T->raiz, j, &e, &d);
+  T->raiz = junta(T, junta(T, e, j), d);
+}
+
+/* retira a mochila j da treap (com o residuo atual) */
+static void treap_retira(Tcapacidades *T, int j)
+{
+  int e, m, d, t;
+
+  separa(T, T->raiz, j, &e, &m);
+  // m comeca por j: j eh o menor elemento de m
+  if (m == j)
+    m = T->dir[j];
+  else
+  {
+    for (t = m; T->esq[t] != j; t = T->esq[t])
+      ;
+    T->esq[t] = T->dir[j];
+  }
+  d = m;
+  T->raiz = junta(T, e, d);
+}
+
+/* monta as arvores sobre as capacidades C (a treap so para o best-fit), na
+   arena A */
+void capacidades_cria(Tcapacidades *T, int *C, int k, int encaixe, Tarena *A)
+{
+  int j, f;
+
+  T->k = k;
+  T->C = C;
+  for (T->folhas = 1; T->folhas < k; T->folhas *= 2)
+    ;
+  T->arv = (int *)arena_aloca(A, sizeof(int) * 2 * T->folhas);
+  for (f = 0; f < T->folhas; f++)
+    T->arv[T->folhas + f] = (f < k) ? C[f] : -1;
+  for (f = T->folhas - 1; f >= 1; f--)
+    T->arv[f] = (T->arv[2 * f] > T->arv[2 * f + 1]) ? T->arv[2 * f] : T->arv[2 * f + 1];
+
+  T->raiz = -1;
+  T->esq = T->dir = T->prio = NULL;
+  if (encaixe == ENCAIXE_MELHOR)
+  {
+    T->esq = (int *)arena_aloca(A, sizeof(int) * k);
+    T->dir = (int *)arena_aloca(A, sizeof(int) * k);
+    T->prio = (int *)arena_aloca(A, sizeof(int) * k);
+    for (j = 0; j < k; j++)
+    {
+      // prioridades pseudo-aleatorias fixas (a treap nao depende da semente)
+      T->prio[j] = (int)(((unsigned)j * 2654435761u + 40503u) >> 1);
+      treap_insere(T, j);
+    }
+  }
+}
+
+/* mochila em que vai um item de peso p segundo o encaixe, ou -1 */
+int capacidades_escolhe(Tcapacidades *T, int peso, int encaixe)
+{
+  int f = 1, t, j = -1;
+
+  if (T->arv[1] < peso)
+    return -1;
+  if (encaixe == ENCAIXE_MELHOR)
+  {
+    // menor (residuo, indice) com residuo >= peso
+    for (t = T->raiz; t >= 0;)
+    {
+      if (T->C[t] >= peso)
+      {
+        j = t;
+        t = T->esq[t];
+      }
+      else
+        t = T->dir[t];
+    }
+    return j;
+  }
+  while (f < T->folhas)
+  {
+    if (encaixe == ENCAIXE_PRIMEIRA)
+      f = (T->arv[2 * f] >= peso) ? 2 * f : 2 * f + 1;
+    else if (encaixe == ENCAIXE_ULTIMA)
+      f = (T->arv[2 * f + 1] >= peso) ? 2 * f + 1 : 2 * f;
+    else // pior: desce pelo filho que tem o maior residuo (o da esquerda no empate)
+      f = (T->arv[2 * f] == T->arv[f]) ? 2 * f : 2 * f + 1;
+  }
+  return f - T->folhas;
+}
+
+/* coloca um item de peso p na mochila j */
+void capacidades_retira(Tcapacidades *T, int j, int peso)
+{
+  int f;
+
+  if (T->prio != NULL)
+    treap_retira(T, j);
+  T->C[j] -= peso;
+  if (T->prio != NULL)
+    treap_insere(T, j);
+  f = T->folhas + j;
+  T->arv[f] = T->C[j];
+  for (f /= 2; f >= 1; f /= 2)
+    T->arv[f] = (T->arv[2 * f] > T->arv[2 * f + 1]) ? T->arv[2 * f] : T->arv[2 * f + 1];
+}
+
+/* chave da ordem guiada pela relaxacao: custo reduzido v_i - pi p_i */
+static void chave_relaxacao(Tsoa *S, Tinstance I, double *chave, Tarena *A)
+{
+  double pi = 0.0;
+  long long resta = 0;
+  int j, t, i;
+
+  for (j = 0; j < I.k; j++)
+    resta += I.C[j];
+  calcula_razao(S->valor, S->peso, S->razao, S->n);
+  ordena_permutacao(S->razao, S->n, S->ordem, A);
+  for (t = 0; t < S->n; t++)
+  {
+    i = S->ordem[t];
+    if (S->peso[i] > resta)
+    {
+      pi = S->razao[i]; // item critico
+      break;
+    }
+    resta -= S->peso[i];
+  }
+  for (i = 0; i < S->n; i++)
+    chave[i] = S->valor[i] - pi * S->peso[i];
+}
+
+/* heuristica construtiva com a ordem e o encaixe dados; as capacidades
+   residuais ficam em I.C e a solucao em I.item[].index */
+double construtiva(Tinstance I, int ordem, int encaixe, Tarena *A)
+{
+  Tsoa S;
+  Tcapacidades T;
+  double *chave, z;
+  int i, t, j;
+  Tmarca m = arena_marca(A);
+
+  soa_carrega(&S, I, A);
+  chave = (double *)arena_aloca(A, sizeof(double) * I.n);
+  if (ordem == ORDEM_VALOR)
+    memcpy(chave, S.valor, sizeof(double) * I.n);
+  else if (ordem == ORDEM_RAZAO)
+    calcula_razao(S.valor, S.peso, chave, I.n);
+  else if (ordem == ORDEM_PESO)
+    for (i = 0; i < I.n; i++)
+      chave[i] = S.peso[i];
+  else
+    chave_relaxacao(&S, I, chave, A);
+  ordena_permutacao(chave, I.n, S.ordem, A);
+
+  capacidades_cria(&T, I.C, I.k, encaixe, A);
+  for (t = 0; t < I.n; t++)
+  {
+    i = S.ordem[t];
+    j = capacidades_escolhe(&T, S.peso[i], encaixe);
+    if (j >= 0)
+    {
+      S.index[i] = j + 1;
+      capacidades_retira(&T, j, S.peso[i]);
+    }
+  }
+  z = objetivo(S.valor, S.index, I.n);
+
+  PRINTF("construtiva: ordem %s, encaixe %s, z=%.0lf\n", nome_ordem[ordem], nome_encaixe[encaixe], z);
+
+  soa_devolve(&S, I);
+  arena_volta(A, m);
+  return z;
+}
+
+/* nome do metodo construtivo do tipo dado (arquivo .out) */
+void nome_construtiva(int tipo, char *nome, size_t tam)
+{
+  int t = tipo - TIPO_CONSTRUTIVA;
+
+  snprintf(nome, tam, "%d:construtiva %s + %s", tipo, nome_ordem[t / ENCAIXES], nome_encaixe[t % ENCAIXES]);
+}
+
+/* eof */
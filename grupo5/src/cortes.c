@@ -0,0 +1,278 @@
+/* cortes.c
+desigualdades de cobertura para o branch-and-bound do GLPK (tipo 2 com -c 1),
+separadas na razao GLP_ICUTGEN da callback
+
+Cada restricao de capacidade sum_i p_i x_ij <= C_j eh uma mochila 0-1. Uma
+cobertura K (itens com sum_K p_i > C_j) da a desigualdade
+   sum_{i em K} x_ij <= |K| - 1,
+violada pela relaxacao x* quando sum_K (1 - x*_ij) < 1. A cobertura eh
+construida de forma gulosa pela menor razao (1 - x*_ij)/p_i entre os itens
+com x*_ij > 0 e depois reduzida a uma cobertura minima (saem os itens de
+menor x*, o que so aumenta a violacao). Os itens fora de K recebem o
+coeficiente de lifting de Balas arredondado para baixo: com mu_h a soma dos h
+maiores pesos de K, o item de peso p com mu_h <= p < mu_h+1 recebe h (todo
+lifting sequencial da um coeficiente h ou h+1, por isso h eh sempre valido).
+
+Como cada item vai para no maximo uma mochila, para uma classe Q de m >= 2
+mochilas de mesma capacidade C a soma y_i = sum_{j em Q} x_ij eh binaria e
+   sum_i p_i y_i <= m C
+eh uma mochila 0-1 nas variaveis y. As coberturas dessa mochila agregada
+(tambem com lifting) sao expandidas para as colunas x_ij de todas as mochilas
+da classe e cortam pontos fracionarios que nenhuma cobertura de uma mochila
+so corta.
+
+Um corte so eh acrescentado (glp_ios_add_row) se a violacao passar de
+CC_VIOLACAO e a eficacia (violacao / norma dos coeficientes) de CC_EFICACIA.
+As rodadas por no sao limitadas (CC_RODADAS_RAIZ na raiz e CC_RODADAS_NO nos
+demais), pois o GLPK chama a callback de novo sempre que um corte entra, e so
+os nos ate o nivel CC_NIVEL sao separados: os cortes ficam nas relaxacoes de
+toda a subarvore e, mais fundo, o custo das linhas extras em cada simplex
+passa do ganho no limitante.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <glpk.h>
+#include "mochila_multipla.h"
+
+#define CC_CLASSE 101        /* classe dos cortes no GLPK (cortes da aplicacao) */
+#define CC_VIOLACAO 1e-3     /* menor violacao de um corte */
+#define CC_EFICACIA 1e-3     /* menor violacao / norma de um corte */
+#define CC_RODADAS_RAIZ 50   /* rodadas de separacao na raiz */
+#define CC_RODADAS_NO 1      /* rodadas de separacao nos demais nos */
+#define CC_NIVEL 4           /* nivel maximo dos nos com separacao */
+
+/* prepara o separador para o modelo com m colunas (col = NULL: modelo
+   completo, coluna j*n + i + 1 para x_ij) e as capacidades das linhas 1..k;
+   os vetores saem da arena A e valem ate quem chamou devolve-la */
+void cortes_cria(Tcortes *S, Tinstance I, const int *col, int m, glp_prob *lp, Tarena *A)
+{
+  int c, v, j, l;
+
+  S->I = I;
+  S->m = m;
+  S->no = -1;
+  S->rodadas = 0;
+  S->cortes = S->agregados = 0;
+  S->coluna = (int *)arena_aloca_zerada(A, sizeof(int) * I.n * (size_t)I.k);
+  for (c = 1; c <= m; c++)
+  {
+    v = col ? col[c] : c - 1;
+    S->coluna[v] = c;
+  }
+  // classes de mochilas de mesma capacidade (primeira mochila da classe)
+  S->C = (long long *)arena_aloca(A, sizeof(long long) * I.k);
+  S->classe = (int *)arena_aloca(A, sizeof(int) * I.k);
+  for (j = 0; j < I.k; j++)
+  {
+    S->C[j] = (long long)glp_get_row_ub(lp, j + 1);
+    S->classe[j] = j;
+    for (l = 0; l < j; l++)
+      if (S->classe[l] == l && S->C[l] == S->C[j])
+      {
+        S->classe[j] = l;
+        break;
+      }
+  }
+  S->item = (int *)arena_aloca(A, sizeof(int) * I.n);
+  S->peso = (int *)arena_aloca(A, sizeof(int) * I.n);
+  S->ys = (double *)arena_aloca(A, sizeof(double) * I.n);
+  S->alfa = (int *)arena_aloca(A, sizeof(int) * I.n);
+  S->na = (int *)arena_aloca(A, sizeof(int) * I.n);
+  S->mu = (long long *)arena_aloca(A, sizeof(long long) * (I.n + 1));
+  S->chaves = (Tchave *)arena_aloca(A, sizeof(Tchave) * I.n);
+  S->ind = (int *)arena_aloca(A, sizeof(int) * ((size_t)I.n * I.k + 1));
+  S->val = (double *)arena_aloca(A, sizeof(double) * ((size_t)I.n * I.k + 1));
+}
+
+/* cobertura da mochila sum_t peso[t] y_t <= b violada por ys (t = 0..nt-1);
+   alfa[t] recebe os coeficientes da desigualdade com lifting. Devolve o lado
+   direito (|K| - 1) ou -1 se a cobertura gulosa nao for violada */
+static int cobertura(Tcortes *S, int nt, long long b)
+{
+  long long W = 0;
+  double custo = 0.0;
+  int t, r, u, nk = 0, nc = 0, a, z;
+
+  // itens com y* > 0 pela razao (1 - y*)/p crescente
+  for (t = 0; t < nt; t++)
+  {
+    S->alfa[t] = 0;
+    if (S->ys[t] > EPSILON && S->peso[t] > 0)
+    {
+      S->chaves[nc].chave = -(1.0 - S->ys[t]) / S->peso[t];
+      S->chaves[nc].i = t;
+      nc++;
+    }
+  }
+  qsort(S->chaves, nc, sizeof(Tchave), comparador_chave);
+  for (r = 0; r < nc && W <= b; r++)
+  {
+    t = S->chaves[r].i;
+    S->alfa[t] = 1;
+    W += S->peso[t];
+    custo += 1.0 - S->ys[t];
+  }
+  if (W <= b || custo >= 1.0 - CC_VIOLACAO)
+    return -1;
+
+  // cobertura minima: saem os itens de menor y* enquanto ela continua cobertura
+  for (u = 0; u < r; u++)
+  {
+    S->chaves[u].chave = -S->ys[S->chaves[u].i];
+  }
+  qsort(S->chaves, r, sizeof(Tchave), comparador_chave);
+  for (u = 0; u < r; u++)
+  {
+    t = S->chaves[u].i;
+    if (W - S->peso[t] > b)
+    {
+      S->alfa[t] = 0;
+      W -= S->peso[t];
+    }
+  }
+
+  // somas dos h maiores pesos da cobertura
+  for (t = 0; t < nt; t++)
+    if (S->alfa[t])
+      S->na[nk++] = S->peso[t];
+  for (u = 1; u < nk; u++) // insercao em ordem decrescente (coberturas pequenas)
+  {
+    z = S->na[u];
+    for (a = u; a > 0 && S->na[a - 1] < z; a--)
+      S->na[a] = S->na[a - 1];
+    S->na[a] = z;
+  }
+  S->mu[0] = 0;
+  for (u = 0; u < nk; u++)
+    S->mu[u + 1] = S->mu[u] + S->na[u];
+
+  // lifting: h com mu_h <= p < mu_h+1
+  for (t = 0; t < nt; t++)
+  {
+    if (S->alfa[t])
+      continue;
+    a = 0;
+    z = nk;
+    while (a < z) // maior h com mu_h <= p
+    {
+      u = (a + z + 1) / 2;
+      if (S->mu[u] <= S->peso[t])
+        a = u;
+      else
+        z = u - 1;
+    }
+    S->alfa[t] = a;
+  }
+  // os coeficientes dos itens da cobertura ficam em 1 (marcados antes)
+  return nk - 1;
+}
+
+/* acrescenta o corte sum val x <= rhs se ele for violado e eficaz */
+static int acrescenta(Tcortes *S, glp_tree *tree, glp_prob *lp, int len, int rhs)
+{
+  double lhs = 0.0, norma = 0.0;
+  int l;
+
+  for (l = 1; l <= len; l++)
+  {
+    lhs += S->val[l] * glp_get_col_prim(lp, S->ind[l]);
+    norma += S->val[l] * S->val[l];
+  }
+  if (lhs - rhs < CC_VIOLACAO || (lhs - rhs) / sqrt(norma) < CC_EFICACIA)
+    return 0;
+  glp_ios_add_row(tree, NULL, CC_CLASSE, 0, len, S->ind, S->val, GLP_UP, rhs);
+  S->cortes++;
+  return 1;
+}
+
+/* separa coberturas de cada mochila e de cada classe de mochilas iguais */
+void separa_coberturas(glp_tree *tree, Tcortes *S)
+{
+  Tinstance I = S->I;
+  glp_prob *lp = glp_ios_get_prob(tree);
+  int p, j, l, i, c, nt, t, len, rhs, m;
+
+  // rodadas por no
+  p = glp_ios_curr_node(tree);
+  if (p != S->no)
+  {
+    S->no = p;
+    S->rodadas = 0;
+  }
+  l = glp_ios_node_level(tree, p);
+  if (l > CC_NIVEL || S->rodadas++ >= (l == 0 ? CC_RODADAS_RAIZ : CC_RODADAS_NO))
+    return;
+
+  for (j = 0; j < I.k; j++)
+  {
+    // mochila j
+    nt = 0;
+    for (i = 0; i < I.n; i++)
+    {
+      c = S->coluna[j * I.n + i];
+      if (c == 0)
+        continue;
+      S->item[nt] = c;
+      S->peso[nt] = I.item[i].peso;
+      S->ys[nt] = glp_get_col_prim(lp, c);
+      nt++;
+    }
+    rhs = cobertura(S, nt, S->C[j]);
+    if (rhs >= 0)
+    {
+      len = 0;
+      for (t = 0; t < nt; t++)
+        if (S->alfa[t] > 0)
+        {
+          len++;
+          S->ind[len] = S->item[t];
+          S->val[len] = S->alfa[t];
+        }
+      acrescenta(S, tree, lp, len, rhs);
+    }
+
+    // classe de j (uma vez, na primeira mochila da classe)
+    if (S->classe[j] != j)
+      continue;
+    m = 0;
+    for (l = j; l < I.k; l++)
+      m += (S->classe[l] == j);
+    if (m < 2)
+      continue;
+    nt = 0;
+    for (i = 0; i < I.n; i++)
+    {
+      if (S->coluna[j * I.n + i] == 0)
+        continue;
+      S->item[nt] = i;
+      S->peso[nt] = I.item[i].peso;
+      S->ys[nt] = 0.0;
+      for (l = j; l < I.k; l++)
+        if (S->classe[l] == j && (c = S->coluna[l * I.n + i]) != 0)
+          S->ys[nt] += glp_get_col_prim(lp, c);
+      nt++;
+    }
+    rhs = cobertura(S, nt, m * S->C[j]);
+    if (rhs < 0)
+      continue;
+    len = 0;
+    for (t = 0; t < nt; t++)
+    {
+      if (S->alfa[t] == 0)
+        continue;
+      for (l = j; l < I.k; l++)
+        if (S->classe[l] == j && (c = S->coluna[l * I.n + S->item[t]]) != 0)
+        {
+          len++;
+          S->ind[len] = c;
+          S->val[len] = S->alfa[t];
+        }
+    }
+    S->agregados += acrescenta(S, tree, lp, len, rhs);
+  }
+}
+
+/* eof */
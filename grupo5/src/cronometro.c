@@ -0,0 +1,79 @@
+/* cronometro.c
+tempo de relogio e de CPU de cada fase da execucao de um metodo
+
+As fases podem ser aninhadas (por exemplo, a busca local dentro da LNS): o
+cronometro guarda a pilha das fases abertas e o tempo eh atribuido so a fase
+do topo, de modo que a soma das fases nao conta nada duas vezes. O relogio eh
+o monotonico do GLPK (glp_mono_time) e a CPU eh a da thread que executa o
+metodo (glp_cpu_time); as threads auxiliares da relaxacao lagrangiana e do
+multi-start nao entram na CPU.
+
+Desligado (-f 0, o padrao), o cronometro eh um ponteiro NULL e as macros
+FASE_INICIO/FASE_FIM custam so um teste.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <glpk.h>
+#include "mochila_multipla.h"
+
+// nomes das fases (colunas do csv)
+static const char *nome_fase[FASES] = {"leitura", "modelo", "relaxacao", "bb", "heuristica", "busca", "saida"};
+
+/* zera o cronometro */
+void cronometro_zera(Tcronometro *c)
+{
+  memset(c, 0, sizeof(Tcronometro));
+}
+
+/* acumula o tempo desde a ultima marca na fase do topo da pilha */
+static void acumula(Tcronometro *c, double parede, double cpu)
+{
+  int f;
+
+  if (c->topo > 0)
+  {
+    f = c->pilha[(c->topo < CRONOMETRO_PILHA ? c->topo : CRONOMETRO_PILHA) - 1];
+    c->parede[f] += glp_difftime(parede, c->marca_parede);
+    c->cpu[f] += glp_difftime(cpu, c->marca_cpu);
+  }
+  c->marca_parede = parede;
+  c->marca_cpu = cpu;
+}
+
+/* abre a fase f (a fase aberta antes dela fica suspensa) */
+void cronometro_inicia(Tcronometro *c, int f)
+{
+  acumula(c, glp_mono_time(), glp_cpu_time());
+  if (c->topo < CRONOMETRO_PILHA)
+    c->pilha[c->topo] = f;
+  c->topo++;
+}
+
+/* fecha a fase do topo (a fase suspensa volta a contar) */
+void cronometro_para(Tcronometro *c)
+{
+  acumula(c, glp_mono_time(), glp_cpu_time());
+  if (c->topo > 0)
+    c->topo--;
+}
+
+/* imprime o cabecalho das colunas das fases */
+void cronometro_cabecalho(FILE *saida)
+{
+  int f;
+
+  for (f = 0; f < FASES; f++)
+    fprintf(saida, ";%s_parede;%s_cpu", nome_fase[f], nome_fase[f]);
+}
+
+/* imprime as colunas das fases (tempos em segundos) */
+void cronometro_imprime(FILE *saida, Tcronometro *c)
+{
+  int f;
+
+  for (f = 0; f < FASES; f++)
+    fprintf(saida, ";%lf;%lf", c->parede[f], c->cpu[f]);
+}
+
+/* eof */
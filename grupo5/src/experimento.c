@@ -0,0 +1,433 @@
+/* experimento.c
+modo de experimento: as tabelas dos relatorios (testes T1, T2 e T3)
+
+Executa cada par (instancia, tipo) varias vezes (-x), com as sementes s, s+1,
+... (-s, padrao 1), usando as threads do modo em lote (padrao: uma thread, para
+que os tempos nao dependam da carga da maquina), e calcula para cada execucao
+os gaps definidos no README:
+
+   gap de dualidade  100 (UB - LB) / UB, com LB o valor da solucao e UB o
+                     limitante do proprio metodo (tipos 2, 7, 8, 15 e 16) ou,
+                     para as heuristicas, o melhor limitante da instancia
+                     (o menor dos limitantes de todas as execucoes, inclusive
+                     o da relaxacao linear, tipo 1)
+   gap de otimalidade 100 (UB - z*) / z* para a relaxacao linear e
+                     100 (z* - z) / z* para os demais metodos, com z* o valor
+                     da melhor solucao encontrada na instancia
+
+Uma execucao eh otima quando o gap de dualidade eh zero (para a relaxacao,
+quando o gap de otimalidade eh zero). As familias sao os prefixos dos nomes das
+instancias ate o terceiro '-' (t100-10-50, t200-5-10000, ...). Os arquivos
+gravados, com o prefixo dado (padrao "experimento"), sao:
+
+   <prefixo>-execucoes.csv  uma linha por execucao
+   <prefixo>-resumo.csv     por familia e tipo (e "todas"): execucoes, gap de
+                            dualidade medio, gap de otimalidade medio, otimas,
+                            instancias em que o tipo achou a melhor solucao,
+                            tempo medio, desvio do tempo e tempo medio das
+                            execucoes otimas
+   <prefixo>-resumo.json    o mesmo resumo em JSON
+   <prefixo>-perfil.csv     perfis de desempenho (Dolan e More) por familia:
+                            fracao das instancias que cada tipo resolve em ate
+                            tau vezes o tempo do mais rapido; um tipo resolve a
+                            instancia quando o gap de otimalidade medio nao
+                            passa de PERFIL_TOLERANCIA
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <glpk.h>
+#include "mochila_multipla.h"
+
+#define PERFIL_TOLERANCIA 1.0 /* gap de otimalidade (%) ate o qual a instancia eh resolvida */
+#define PERFIL_TEMPO_MIN 1e-3 /* tempos menores (em s) contam como este, para as razoes nao explodirem */
+#define PERFIL_PONTOS 41      /* tau = 2^(i/4), i = 0..40 */
+#define SEM_VALOR (-DBL_MAX)  /* gap nao definido */
+
+// medidas de uma execucao
+typedef struct
+{
+  int familia;     /* indice da familia */
+  double ub;       /* limitante usado no gap de dualidade */
+  double gap_dual; /* gap de dualidade (%) ou SEM_VALOR */
+  double gap_otim; /* gap de otimalidade (%) */
+  int otima;       /* 1 se a execucao eh otima */
+} Tmedida;
+
+// acumulador do resumo de uma familia e um tipo
+typedef struct
+{
+  int execucoes;
+  int ndual;
+  double gap_dual;
+  double gap_otim;
+  int otimas;
+  int melhores;
+  double tempo;
+  double tempo2;
+  double tempo_otimas;
+} Tresumo;
+
+/* o tipo calcula um limitante superior valido em info.best_dualBound */
+static int tem_limitante(int tipo)
+{
+  return tipo == 2 || tipo == 7 || tipo == 8 || tipo == TIPO_LNS || tipo == TIPO_COLUNAS || tipo == TIPO_PD || tipo == TIPO_PORTFOLIO;
+}
+
+/* acumula uma execucao no resumo */
+static void acumula(Tresumo *s, Tresultado *r, Tmedida *m)
+{
+  s->execucoes++;
+  if (m->gap_dual != SEM_VALOR)
+  {
+    s->ndual++;
+    s->gap_dual += m->gap_dual;
+  }
+  if (m->gap_otim != SEM_VALOR)
+    s->gap_otim += m->gap_otim;
+  s->tempo += r->tempo;
+  s->tempo2 += r->tempo * r->tempo;
+  if (m->otima)
+  {
+    s->otimas++;
+    s->tempo_otimas += r->tempo;
+  }
+}
+
+/* familia da instancia: nome do arquivo ate o terceiro '-' */
+static void nome_familia(const char *arquivo, char *familia, size_t tam)
+{
+  const char *p = strrchr(arquivo, '/');
+  size_t n;
+  int tracos = 0;
+
+  p = p ? p + 1 : arquivo;
+  for (n = 0; p[n] != '\0' && p[n] != '.'; n++)
+    if (p[n] == '-' && ++tracos == 3)
+      break;
+  if (n >= tam)
+    n = tam - 1;
+  memcpy(familia, p, n);
+  familia[n] = '\0';
+}
+
+/* grava um gap (vazio se nao definido) */
+static void imprime_gap(FILE *f, double gap, const char *vazio)
+{
+  if (gap == SEM_VALOR)
+    fprintf(f, "%s", vazio);
+  else
+    fprintf(f, "%.4lf", gap);
+}
+
+/* abre <prefixo><sufixo> para escrita */
+static FILE *abre_saida(const char *prefixo, const char *sufixo)
+{
+  char nome[FILENAME_MAX];
+  FILE *f;
+
+  snprintf(nome, sizeof(nome), "%s%s", prefixo, sufixo);
+  f = fopen(nome, "w");
+  if (!f)
+    printf("\nProblema na abertura do arquivo %s\n", nome);
+  return f;
+}
+
+/* executa o experimento e grava as tabelas */
+int executa_experimento(char *entrada, char *tipos, int nthreads, char *prefixo, Tparametros *par)
+{
+  Tresultado *res, *r;
+  Tmedida *med, *m;
+  Tresumo *resumo, *s;
+  FILE *fexe, *fcsv, *fjson, *fperfil;
+  char **arquivos, (*familias)[FILENAME_MAX], nome[FILENAME_MAX];
+  double antes, agora, *ub_inst, *z_inst, *tempo_ps, tempo, melhor, tau, media, desvio;
+  int lista[MAX_TIPOS], *familia, *resolvidas, ninst, ntipos, narquivos, nfamilias, nrep, total, a, t, e, f, i, c, primeiro, falhas, cont;
+  unsigned semente;
+
+  ntipos = le_tipos(tipos, lista);
+  if (ntipos == 0)
+  {
+    printf("Lista de tipos invalida: %s\n", tipos);
+    return 0;
+  }
+  narquivos = lista_instancias(entrada, &arquivos);
+  if (narquivos == 0)
+  {
+    printf("Nenhuma instancia encontrada em %s\n", entrada);
+    free(arquivos);
+    return 0;
+  }
+  if (prefixo == NULL)
+    prefixo = "experimento";
+
+  // execucoes: semente s + r na execucao r de cada par
+  nrep = par->execucoes;
+  semente = par->semente ? par->semente : 1;
+  total = narquivos * ntipos * nrep;
+  antes = glp_mono_time();
+  res = executa_pares(arquivos, narquivos, lista, ntipos, nrep, semente, nthreads, par);
+  agora = glp_mono_time();
+
+  // familias das instancias
+  familias = malloc(sizeof(*familias) * narquivos);
+  familia = (int *)malloc(sizeof(int) * narquivos);
+  nfamilias = 0;
+  for (a = 0; a < narquivos; a++)
+  {
+    nome_familia(arquivos[a], nome, sizeof(nome));
+    for (f = 0; f < nfamilias && strcmp(familias[f], nome) != 0; f++)
+      ;
+    if (f == nfamilias)
+      strcpy(familias[nfamilias++], nome);
+    familia[a] = f;
+  }
+
+  // referencias de cada instancia: melhor limitante e melhor solucao
+  ub_inst = (double *)malloc(sizeof(double) * narquivos);
+  z_inst = (double *)malloc(sizeof(double) * narquivos);
+  falhas = 0;
+  for (a = 0; a < narquivos; a++)
+  {
+    ub_inst[a] = DBL_MAX;
+    z_inst[a] = -DBL_MAX;
+    for (c = 0; c < ntipos * nrep; c++)
+    {
+      r = &res[a * ntipos * nrep + c];
+      if (!r->ok)
+        continue;
+      if (r->tipo == 1)
+      {
+        if (r->z < ub_inst[a])
+          ub_inst[a] = r->z;
+        continue;
+      }
+      if (r->z > z_inst[a])
+        z_inst[a] = r->z;
+      if (tem_limitante(r->tipo) && r->info.best_dualBound >= r->z - EPSILON && r->info.best_dualBound < ub_inst[a])
+        ub_inst[a] = r->info.best_dualBound;
+    }
+  }
+
+  // medidas de cada execucao
+  med = (Tmedida *)malloc(sizeof(Tmedida) * total);
+  for (e = 0; e < total; e++)
+  {
+    r = &res[e];
+    m = &med[e];
+    a = e / (ntipos * nrep);
+    m->familia = familia[a];
+    m->gap_dual = m->gap_otim = SEM_VALOR;
+    m->otima = 0;
+    m->ub = SEM_VALOR;
+    if (!r->ok)
+    {
+      falhas++;
+      continue;
+    }
+    if (r->tipo == 1)
+    {
+      m->ub = r->z;
+      if (z_inst[a] > 0)
+      {
+        m->gap_otim = 100 * (r->z - z_inst[a]) / z_inst[a];
+        m->otima = (r->z - z_inst[a] < 0.5);
+      }
+      continue;
+    }
+    if (tem_limitante(r->tipo) && r->info.best_dualBound >= r->z - EPSILON)
+      m->ub = r->info.best_dualBound;
+    else if (ub_inst[a] < DBL_MAX)
+      m->ub = ub_inst[a];
+    if (m->ub != SEM_VALOR && m->ub > 0)
+    {
+      m->gap_dual = 100 * (m->ub - r->z) / m->ub;
+      m->otima = (m->ub - r->z < 0.5);
+    }
+    if (z_inst[a] > 0)
+      m->gap_otim = 100 * (z_inst[a] - r->z) / z_inst[a];
+  }
+
+  // uma linha por execucao
+  fexe = abre_saida(prefixo, "-execucoes.csv");
+  if (fexe)
+  {
+    fprintf(fexe, "instancia;familia;tipo;execucao;semente;z;ub;tempo;gap_dualidade;gap_otimalidade;otima\n");
+    for (e = 0; e < total; e++)
+    {
+      r = &res[e];
+      m = &med[e];
+      if (!r->ok)
+        continue;
+      fprintf(fexe, "%s;%s;%d;%d;%u;%.0lf;", r->arquivo, familias[m->familia], r->tipo, e % nrep, r->semente, r->z);
+      if (m->ub == SEM_VALOR)
+        fprintf(fexe, ";");
+      else
+        fprintf(fexe, "%.2lf;", m->ub);
+      fprintf(fexe, "%lf;", r->tempo);
+      imprime_gap(fexe, m->gap_dual, "");
+      fprintf(fexe, ";");
+      imprime_gap(fexe, m->gap_otim, "");
+      fprintf(fexe, ";%d\n", m->otima);
+    }
+    fclose(fexe);
+  }
+
+  // resumo por familia (a ultima linha de cada tipo, f == nfamilias, eh a de
+  // todas as familias)
+  resumo = (Tresumo *)calloc((nfamilias + 1) * ntipos, sizeof(Tresumo));
+  for (e = 0; e < total; e++)
+  {
+    r = &res[e];
+    m = &med[e];
+    if (!r->ok)
+      continue;
+    t = (e / nrep) % ntipos;
+    acumula(&resumo[m->familia * ntipos + t], r, m);
+    acumula(&resumo[nfamilias * ntipos + t], r, m);
+  }
+  // instancias em que cada tipo achou a melhor solucao (em alguma execucao)
+  for (a = 0; a < narquivos; a++)
+    for (t = 0; t < ntipos; t++)
+    {
+      if (lista[t] == 1)
+        continue;
+      melhor = -DBL_MAX;
+      for (c = 0; c < nrep; c++)
+      {
+        r = &res[(a * ntipos + t) * nrep + c];
+        if (r->ok && r->z > melhor)
+          melhor = r->z;
+      }
+      if (melhor > -DBL_MAX && melhor > z_inst[a] - 0.5)
+      {
+        resumo[familia[a] * ntipos + t].melhores++;
+        resumo[nfamilias * ntipos + t].melhores++;
+      }
+    }
+
+  fcsv = abre_saida(prefixo, "-resumo.csv");
+  fjson = abre_saida(prefixo, "-resumo.json");
+  if (fcsv)
+    fprintf(fcsv, "familia;tipo;execucoes;gap_dualidade_medio;gap_otimalidade_medio;otimas;melhores;tempo_medio;tempo_desvio;tempo_medio_otimas\n");
+  if (fjson)
+    fprintf(fjson, "{\n  \"execucoes_por_par\": %d,\n  \"semente\": %u,\n  \"limite_ms\": %.0lf,\n  \"resumo\": [", nrep, semente, par->limite);
+  primeiro = 1;
+  for (f = 0; f <= nfamilias; f++)
+    for (t = 0; t < ntipos; t++)
+    {
+      s = &resumo[f * ntipos + t];
+      if (s->execucoes == 0)
+        continue;
+      media = s->tempo / s->execucoes;
+      desvio = (s->execucoes > 1) ? sqrt(fmax(0.0, (s->tempo2 - s->tempo * media) / (s->execucoes - 1))) : 0.0;
+      if (fcsv)
+      {
+        fprintf(fcsv, "%s;%d;%d;", (f < nfamilias) ? familias[f] : "todas", lista[t], s->execucoes);
+        imprime_gap(fcsv, s->ndual ? s->gap_dual / s->ndual : SEM_VALOR, "");
+        fprintf(fcsv, ";%.4lf;%d;%d;%lf;%lf;", s->gap_otim / s->execucoes, s->otimas, s->melhores, media, desvio);
+        if (s->otimas)
+          fprintf(fcsv, "%lf", s->tempo_otimas / s->otimas);
+        fprintf(fcsv, "\n");
+      }
+      if (fjson)
+      {
+        fprintf(fjson, "%s\n    {\"familia\": \"%s\", \"tipo\": %d, \"execucoes\": %d, \"gap_dualidade_medio\": ", primeiro ? "" : ",", (f < nfamilias) ? familias[f] : "todas", lista[t], s->execucoes);
+        imprime_gap(fjson, s->ndual ? s->gap_dual / s->ndual : SEM_VALOR, "null");
+        fprintf(fjson, ", \"gap_otimalidade_medio\": %.4lf, \"otimas\": %d, \"melhores\": %d, \"tempo_medio\": %lf, \"tempo_desvio\": %lf, \"tempo_medio_otimas\": ", s->gap_otim / s->execucoes, s->otimas, s->melhores, media, desvio);
+        if (s->otimas)
+          fprintf(fjson, "%lf}", s->tempo_otimas / s->otimas);
+        else
+          fprintf(fjson, "null}");
+      }
+      primeiro = 0;
+    }
+  if (fcsv)
+    fclose(fcsv);
+  if (fjson)
+  {
+    fprintf(fjson, "\n  ]\n}\n");
+    fclose(fjson);
+  }
+
+  // perfis de desempenho: tempo medio de cada tipo em cada instancia (infinito
+  // se nao resolve) dividido pelo do tipo mais rapido; a relaxacao nao entra
+  fperfil = abre_saida(prefixo, "-perfil.csv");
+  tempo_ps = (double *)malloc(sizeof(double) * ntipos);
+  if (fperfil)
+  {
+    fprintf(fperfil, "familia;tipo;tau;fracao\n");
+    for (f = 0; f < nfamilias; f++)
+    {
+      resolvidas = (int *)calloc(ntipos * PERFIL_PONTOS, sizeof(int));
+      ninst = 0;
+
+      for (a = 0; a < narquivos; a++)
+      {
+        if (familia[a] != f)
+          continue;
+        ninst++;
+        melhor = DBL_MAX;
+        for (t = 0; t < ntipos; t++)
+        {
+          tempo_ps[t] = DBL_MAX;
+          if (lista[t] == 1)
+            continue;
+          tempo = 0.0;
+          media = 0.0;
+          for (cont = 0, c = 0; c < nrep; c++)
+          {
+            e = (a * ntipos + t) * nrep + c;
+            if (!res[e].ok || med[e].gap_otim == SEM_VALOR)
+              continue;
+            tempo += fmax(res[e].tempo, PERFIL_TEMPO_MIN);
+            media += med[e].gap_otim;
+            cont++;
+          }
+          if (cont > 0 && media / cont <= PERFIL_TOLERANCIA)
+            tempo_ps[t] = tempo / cont;
+          if (tempo_ps[t] < melhor)
+            melhor = tempo_ps[t];
+        }
+        for (t = 0; t < ntipos; t++)
+          if (tempo_ps[t] < DBL_MAX)
+            for (i = 0; i < PERFIL_PONTOS; i++)
+              if (tempo_ps[t] <= pow(2.0, i / 4.0) * melhor * (1 + 1e-9))
+                resolvidas[t * PERFIL_PONTOS + i]++;
+      }
+      for (t = 0; t < ntipos; t++)
+      {
+        if (lista[t] == 1)
+          continue;
+        for (i = 0; i < PERFIL_PONTOS; i++)
+        {
+          tau = pow(2.0, i / 4.0);
+          fprintf(fperfil, "%s;%d;%.4lf;%.4lf\n", familias[f], lista[t], tau, (double)resolvidas[t * PERFIL_PONTOS + i] / ninst);
+        }
+      }
+      free(resolvidas);
+    }
+    fclose(fperfil);
+  }
+
+  fprintf(stderr, "experimento: %d execucoes (%d instancias x %d tipos x %d), %d familias, %d falhas, tempo total=%lf\n", total, narquivos, ntipos, nrep, nfamilias, falhas, glp_difftime(agora, antes));
+
+  // libera memoria alocada
+  for (a = 0; a < narquivos; a++)
+    free(arquivos[a]);
+  free(arquivos);
+  free(res);
+  free(med);
+  free(resumo);
+  free(familias);
+  free(familia);
+  free(ub_inst);
+  free(z_inst);
+  free(tempo_ps);
+  return 1;
+}
+
+/* eof */
@@ -0,0 +1,943 @@
+/* geracao_colunas.c
+geracao de colunas sobre o modelo de empacotamento (tipo 16)
+
+Cada coluna do problema mestre eh um padrao: um conjunto de itens que cabe em
+uma mochila de capacidade C_q (as mochilas de mesma capacidade formam uma
+classe q com m_q mochilas):
+
+   max  sum_p v_p y_p
+   s.a. sum_{p contem i} y_p <= 1     para cada item i     (dual pi_i)
+        sum_{p da classe q} y_p <= m_q  para cada classe q   (dual mu_q)
+        y_p >= 0
+
+A relaxacao linear do mestre eh o dual lagrangiano das restricoes de
+unicidade (ver lagrangiana.c), bem mais forte que a do modelo F1. O mestre
+restrito eh resolvido pelo glp_simplex partindo da base anterior (as colunas
+novas entram fora da base e a base continua primal viavel). O pricing de cada
+classe eh uma mochila 0-1 com os valores reduzidos v_i - pi_i, resolvida pelo
+MT1 (glp_knapsack) com os valores escalados e arredondados para cima: a coluna
+encontrada entra se o seu custo reduzido exato for positivo, e o valor do MT1
+da um limitante valido em qualquer iteracao:
+
+   UB(pi) = sum_i pi_i + sum_q m_q max { sum_i (v_i - pi_i) x_i : sum_i p_i x_i <= C_q }
+
+Todas as colunas geradas ficam no pool (sem repeticao) e o mestre eh
+resolvido por branch-and-price: em cada no da arvore (busca em profundidade)
+as colunas sao geradas ate o mestre ficar otimo, e o no eh podado se o
+limitante UB(pi) nao passar da melhor solucao. Se a solucao do mestre for
+fracionaria, o no eh dividido, nesta ordem:
+ - pela cobertura f_i (soma de y_p das colunas com o item i) fracionaria: i
+   fica fora (as colunas com i saem) ou dentro (a linha de i vira = 1, com uma
+   coluna artificial de custo -M para o mestre continuar viavel);
+ - pela cobertura de i na classe q fracionaria (mais de uma classe): i so vai
+   para a classe q ou nunca vai para ela;
+ - por um par de itens (Ryan e Foster) com soma fracionaria: juntos (as
+   colunas tem os dois ou nenhum) ou separados (nunca os dois). Com as
+   coberturas inteiras, uma coluna fracionaria p e outra coluna com um item
+   de p sempre dao esse par.
+As colunas do pool que violam as decisoes do no ficam com limite 0 e o
+pricing respeita as mesmas decisoes: os itens que devem ficar juntos viram um
+unico item, e pares separados fazem o pricing passar do MT1 para uma busca em
+profundidade com os conflitos (limitada a CG_CONFLITO_NOS nos; no limite, o
+limitante do no eh o de Dantzig).
+
+A arvore vai ate CG_FRACAO_MIP do tempo do fim. Se ela nao terminar (ou se
+algum pricing nao for exato), as colunas do pool viram binarias e o mestre
+restrito eh resolvido pelo B&B do GLPK com o tempo restante, partindo da
+melhor solucao (no inicio, a gulosa + busca local, cujas mochilas sao as
+primeiras colunas do pool). A solucao eh desagregada: as colunas de cada
+classe vao para as mochilas da classe, em ordem.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <float.h>
+#include <glpk.h>
+#include "mochila_multipla.h"
+
+#define CG_ESCALA_MAX 1e6      /* maior escala dos valores reduzidos no MT1 */
+#define CG_MT1_LIMITE 20000    /* retrocessos de cada chamada do MT1 */
+#define CG_FRACAO_MIP 0.25     /* fracao minima do tempo para o B&B final */
+#define CG_FRACAO_INICIAL 0.02 /* fracao do tempo para a busca local inicial */
+#define CG_CONFLITO_NOS 20000  /* nos da busca do pricing com pares separados */
+#define CG_PARES_MAX 1024      /* decisoes de pares em um caminho da arvore */
+
+// coluna (padrao) do problema mestre
+typedef struct
+{
+  int q;          /* classe da coluna */
+  int tam;        /* total de itens */
+  int *itens;     /* itens (posicoes em I.item), em ordem crescente */
+  double valor;   /* valor dos itens */
+  unsigned chave; /* hash dos itens (para o pool) */
+} Tcoluna;
+
+// estado da geracao de colunas
+typedef struct
+{
+  Tinstance I;
+  int nq;         /* total de classes (capacidades distintas) */
+  int *cap;       /* capacidade de cada classe */
+  int *mult;      /* mochilas de cada classe */
+  int *classe;    /* classe de cada mochila */
+  Tcoluna *pool;  /* colunas geradas (a coluna t do pool eh a n + t + 1 do mestre) */
+  int ncol, capcol;
+  int *hash;      /* tabela de espalhamento do pool (-1 = vazia) */
+  int tam_hash;   /* potencia de 2 */
+  glp_prob *mestre; /* colunas 1..n: artificiais dos itens dentro */
+  double M;       /* custo das colunas artificiais */
+  double *pi;     /* duais dos itens */
+  int *a, *c, *pos; /* mochila do pricing (de 1 a m, como no glp_knapsack) */
+  char *x;
+  double *red;    /* valor reduzido de cada item do pricing */
+  int *comp;      /* componente (itens que devem ficar juntos) de cada item */
+  double *comp_red; /* valor reduzido de cada componente (pela raiz) */
+  int *comp_peso; /* peso de cada componente */
+  int *comp_pos;  /* item do pricing de cada componente (0 = fora, -1 = proibido) */
+  Tchave *ordem;  /* itens do pricing com conflitos, por razao */
+  char *sel;      /* itens escolhidos na busca com conflitos */
+  int *ca, *cb, nconf; /* conflitos (itens do pricing) */
+  int m_dfs, nos_dfs;
+  double melhor_dfs;
+  int *itens;     /* itens de uma coluna (n posicoes) */
+  // decisoes do no corrente
+  signed char *estado; /* 0 = livre, 1 = dentro, -1 = fora */
+  int *fixa;      /* unica classe permitida de cada item (-1 = todas) */
+  int *proibe;    /* n x nq: decisoes que tiram o item da classe */
+  int *par_i, *par_l, npares;
+  signed char *par_junto; /* 1 = juntos, 0 = separados */
+  // arvore
+  double *y;      /* solucao do mestre (colunas do pool, do tamanho do pool) */
+  double *f;      /* cobertura de cada item */
+  double *g;      /* n x nq: cobertura de cada item em cada classe */
+  char *marca;
+  int *inc, ninc; /* colunas da melhor solucao */
+  double z;       /* valor da melhor solucao */
+  double ub_raiz; /* limitante da raiz */
+  int inteiro;    /* 1 se todos os valores sao inteiros */
+  int nos, it;
+  int exato;      /* 0 se algum pricing ou divisao nao foi exato */
+  int parou;      /* 1 se o prazo da arvore acabou */
+  double inicio, prazo; /* prazo da arvore (em ms desde inicio) */
+  glp_smcp param_lp;
+  Tarena *arena;  /* itens das colunas e vetores de trabalho */
+} Tcg;
+
+/* hash de um conjunto de itens de uma classe */
+static unsigned espalha(int q, int tam, int *itens)
+{
+  unsigned h = 2166136261u ^ (unsigned)q;
+  int t;
+
+  for (t = 0; t < tam; t++)
+    h = (h ^ (unsigned)itens[t]) * 16777619u;
+  return h;
+}
+
+/* procura a coluna no pool; devolve a posicao na tabela (vazia ou igual) */
+static int procura(Tcg *G, int q, int tam, int *itens, unsigned chave)
+{
+  int h = (int)(chave & (unsigned)(G->tam_hash - 1)), p;
+
+  while ((p = G->hash[h]) >= 0)
+  {
+    if (G->pool[p].chave == chave && G->pool[p].q == q && G->pool[p].tam == tam &&
+        memcmp(G->pool[p].itens, itens, sizeof(int) * tam) == 0)
+      break;
+    h = (h + 1) & (G->tam_hash - 1);
+  }
+  return h;
+}
+
+/* acrescenta a coluna (itens em ordem crescente) ao pool e ao mestre;
+   devolve 0 se ela ja estava no pool */
+static int acrescenta_coluna(Tcg *G, int q, int tam, int *itens)
+{
+  Tcoluna *col;
+  unsigned chave;
+  int h, t, j, *ind;
+  double *val;
+  Tmarca m;
+
+  chave = espalha(q, tam, itens);
+  h = procura(G, q, tam, itens, chave);
+  if (G->hash[h] >= 0)
+    return 0;
+
+  if (G->ncol == G->capcol)
+  {
+    G->capcol *= 2;
+    G->pool = (Tcoluna *)realloc(G->pool, sizeof(Tcoluna) * G->capcol);
+    G->y = (double *)realloc(G->y, sizeof(double) * G->capcol);
+  }
+  col = &G->pool[G->ncol];
+  col->q = q;
+  col->tam = tam;
+  col->itens = (int *)arena_aloca(G->arena, sizeof(int) * (tam > 0 ? tam : 1));
+  memcpy(col->itens, itens, sizeof(int) * tam);
+  col->chave = chave;
+  col->valor = 0.0;
+  for (t = 0; t < tam; t++)
+    col->valor += G->I.item[itens[t]].valor;
+  G->hash[h] = G->ncol;
+  G->ncol++;
+
+  // tabela com no maximo metade ocupada
+  if (2 * G->ncol > G->tam_hash)
+  {
+    free(G->hash);
+    G->tam_hash *= 2;
+    G->hash = (int *)malloc(sizeof(int) * G->tam_hash);
+    for (h = 0; h < G->tam_hash; h++)
+      G->hash[h] = -1;
+    for (t = 0; t < G->ncol; t++)
+      G->hash[procura(G, G->pool[t].q, G->pool[t].tam, G->pool[t].itens, G->pool[t].chave)] = t;
+  }
+
+  // coluna do mestre: linhas dos itens e da classe
+  m = arena_marca(G->arena);
+  ind = (int *)arena_aloca(G->arena, sizeof(int) * (tam + 2));
+  val = (double *)arena_aloca(G->arena, sizeof(double) * (tam + 2));
+  for (t = 0; t < tam; t++)
+  {
+    ind[t + 1] = itens[t] + 1;
+    val[t + 1] = 1.0;
+  }
+  ind[tam + 1] = G->I.n + q + 1;
+  val[tam + 1] = 1.0;
+  j = glp_add_cols(G->mestre, 1); // = n + ncol
+  glp_set_col_bnds(G->mestre, j, GLP_LO, 0.0, 0.0);
+  glp_set_obj_coef(G->mestre, j, col->valor);
+  glp_set_mat_col(G->mestre, j, tam + 1, ind, val);
+  arena_volta(G->arena, m);
+  return 1;
+}
+
+/* 1 se a coluna tem o item i (itens em ordem crescente) */
+static int contem(Tcoluna *col, int i)
+{
+  int ini = 0, fim = col->tam - 1, meio;
+
+  while (ini <= fim)
+  {
+    meio = (ini + fim) / 2;
+    if (col->itens[meio] == i)
+      return 1;
+    if (col->itens[meio] < i)
+      ini = meio + 1;
+    else
+      fim = meio - 1;
+  }
+  return 0;
+}
+
+/* 1 se o item i pode ir para a classe q no no corrente */
+static int permitido(Tcg *G, int i, int q)
+{
+  return G->estado[i] >= 0 && (G->fixa[i] < 0 || G->fixa[i] == q) && G->proibe[i * G->nq + q] == 0;
+}
+
+/* 1 se a coluna respeita as decisoes do no corrente */
+static int compativel(Tcg *G, Tcoluna *col)
+{
+  int t;
+
+  for (t = 0; t < col->tam; t++)
+    if (!permitido(G, col->itens[t], col->q))
+      return 0;
+  for (t = 0; t < G->npares; t++)
+  {
+    if (G->par_junto[t] ? contem(col, G->par_i[t]) != contem(col, G->par_l[t])
+                        : contem(col, G->par_i[t]) && contem(col, G->par_l[t]))
+      return 0;
+  }
+  return 1;
+}
+
+/* limites do mestre para as decisoes do no corrente */
+static void aplica_limites(Tcg *G)
+{
+  int i, t;
+
+  for (i = 0; i < G->I.n; i++)
+  {
+    if (G->estado[i] > 0)
+    {
+      glp_set_row_bnds(G->mestre, i + 1, GLP_FX, 1.0, 1.0);
+      glp_set_col_bnds(G->mestre, i + 1, GLP_DB, 0.0, 1.0);
+    }
+    else
+    {
+      glp_set_row_bnds(G->mestre, i + 1, GLP_UP, 0.0, 1.0);
+      glp_set_col_bnds(G->mestre, i + 1, GLP_FX, 0.0, 0.0);
+    }
+  }
+  for (t = 0; t < G->ncol; t++)
+  {
+    if (compativel(G, &G->pool[t]))
+      glp_set_col_bnds(G->mestre, G->I.n + t + 1, GLP_LO, 0.0, 0.0);
+    else
+      glp_set_col_bnds(G->mestre, G->I.n + t + 1, GLP_FX, 0.0, 0.0);
+  }
+}
+
+/* componente do item i (raiz da floresta dos pares juntos) */
+static int raiz(Tcg *G, int i)
+{
+  while (G->comp[i] != i)
+    i = G->comp[i] = G->comp[G->comp[i]];
+  return i;
+}
+
+/* limitante de Dantzig dos itens ordem[p..m-1] do pricing com capacidade b */
+static double dantzig_conflitos(Tcg *G, int p, int b)
+{
+  double ub = 0.0;
+  int t;
+
+  for (; p < G->m_dfs && b > 0; p++)
+  {
+    t = G->ordem[p].i;
+    if (G->a[t] <= b)
+    {
+      b -= G->a[t];
+      ub += G->red[t];
+    }
+    else
+    {
+      ub += G->red[t] * b / G->a[t];
+      break;
+    }
+  }
+  return ub;
+}
+
+/* 1 se o item t do pricing conflita com algum item escolhido */
+static int conflita(Tcg *G, int t)
+{
+  int k;
+
+  for (k = 0; k < G->nconf; k++)
+    if ((G->ca[k] == t && G->sel[G->cb[k]]) || (G->cb[k] == t && G->sel[G->ca[k]]))
+      return 1;
+  return 0;
+}
+
+/* busca em profundidade da mochila do pricing com conflitos, a partir da
+   posicao p de ordem; a melhor escolha fica em G->x */
+static void busca_conflitos(Tcg *G, int p, int b, double valor)
+{
+  int t;
+
+  if (valor > G->melhor_dfs)
+  {
+    G->melhor_dfs = valor;
+    memcpy(G->x, G->sel, G->m_dfs + 1);
+  }
+  if (p == G->m_dfs || ++G->nos_dfs > CG_CONFLITO_NOS)
+    return;
+  if (valor + dantzig_conflitos(G, p, b) <= G->melhor_dfs + EPSILON)
+    return;
+  t = G->ordem[p].i;
+  if (G->a[t] <= b && !conflita(G, t))
+  {
+    G->sel[t] = 1;
+    busca_conflitos(G, p + 1, b - G->a[t], valor + G->red[t]);
+    G->sel[t] = 0;
+  }
+  busca_conflitos(G, p + 1, b, valor);
+}
+
+/* pricing da classe q: acrescenta a melhor coluna se o seu custo reduzido for
+   positivo e devolve um limitante superior do valor reduzido da mochila. Os
+   itens do pricing sao os componentes dos pares juntos; um componente so
+   entra se todos os seus itens podem ir para a classe q */
+static double pricing(Tcg *G, int q, double mu, int *novas)
+{
+  Tinstance I = G->I;
+  double red, maxred = 0.0, soma = 0.0, escala, ub, rc;
+  int i, l, t, r, m = 0, z, lim = CG_MT1_LIMITE, *itens = G->itens;
+
+  for (i = 0; i < I.n; i++)
+  {
+    G->comp[i] = i;
+    G->comp_red[i] = 0.0;
+    G->comp_peso[i] = 0;
+    G->comp_pos[i] = 0;
+  }
+  for (t = 0; t < G->npares; t++)
+    if (G->par_junto[t])
+      G->comp[raiz(G, G->par_i[t])] = raiz(G, G->par_l[t]);
+  for (i = 0; i < I.n; i++)
+  {
+    r = raiz(G, i);
+    G->comp_red[r] += I.item[i].valor - G->pi[i];
+    G->comp_peso[r] += I.item[i].peso;
+    if (!permitido(G, i, q))
+      G->comp_pos[r] = -1;
+  }
+  for (t = 0; t < G->npares; t++)
+    if (!G->par_junto[t] && raiz(G, G->par_i[t]) == raiz(G, G->par_l[t]))
+      G->comp_pos[raiz(G, G->par_i[t])] = -1;
+
+  // itens do pricing (de 1 a m)
+  for (i = 0; i < I.n; i++)
+  {
+    red = G->comp_red[i];
+    if (raiz(G, i) != i || G->comp_pos[i] < 0 || red <= EPSILON || G->comp_peso[i] > G->cap[q])
+      continue;
+    m++;
+    G->comp_pos[i] = m;
+    G->pos[m] = i;
+    G->a[m] = G->comp_peso[i];
+    G->red[m] = red;
+    soma += red;
+    if (red > maxred)
+      maxred = red;
+  }
+  if (m == 0)
+    return 0.0;
+
+  // conflitos (pares separados) entre os itens do pricing
+  G->nconf = 0;
+  for (t = 0; t < G->npares; t++)
+  {
+    if (G->par_junto[t])
+      continue;
+    i = G->comp_pos[raiz(G, G->par_i[t])];
+    l = G->comp_pos[raiz(G, G->par_l[t])];
+    if (i > 0 && l > 0)
+    {
+      G->ca[G->nconf] = i;
+      G->cb[G->nconf] = l;
+      G->nconf++;
+    }
+  }
+
+  if (G->nconf == 0)
+  {
+    // escala: o MT1 calcula produtos capacidade x valor em int
+    escala = CG_ESCALA_MAX;
+    if (escala * maxred * G->cap[q] > INT_MAX / 4)
+      escala = (INT_MAX / 4) / (maxred * G->cap[q]);
+    if (escala * soma > INT_MAX / 4)
+      escala = (INT_MAX / 4) / soma;
+    for (t = 1; t <= m; t++)
+    {
+      G->c[t] = (int)ceil(escala * G->red[t]);
+      if (G->c[t] < 1)
+        G->c[t] = 1;
+    }
+    z = glp_knapsack(m, G->a, G->cap[q], G->c, G->x, GLP_KS_MT1, &lim);
+    // sem a prova de otimalidade, vale so a soma dos valores reduzidos
+    ub = (lim == -1) ? soma : z / escala;
+    if (lim == -1)
+      G->exato = 0;
+  }
+  else
+  {
+    // busca em profundidade pela razao, com os conflitos
+    for (t = 1; t <= m; t++)
+    {
+      G->ordem[t - 1].chave = G->red[t] / G->a[t];
+      G->ordem[t - 1].i = t;
+      G->sel[t] = G->x[t] = 0;
+    }
+    qsort(G->ordem, m, sizeof(Tchave), comparador_chave);
+    G->m_dfs = m;
+    G->nos_dfs = 0;
+    G->melhor_dfs = 0.0;
+    busca_conflitos(G, 0, G->cap[q], 0.0);
+    ub = G->melhor_dfs;
+    if (G->nos_dfs > CG_CONFLITO_NOS)
+    {
+      ub = dantzig_conflitos(G, 0, G->cap[q]);
+      G->exato = 0;
+    }
+  }
+
+  // coluna encontrada (itens em ordem crescente) e o seu custo reduzido exato
+  rc = -mu;
+  for (i = 0, t = 0; i < I.n; i++)
+  {
+    r = G->comp_pos[raiz(G, i)];
+    if (r > 0 && G->x[r])
+    {
+      itens[t++] = i;
+      rc += I.item[i].valor - G->pi[i];
+    }
+  }
+  if (t > 0 && rc > EPSILON * (1.0 + fabs(mu)) && acrescenta_coluna(G, q, t, itens))
+    (*novas)++;
+  return ub;
+}
+
+/* 1 se o limitante ub do no nao passa da melhor solucao */
+static int podado(Tcg *G, double ub)
+{
+  if (G->inteiro)
+    ub = floor(ub + EPSILON);
+  return ub <= G->z + EPSILON;
+}
+
+/* gera colunas no no corrente ate o mestre ficar otimo (ou o no ser podado);
+   devolve o limitante do no e deixa em *z_lp o valor do mestre */
+static double gera_no(Tcg *G, double *z_lp)
+{
+  Tinstance I = G->I;
+  double ub = DBL_MAX, ub_it, mu;
+  int i, q, novas;
+
+  *z_lp = -DBL_MAX;
+  for (;;)
+  {
+    glp_simplex(G->mestre, &G->param_lp);
+    if (glp_get_status(G->mestre) != GLP_OPT)
+    {
+      *z_lp = -DBL_MAX;
+      G->exato = 0;
+      break;
+    }
+    *z_lp = glp_get_obj_val(G->mestre);
+    G->it++;
+
+    // UB(pi): as linhas dos itens fora ficam sem dual, as dos itens dentro
+    // (= 1) aceitam duais negativos e entram com as suas artificiais
+    ub_it = 0.0;
+    for (i = 0; i < I.n; i++)
+    {
+      G->pi[i] = (G->estado[i] < 0) ? 0.0 : glp_get_row_dual(G->mestre, i + 1);
+      if (G->estado[i] == 0 && G->pi[i] < 0.0)
+        G->pi[i] = 0.0;
+      ub_it += G->pi[i];
+      if (G->estado[i] > 0 && -G->M - G->pi[i] > 0.0)
+        ub_it += -G->M - G->pi[i];
+    }
+    novas = 0;
+    for (q = 0; q < G->nq; q++)
+    {
+      mu = glp_get_row_dual(G->mestre, I.n + q + 1);
+      if (mu < 0.0)
+        mu = 0.0;
+      ub_it += G->mult[q] * pricing(G, q, mu, &novas);
+    }
+    if (ub_it < ub)
+      ub = ub_it;
+    PRINTF("geracao_colunas: no=%d it=%d mestre=%.2lf ub=%.2lf colunas=%d novas=%d\n", G->nos, G->it, *z_lp, ub, G->ncol, novas);
+
+    if (novas == 0 || ub <= *z_lp + EPSILON || podado(G, ub))
+      break;
+    if (glp_difftime(glp_mono_time(), G->inicio) * 1000 >= G->prazo)
+    {
+      G->parou = 1;
+      break;
+    }
+  }
+  return ub;
+}
+
+/* guarda a solucao inteira do mestre (colunas com y = 1) se ela for melhor */
+static void nova_solucao(Tcg *G, double z)
+{
+  int t;
+
+  if (z <= G->z + EPSILON)
+    return;
+  G->ninc = 0;
+  for (t = 0; t < G->ncol; t++)
+    if (G->y[t] > 0.5)
+      G->inc[G->ninc++] = t;
+  G->z = z;
+  PRINTF("geracao_colunas: no=%d nova solucao %.0lf\n", G->nos, z);
+}
+
+/* no da arvore do branch-and-price (decisoes ja aplicadas em G) */
+static void no_bp(Tcg *G)
+{
+  Tinstance I = G->I;
+  double ub, z_lp, v, mais;
+  int i, l, q, t, p, u, esc = -1, esc_q = -1;
+  signed char antigo;
+
+  if (glp_difftime(glp_mono_time(), G->inicio) * 1000 >= G->prazo)
+  {
+    G->parou = 1;
+    return;
+  }
+  aplica_limites(G);
+  ub = gera_no(G, &z_lp);
+  if (G->nos++ == 0)
+    G->ub_raiz = ub;
+  if (G->parou || z_lp == -DBL_MAX || podado(G, ub))
+    return;
+
+  // com as colunas inteiras as artificiais sao 0 ou 1, e uma artificial em 1
+  // deixa o mestre negativo (o no ja foi podado); fracionarias, elas deixam a
+  // cobertura do item fracionaria, e a divisao fica para as classes ou pares
+
+  // solucao do mestre e coberturas
+  memset(G->f, 0, sizeof(double) * I.n);
+  memset(G->g, 0, sizeof(double) * I.n * G->nq);
+  p = -1;
+  for (t = 0; t < G->ncol; t++)
+  {
+    G->y[t] = glp_get_col_prim(G->mestre, I.n + t + 1);
+    if (G->y[t] <= EPSILON)
+      continue;
+    if (G->y[t] < 1.0 - EPSILON && p < 0)
+      p = t;
+    for (u = 0; u < G->pool[t].tam; u++)
+    {
+      G->f[G->pool[t].itens[u]] += G->y[t];
+      G->g[G->pool[t].itens[u] * G->nq + G->pool[t].q] += G->y[t];
+    }
+  }
+  if (p < 0)
+  {
+    nova_solucao(G, z_lp);
+    return;
+  }
+
+  // divisao pela cobertura do item mais fracionario
+  mais = 0.0;
+  for (i = 0; i < I.n; i++)
+  {
+    v = (G->f[i] < 0.5) ? G->f[i] : 1.0 - G->f[i];
+    if (G->estado[i] == 0 && v > EPSILON && v > mais)
+    {
+      mais = v;
+      esc = i;
+    }
+  }
+  if (esc >= 0)
+  {
+    i = esc;
+    v = G->f[i];
+    G->estado[i] = (v >= 0.5) ? 1 : -1;
+    no_bp(G);
+    G->estado[i] = -G->estado[i];
+    no_bp(G);
+    G->estado[i] = 0;
+    return;
+  }
+
+  // divisao pela cobertura de um item em uma classe
+  mais = 0.0;
+  for (i = 0; i < I.n && G->nq > 1; i++)
+    for (q = 0; q < G->nq; q++)
+    {
+      v = G->g[i * G->nq + q];
+      v = (v < 0.5) ? v : 1.0 - v;
+      if (v > EPSILON && v > mais)
+      {
+        mais = v;
+        esc = i;
+        esc_q = q;
+      }
+    }
+  if (esc >= 0)
+  {
+    i = esc;
+    q = esc_q;
+    for (u = 0; u < 2; u++)
+    {
+      if ((u == 0) == (G->g[i * G->nq + q] >= 0.5))
+      {
+        G->fixa[i] = q;
+        no_bp(G);
+        G->fixa[i] = -1;
+      }
+      else
+      {
+        G->proibe[i * G->nq + q]++;
+        no_bp(G);
+        G->proibe[i * G->nq + q]--;
+      }
+    }
+    return;
+  }
+
+  // divisao de Ryan e Foster: um item i de uma coluna fracionaria p, outra
+  // coluna com i e um item l que so uma das duas tem
+  if (G->npares == CG_PARES_MAX)
+  {
+    G->exato = 0;
+    return;
+  }
+  i = l = -1;
+  for (; p < G->ncol && l < 0; p++)
+  {
+    if (G->y[p] <= EPSILON || G->y[p] >= 1.0 - EPSILON)
+      continue;
+    memset(G->marca, 0, I.n);
+    for (u = 0; u < G->pool[p].tam; u++)
+      G->marca[G->pool[p].itens[u]] = 1;
+    for (t = 0; t < G->ncol && l < 0; t++)
+    {
+      if (t == p || G->y[t] <= EPSILON)
+        continue;
+      for (u = 0; u < G->pool[t].tam && !G->marca[G->pool[t].itens[u]]; u++)
+        ;
+      if (u == G->pool[t].tam)
+        continue; // nenhum item de p
+      i = G->pool[t].itens[u];
+      // l em t e fora de p ou em p e fora de t
+      for (u = 0; u < G->pool[t].tam && l < 0; u++)
+        if (!G->marca[G->pool[t].itens[u]])
+          l = G->pool[t].itens[u];
+      for (u = 0; u < G->pool[p].tam && l < 0; u++)
+        if (!contem(&G->pool[t], G->pool[p].itens[u]))
+          l = G->pool[p].itens[u];
+    }
+  }
+  if (l < 0)
+  {
+    G->exato = 0;
+    return;
+  }
+  v = 0.0;
+  for (t = 0; t < G->ncol; t++)
+    if (G->y[t] > EPSILON && contem(&G->pool[t], i) && contem(&G->pool[t], l))
+      v += G->y[t];
+  G->par_i[G->npares] = i;
+  G->par_l[G->npares] = l;
+  antigo = (v >= 0.5);
+  for (u = 0; u < 2; u++)
+  {
+    G->par_junto[G->npares] = (u == 0) ? antigo : !antigo;
+    G->npares++;
+    no_bp(G);
+    G->npares--;
+  }
+}
+
+/* branch-and-price seguido, se a arvore nao terminar, do B&B sobre o pool;
+   a solucao fica em I.item[].index e o limitante em info->best_dualBound */
+double geracao_colunas(Tinstance I, Tparametros *par, my_infoT *info)
+{
+  Tcg G;
+  Tchave *chaves;
+  glp_iocp param_ilp;
+  double z, ub, *x0, resta, *um;
+  int *capacidade, *itens, *proxima, *ind, i, j, q, t, tam, completa;
+  Tarena *A = info->arena;
+  Tmarca m = arena_marca(A);
+
+  G.inicio = glp_mono_time();
+  G.I = I;
+  G.arena = A;
+
+  // classes: uma para cada capacidade distinta
+  chaves = (Tchave *)arena_aloca(A, sizeof(Tchave) * (I.n > I.k ? I.n : I.k));
+  for (j = 0; j < I.k; j++)
+  {
+    chaves[j].chave = I.C[j];
+    chaves[j].i = j;
+  }
+  qsort(chaves, I.k, sizeof(Tchave), comparador_chave);
+  G.cap = (int *)arena_aloca(A, sizeof(int) * I.k);
+  G.mult = (int *)arena_aloca(A, sizeof(int) * I.k);
+  G.classe = (int *)arena_aloca(A, sizeof(int) * I.k);
+  G.nq = 0;
+  for (t = 0; t < I.k; t++)
+  {
+    j = chaves[t].i;
+    if (G.nq == 0 || G.cap[G.nq - 1] != I.C[j])
+    {
+      G.cap[G.nq] = I.C[j];
+      G.mult[G.nq] = 0;
+      G.nq++;
+    }
+    G.mult[G.nq - 1]++;
+    G.classe[j] = G.nq - 1;
+  }
+
+  // solucao inicial: gulosa + busca local (as capacidades originais sao
+  // restauradas, pois a gulosa deixa as residuais em I.C)
+  capacidade = (int *)arena_aloca(A, sizeof(int) * I.k);
+  memcpy(capacidade, I.C, sizeof(int) * I.k);
+  guloso(I, A);
+  memcpy(I.C, capacidade, sizeof(int) * I.k);
+  z = busca_local(I, par->limite * CG_FRACAO_INICIAL, info);
+  PRINTF("geracao_colunas: solucao inicial %.0lf, %d classes\n", z, G.nq);
+
+  // mestre: linhas dos itens e das classes; colunas artificiais dos itens
+  G.M = 1.0;
+  G.inteiro = 1;
+  for (i = 0; i < I.n; i++)
+  {
+    if (I.item[i].valor > 0)
+      G.M += I.item[i].valor;
+    if (I.item[i].valor != floor(I.item[i].valor))
+      G.inteiro = 0;
+  }
+  glp_term_out(GLP_OFF);
+  G.mestre = glp_create_prob();
+  glp_set_prob_name(G.mestre, "mestre");
+  glp_set_obj_dir(G.mestre, GLP_MAX);
+  glp_add_rows(G.mestre, I.n + G.nq);
+  for (i = 1; i <= I.n; i++)
+    glp_set_row_bnds(G.mestre, i, GLP_UP, 0.0, 1.0);
+  for (q = 0; q < G.nq; q++)
+    glp_set_row_bnds(G.mestre, I.n + q + 1, GLP_UP, 0.0, G.mult[q]);
+  if (I.n > 0)
+    glp_add_cols(G.mestre, I.n);
+  ind = (int *)arena_aloca(A, sizeof(int) * 2);
+  um = (double *)arena_aloca(A, sizeof(double) * 2);
+  um[1] = 1.0;
+  for (i = 1; i <= I.n; i++)
+  {
+    ind[1] = i;
+    glp_set_col_bnds(G.mestre, i, GLP_FX, 0.0, 0.0);
+    glp_set_obj_coef(G.mestre, i, -G.M);
+    glp_set_mat_col(G.mestre, i, 1, ind, um);
+  }
+
+  G.capcol = 64;
+  G.ncol = 0;
+  G.pool = (Tcoluna *)malloc(sizeof(Tcoluna) * G.capcol);
+  G.y = (double *)malloc(sizeof(double) * G.capcol);
+  G.tam_hash = 128;
+  G.hash = (int *)malloc(sizeof(int) * G.tam_hash);
+  for (t = 0; t < G.tam_hash; t++)
+    G.hash[t] = -1;
+  G.pi = (double *)arena_aloca_zerada(A, sizeof(double) * I.n);
+  G.a = (int *)arena_aloca(A, sizeof(int) * (I.n + 1));
+  G.c = (int *)arena_aloca(A, sizeof(int) * (I.n + 1));
+  G.pos = (int *)arena_aloca(A, sizeof(int) * (I.n + 1));
+  G.x = (char *)arena_aloca(A, sizeof(char) * (I.n + 1));
+  G.red = (double *)arena_aloca(A, sizeof(double) * (I.n + 1));
+  G.comp = (int *)arena_aloca(A, sizeof(int) * (I.n + 1));
+  G.comp_red = (double *)arena_aloca(A, sizeof(double) * (I.n + 1));
+  G.comp_peso = (int *)arena_aloca(A, sizeof(int) * (I.n + 1));
+  G.comp_pos = (int *)arena_aloca(A, sizeof(int) * (I.n + 1));
+  G.ordem = (Tchave *)arena_aloca(A, sizeof(Tchave) * (I.n + 1));
+  G.sel = (char *)arena_aloca(A, sizeof(char) * (I.n + 1));
+  G.ca = (int *)arena_aloca(A, sizeof(int) * CG_PARES_MAX);
+  G.cb = (int *)arena_aloca(A, sizeof(int) * CG_PARES_MAX);
+  G.itens = itens = (int *)arena_aloca(A, sizeof(int) * (I.n + 1));
+  G.estado = (signed char *)arena_aloca_zerada(A, sizeof(signed char) * (I.n + 1));
+  G.fixa = (int *)arena_aloca(A, sizeof(int) * (I.n + 1));
+  for (i = 0; i < I.n; i++)
+    G.fixa[i] = -1;
+  G.proibe = (int *)arena_aloca_zerada(A, sizeof(int) * (I.n * (size_t)G.nq + 1));
+  G.par_i = (int *)arena_aloca(A, sizeof(int) * CG_PARES_MAX);
+  G.par_l = (int *)arena_aloca(A, sizeof(int) * CG_PARES_MAX);
+  G.par_junto = (signed char *)arena_aloca(A, sizeof(signed char) * CG_PARES_MAX);
+  G.npares = 0;
+  G.f = (double *)arena_aloca(A, sizeof(double) * (I.n + 1));
+  G.g = (double *)arena_aloca(A, sizeof(double) * (I.n * (size_t)G.nq + 1));
+  G.marca = (char *)arena_aloca(A, sizeof(char) * (I.n + 1));
+  G.inc = (int *)arena_aloca(A, sizeof(int) * (I.k + 1));
+
+  // colunas iniciais: as mochilas da solucao inicial (a melhor solucao)
+  G.ninc = 0;
+  for (j = 0; j < I.k; j++)
+  {
+    for (tam = 0, i = 0; i < I.n; i++)
+      if (I.item[i].index == j + 1)
+        itens[tam++] = i;
+    if (tam > 0 && acrescenta_coluna(&G, G.classe[j], tam, itens))
+      G.inc[G.ninc++] = G.ncol - 1;
+  }
+  G.z = z;
+
+  // branch-and-price
+  glp_init_smcp(&G.param_lp);
+  G.param_lp.msg_lev = GLP_MSG_OFF;
+  G.nos = G.it = 0;
+  G.exato = 1;
+  G.parou = 0;
+  G.ub_raiz = DBL_MAX;
+  G.prazo = par->limite * (1.0 - CG_FRACAO_MIP);
+  no_bp(&G);
+  completa = G.exato && !G.parou;
+  PRINTF("geracao_colunas: arvore com %d nos, %d iteracoes, %d colunas%s\n", G.nos, G.it, G.ncol, completa ? "" : " (incompleta)");
+
+  // arvore incompleta: B&B sobre as colunas do pool, partindo da melhor
+  // solucao, sem as decisoes da arvore
+  if (!completa)
+  {
+    memset(G.estado, 0, sizeof(signed char) * I.n);
+    for (i = 0; i < I.n; i++)
+      G.fixa[i] = -1;
+    memset(G.proibe, 0, sizeof(int) * I.n * (size_t)G.nq);
+    G.npares = 0;
+    aplica_limites(&G);
+    x0 = (double *)arena_aloca_zerada(A, sizeof(double) * (I.n + G.ncol + 1));
+    for (t = 0; t < G.ninc; t++)
+      x0[I.n + G.inc[t] + 1] = 1.0;
+    for (t = 1; t <= G.ncol; t++)
+      glp_set_col_kind(G.mestre, I.n + t, GLP_BV);
+    resta = par->limite - glp_difftime(glp_mono_time(), G.inicio) * 1000;
+    glp_init_iocp(&param_ilp);
+    param_ilp.msg_lev = GLP_MSG_OFF;
+    param_ilp.tm_lim = (int)(resta > par->limite * CG_FRACAO_MIP ? resta : par->limite * CG_FRACAO_MIP);
+    param_ilp.cb_func = my_callback;
+    param_ilp.cb_info = info;
+    info->mip = G.mestre;
+    info->x_inicial = x0;
+    glp_simplex(G.mestre, &G.param_lp);
+    if (glp_get_status(G.mestre) == GLP_OPT)
+      glp_intopt(G.mestre, &param_ilp);
+    info->x_inicial = NULL;
+    if ((glp_mip_status(G.mestre) == GLP_OPT || glp_mip_status(G.mestre) == GLP_FEAS) &&
+        glp_mip_obj_val(G.mestre) > G.z + EPSILON)
+    {
+      G.ninc = 0;
+      for (t = 0; t < G.ncol; t++)
+        if (glp_mip_col_val(G.mestre, I.n + t + 1) > 0.5)
+          G.inc[G.ninc++] = t;
+      G.z = glp_mip_obj_val(G.mestre);
+    }
+  }
+
+  // desagrega: as colunas de cada classe vao para as mochilas da classe
+  if (G.z > z + EPSILON)
+  {
+    proxima = (int *)arena_aloca_zerada(A, sizeof(int) * G.nq);
+    for (i = 0; i < I.n; i++)
+      I.item[i].index = 0;
+    for (t = 0; t < G.ninc; t++)
+    {
+      q = G.pool[G.inc[t]].q;
+      // proxima mochila livre da classe q
+      for (j = 0, tam = proxima[q]++; j < I.k; j++)
+        if (G.classe[j] == q && tam-- == 0)
+          break;
+      for (i = 0; i < G.pool[G.inc[t]].tam; i++)
+        I.item[G.pool[G.inc[t]].itens[i]].index = j + 1;
+    }
+    z = G.z;
+  }
+
+  // limitante: o da arvore se ela terminou, senao o da raiz (valores
+  // inteiros permitem arredondar para baixo)
+  ub = completa ? z : G.ub_raiz;
+  if (G.inteiro && ub != DBL_MAX)
+    ub = floor(ub + EPSILON);
+  if (ub < z)
+    ub = z;
+
+  PRINTF("geracao_colunas: z=%.0lf ub=%.2lf nos=%d iteracoes=%d colunas=%d\n", z, ub, G.nos, G.it, G.ncol);
+
+  info->nodes = G.nos;
+  info->ativos = G.ncol;
+  info->best_primalBound = z;
+  info->best_dualBound = ub;
+  info->gap = (ub - z) / (z + DBL_EPSILON);
+
+  // libera memoria
+  glp_delete_prob(G.mestre);
+  arena_pico_auxiliar(A, (sizeof(Tcoluna) + sizeof(double)) * G.capcol + sizeof(int) * G.tam_hash);
+  free(G.pool);
+  free(G.y);
+  free(G.hash);
+  arena_volta(A, m);
+  return z;
+}
+
+/* eof */
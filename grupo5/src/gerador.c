@@ -0,0 +1,173 @@
+/* gerador.c
+gerador de instancias da mochila multipla para testes de escala
+
+Segue as classes usadas por Pisinger para o MKP. Os pesos sao uniformes em
+[10, R] e os valores dependem da classe:
+   1 = nao correlacionada:            v_i uniforme em [10, R]
+   2 = fracamente correlacionada:     v_i = p_i + uniforme em [-R/10, R/10] (>= 1)
+   3 = fortemente correlacionada:     v_i = p_i + 10
+   4 = inversamente correlacionada:   v_i uniforme em [10, R] e p_i = v_i + 10
+   5 = soma de subconjuntos:          v_i = p_i
+As classes 1 a 3 tem o numero do nome das instancias de testes
+(t<n>-<k>-<R>-<classe>-<s|d>-<id>); nelas a classe 4 eh a soma de
+subconjuntos, que aqui eh a 5.
+As capacidades, com W a soma dos pesos, sao
+   s (semelhantes):   C_j uniforme em [0.4 W/k, 0.6 W/k], j < k
+   d (diferentes):    C_j uniforme em [0, 0.5 (W - soma_{l<j} C_l)], j < k
+e a ultima completa 0.5 W. Uma instancia so eh aceita se cada mochila cabe o
+menor item e o maior item cabe em alguma mochila; as capacidades sao sorteadas
+de novo ate GER_TENTATIVAS vezes e, depois disso (muitas mochilas
+diferentes), as invalidas sao levadas ao menor peso e a maior ao maior peso.
+As capacidades ficam em ordem crescente, como nas instancias de testes.
+
+O gerador eh o glp_rng: a mesma semente gera a mesma instancia em qualquer
+maquina.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <glpk.h>
+#include "mochila_multipla.h"
+
+#define GER_PESO_MIN 10     /* menor peso (e valor) sorteado */
+#define GER_TENTATIVAS 100  /* sorteios das capacidades antes do ajuste */
+
+static int crescente(const void *a, const void *b)
+{
+  int x = *(const int *)a, y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+/* sorteia as capacidades; devolve 1 se elas sao validas para os pesos
+   [pmin, pmax] */
+static int sorteia_capacidades(Tinstance *I, glp_rng *rng, long long W, int similares, int pmin, int pmax)
+{
+  long long soma = 0, c;
+  int j, maior = 0, ok = 1;
+
+  for (j = 0; j < I->k - 1; j++)
+  {
+    if (similares)
+      c = RandomInteger(rng, (int)(0.4 * W / I->k), (int)(0.6 * W / I->k));
+    else
+      c = RandomInteger(rng, 0, (int)(0.5 * (W - soma)));
+    I->C[j] = (int)c;
+    soma += c;
+  }
+  I->C[I->k - 1] = (int)(W / 2 - soma);
+  for (j = 0; j < I->k; j++)
+  {
+    if (I->C[j] < pmin)
+      ok = 0;
+    if (I->C[j] > maior)
+      maior = I->C[j];
+  }
+  return ok && maior >= pmax;
+}
+
+/* gera a instancia da classe (1 a CLASSES) com n itens e k mochilas;
+   devolve 0 se os parametros forem invalidos */
+int gera_instancia(Tinstance *I, int n, int k, int R, int classe, int similares, unsigned semente)
+{
+  glp_rng *rng;
+  long long W = 0;
+  int i, j, p, v, pmin, pmax, t;
+
+  if (n < 1 || k < 1 || R < GER_PESO_MIN || R > INT_MAX - 10 || classe < 1 || classe > CLASSES)
+    return 0;
+  if ((long long)n * (R + 10) / 2 > INT_MAX) // as capacidades sao int
+    return 0;
+
+  I->n = n;
+  I->k = k;
+  I->mapa = NULL;
+  I->tam_mapa = 0;
+  I->C = (int *)malloc(sizeof(int) * k);
+  I->item = (Titem *)malloc(sizeof(Titem) * n);
+  rng = glp_rng_create((int)(semente & 0x7FFFFFFF));
+
+  pmin = pmax = -1;
+  for (i = 0; i < n; i++)
+  {
+    p = RandomInteger(rng, GER_PESO_MIN, R);
+    switch (classe)
+    {
+    case 1:
+      v = RandomInteger(rng, GER_PESO_MIN, R);
+      break;
+    case 2:
+      v = p + RandomInteger(rng, -R / 10, R / 10);
+      if (v < 1)
+        v = 1;
+      break;
+    case 3:
+      v = p + 10;
+      break;
+    case 4:
+      v = p;
+      p = v + 10;
+      break;
+    default:
+      v = p;
+      break;
+    }
+    I->item[i].num = i + 1;
+    I->item[i].peso = p;
+    I->item[i].valor = v;
+    I->item[i].index = 0;
+    W += p;
+    if (pmin < 0 || p < pmin)
+      pmin = p;
+    if (p > pmax)
+      pmax = p;
+  }
+
+  for (t = 0; t < GER_TENTATIVAS; t++)
+    if (sorteia_capacidades(I, rng, W, similares, pmin, pmax))
+      break;
+  if (t == GER_TENTATIVAS)
+  {
+    // ajuste: toda mochila cabe o menor item e a maior cabe o maior
+    PRINTF("gerador: capacidades ajustadas depois de %d sorteios\n", t);
+    j = 0;
+    for (i = 0; i < k; i++)
+    {
+      if (I->C[i] < pmin)
+        I->C[i] = pmin;
+      if (I->C[i] > I->C[j])
+        j = i;
+    }
+    if (I->C[j] < pmax)
+      I->C[j] = pmax;
+  }
+  qsort(I->C, k, sizeof(int), crescente);
+
+  glp_rng_delete(rng);
+  return 1;
+}
+
+/* gera uma instancia e grava em arquivo (.mkpb no formato binario, os demais
+   no formato texto) */
+int gera_arquivo(char *arquivo, int n, int k, int R, int classe, int similares, unsigned semente)
+{
+  Tinstance I;
+  size_t len;
+  int ok;
+
+  if (!gera_instancia(&I, n, k, R, classe, similares, semente))
+  {
+    printf("\nParametros invalidos: n e k >= 1, R >= %d, n*R/2 cabe em int e classe de 1 a %d\n", GER_PESO_MIN, CLASSES);
+    return 0;
+  }
+  len = strlen(arquivo);
+  if (len > 5 && strcmp(arquivo + len - 5, ".mkpb") == 0)
+    ok = grava_instancia_mkpb(arquivo, I);
+  else
+    ok = grava_instancia_texto(arquivo, I);
+  free_instancia(I);
+  return ok;
+}
+
+/* eof */
@@ -0,0 +1,205 @@
+/* heuristica_no.c
+heuristica primal nos nos do branch-and-bound do GLPK (tipo 2 com -h)
+
+Na razao GLP_IHEUR da callback (a relaxacao do no eh otima, mas fracionaria),
+a solucao do no eh arredondada e reparada:
+ - arredondamento: as colunas com x_ij = 1 (inclusive as fixadas pelo
+   branching) ficam na solucao, se couberem (x_ij pode ser 1 - tolerancia);
+ - reparo guloso: os itens restantes sao tomados em ordem decrescente da sua
+   maior fracao x_ij (empates pelo valor/peso) e cada um vai para a mochila
+   de maior x_ij em que cabe ou, se nenhuma delas couber, para a de menor
+   folga (best-fit);
+ - busca local curta: cada item livre, em ordem decrescente de valor, tenta
+   trocar de lugar com o item de menor valor de alguma mochila em que a troca
+   cabe (no maximo HN_TROCAS trocas).
+A solucao so eh entregue ao GLPK (glp_ios_heur_sol) se for melhor que a
+incumbente. Ela precisa ser viavel so para o MKP, e nao para os limites do no
+(o reparo pode usar colunas fixadas em 0 pelo branching). Funciona tambem no
+modelo reduzido do preprocessamento: so as colunas do modelo sao usadas e as
+capacidades sao as das linhas 1..k.
+
+Para que a heuristica nao tome o tempo do B&B, ela so roda a cada freq nos
+(e sempre na raiz), quando o limitante do no pode melhorar a incumbente e
+enquanto o seu tempo total for menor que HN_FRACAO do tempo do B&B. Os
+vetores de trabalho sao tirados uma vez da arena, antes do B&B.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glpk.h>
+#include "mochila_multipla.h"
+
+#define HN_FRACAO 0.1  /* fracao maxima do tempo do B&B gasta na heuristica */
+#define HN_UM 0.999    /* x_ij arredondado para 1 */
+#define HN_TROCAS 64   /* trocas da busca local por chamada */
+
+/* prepara a heuristica para o modelo com m colunas (col = NULL: modelo
+   completo, coluna j*n + i + 1 para x_ij); os vetores saem da arena A e
+   valem ate quem chamou devolve-la */
+void heuristica_no_cria(Theur_no *H, Tinstance I, const int *col, int m, int freq, Tarena *A)
+{
+  int c, v;
+
+  H->I = I;
+  H->m = m;
+  H->col = col;
+  H->freq = freq;
+  H->tempo = 0.0;
+  H->inicio = glp_mono_time();
+  H->nos = H->chamadas = H->melhorias = 0;
+  H->coluna = (int *)arena_aloca(A, sizeof(int) * I.n * (size_t)I.k);
+  for (v = 0; v < I.n * I.k; v++)
+    H->coluna[v] = col ? 0 : v + 1;
+  if (col != NULL)
+    for (c = 1; c <= m; c++)
+      H->coluna[col[c]] = c;
+  H->index = (int *)arena_aloca(A, sizeof(int) * I.n);
+  H->res = (int *)arena_aloca(A, sizeof(int) * I.k);
+  H->maior = (double *)arena_aloca(A, sizeof(double) * I.n);
+  H->x = (double *)arena_aloca(A, sizeof(double) * (m + 1));
+  H->chaves = (Tchave *)arena_aloca(A, sizeof(Tchave) * I.n);
+}
+
+/* troca itens livres por itens de menor valor das mochilas; devolve o ganho */
+static double trocas(Theur_no *H)
+{
+  Tinstance I = H->I;
+  double ganho = 0.0;
+  int t, i, l, j, melhor, feitas = 0;
+
+  for (t = 0; t < I.n && feitas < HN_TROCAS; t++)
+  {
+    i = H->chaves[t].i;
+    if (H->index[i] != 0)
+      continue;
+    // item l da mochila j de menor valor que cabe a troca por i
+    melhor = -1;
+    for (l = 0; l < I.n; l++)
+    {
+      j = H->index[l] - 1;
+      if (j < 0 || I.item[l].valor >= I.item[i].valor || H->coluna[j * I.n + i] == 0)
+        continue;
+      if (H->res[j] + I.item[l].peso < I.item[i].peso)
+        continue;
+      if (melhor < 0 || I.item[l].valor < I.item[melhor].valor)
+        melhor = l;
+    }
+    if (melhor < 0)
+      continue;
+    j = H->index[melhor] - 1;
+    H->res[j] += I.item[melhor].peso - I.item[i].peso;
+    H->index[i] = j + 1;
+    H->index[melhor] = 0;
+    ganho += I.item[i].valor - I.item[melhor].valor;
+    feitas++;
+  }
+  return ganho;
+}
+
+/* heuristica no no corrente (razao GLP_IHEUR) */
+void heuristica_no(glp_tree *tree, Theur_no *H)
+{
+  Tinstance I = H->I;
+  glp_prob *lp;
+  double antes, z, incumbente, xv;
+  int c, v, i, j, t, melhor_j, folga;
+
+  // no: a raiz e depois um a cada freq nos, dentro da fracao do tempo
+  if (H->nos++ % H->freq != 0)
+    return;
+  antes = glp_mono_time();
+  if (H->chamadas > 0 && H->tempo > HN_FRACAO * glp_difftime(antes, H->inicio))
+    return;
+  lp = glp_ios_get_prob(tree);
+  incumbente = (glp_mip_status(lp) == GLP_FEAS || glp_mip_status(lp) == GLP_OPT) ? glp_mip_obj_val(lp) : -1.0;
+  if (glp_get_obj_val(lp) <= incumbente + EPSILON)
+    return;
+  H->chamadas++;
+
+  // arredondamento: as colunas em 1
+  for (j = 0; j < I.k; j++)
+    H->res[j] = (int)glp_get_row_ub(lp, j + 1);
+  for (i = 0; i < I.n; i++)
+  {
+    H->index[i] = 0;
+    H->maior[i] = 0.0;
+  }
+  for (c = 1; c <= H->m; c++)
+  {
+    xv = glp_get_col_prim(lp, c);
+    v = H->col ? H->col[c] : c - 1;
+    i = v % I.n;
+    j = v / I.n;
+    if (xv >= HN_UM && H->index[i] == 0 && H->res[j] >= I.item[i].peso)
+    {
+      H->index[i] = j + 1;
+      H->res[j] -= I.item[i].peso;
+    }
+    else if (xv > H->maior[i])
+      H->maior[i] = xv;
+  }
+
+  // reparo guloso dos itens restantes
+  for (i = 0; i < I.n; i++)
+  {
+    H->chaves[i].chave = H->maior[i] + 1e-9 * (I.item[i].peso > 0 ? I.item[i].valor / I.item[i].peso : I.item[i].valor);
+    H->chaves[i].i = i;
+  }
+  qsort(H->chaves, I.n, sizeof(Tchave), comparador_chave);
+  for (t = 0; t < I.n; t++)
+  {
+    i = H->chaves[t].i;
+    if (H->index[i] != 0 || I.item[i].valor <= 0)
+      continue;
+    melhor_j = -1;
+    xv = -1.0;
+    folga = 0;
+    for (j = 0; j < I.k; j++)
+    {
+      c = H->coluna[j * I.n + i];
+      if (c == 0 || H->res[j] < I.item[i].peso)
+        continue;
+      // maior x_ij; com x_ij = 0, a de menor folga
+      if (glp_get_col_prim(lp, c) > xv + EPSILON || (glp_get_col_prim(lp, c) > xv - EPSILON && H->res[j] < folga))
+      {
+        melhor_j = j;
+        xv = glp_get_col_prim(lp, c);
+        folga = H->res[j];
+      }
+    }
+    if (melhor_j >= 0)
+    {
+      H->index[i] = melhor_j + 1;
+      H->res[melhor_j] -= I.item[i].peso;
+    }
+  }
+
+  // busca local: itens livres em ordem decrescente de valor
+  for (i = 0; i < I.n; i++)
+  {
+    H->chaves[i].chave = I.item[i].valor;
+    H->chaves[i].i = i;
+  }
+  qsort(H->chaves, I.n, sizeof(Tchave), comparador_chave);
+  trocas(H);
+
+  z = 0.0;
+  for (c = 1; c <= H->m; c++)
+    H->x[c] = 0.0;
+  for (i = 0; i < I.n; i++)
+  {
+    if (H->index[i] == 0)
+      continue;
+    z += I.item[i].valor;
+    H->x[H->coluna[(H->index[i] - 1) * I.n + i]] = 1.0;
+  }
+  if (z > incumbente + EPSILON && glp_ios_heur_sol(tree, H->x) == 0)
+  {
+    H->melhorias++;
+    PRINTF("heuristica no no %d: z=%.0lf\n", glp_ios_curr_node(tree), z);
+  }
+  H->tempo += glp_difftime(glp_mono_time(), antes);
+}
+
+/* eof */
@@ -0,0 +1,373 @@
+/* instancia.c
+leitura e gravacao das instancias do problema da mochila multipla
+
+Formato texto (.mochila):
+   n k
+   C1 C2 ... Ck
+   item peso valor   (uma linha para cada um dos n itens)
+
+Formato binario (.mkpb), na ordem de bytes da maquina:
+   cabecalho Tmkpb (16 bytes): "MKPB", versao, n, k
+   double valor[n]   (valor do item i+1)
+   int    C[k]       (capacidade das mochilas)
+   int    peso[n]    (peso do item i+1)
+Os vetores sao guardados separadamente (SoA) e os valores vem primeiro para
+que fiquem alinhados em 8 bytes. O arquivo binario eh mapeado em memoria com
+mmap (MAP_PRIVATE) e a instancia usa diretamente os vetores do arquivo: as
+capacidades nao sao copiadas (as heuristicas podem altera-las, pois as paginas
+alteradas sao copiadas pelo sistema somente quando escritas).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "mochila_multipla.h"
+
+/* pula espacos em branco */
+static const char *pula_brancos(const char *p, const char *fim)
+{
+  while (p < fim && (*p == ' ' || *p == '\n' || *p == '\t' || *p == '\r'))
+    p++;
+  return p;
+}
+
+/* le um inteiro do texto (substitui o fscanf("%d")); devolve a posicao
+   seguinte ao numero ou NULL se nao houver um inteiro na posicao p */
+static const char *le_inteiro(const char *p, const char *fim, int *v)
+{
+  int neg = 0;
+  long long x = 0;
+  const char *ini;
+
+  p = pula_brancos(p, fim);
+  if (p < fim && (*p == '-' || *p == '+'))
+  {
+    neg = (*p == '-');
+    p++;
+  }
+  ini = p;
+  while (p < fim && *p >= '0' && *p <= '9')
+  {
+    x = 10 * x + (*p - '0');
+    if (x > 2147483647LL)
+      return NULL;
+    p++;
+  }
+  if (p == ini)
+    return NULL;
+  *v = (int)(neg ? -x : x);
+  return p;
+}
+
+/* le um real do texto (substitui o fscanf("%lf")): sinal, parte inteira,
+   parte fracionaria e expoente opcionais */
+static const char *le_real(const char *p, const char *fim, double *v)
+{
+  int neg = 0, eneg = 0, e = 0, digitos = 0;
+  double x = 0.0, escala = 1.0, pot = 10.0;
+  const char *ini;
+
+  p = pula_brancos(p, fim);
+  if (p < fim && (*p == '-' || *p == '+'))
+  {
+    neg = (*p == '-');
+    p++;
+  }
+  while (p < fim && *p >= '0' && *p <= '9')
+  {
+    x = 10.0 * x + (*p - '0');
+    p++;
+    digitos++;
+  }
+  if (p < fim && *p == '.')
+  {
+    p++;
+    while (p < fim && *p >= '0' && *p <= '9')
+    {
+      escala /= 10.0;
+      x += (*p - '0') * escala;
+      p++;
+      digitos++;
+    }
+  }
+  if (digitos == 0)
+    return NULL;
+  if (p < fim && (*p == 'e' || *p == 'E'))
+  {
+    ini = p++;
+    if (p < fim && (*p == '-' || *p == '+'))
+    {
+      eneg = (*p == '-');
+      p++;
+    }
+    if (p < fim && *p >= '0' && *p <= '9')
+    {
+      while (p < fim && *p >= '0' && *p <= '9')
+      {
+        if (e < 1000)
+          e = 10 * e + (*p - '0');
+        p++;
+      }
+      // x * 10^e por quadrados sucessivos
+      for (escala = 1.0; e > 0; e >>= 1, pot *= pot)
+        if (e & 1)
+          escala *= pot;
+      x = eneg ? x / escala : x * escala;
+    }
+    else
+      p = ini; // 'e' nao faz parte do numero
+  }
+  *v = neg ? -x : x;
+  return p;
+}
+
+/* carrega a instancia a partir do texto de um arquivo .mochila em memoria */
+int carga_instancia_texto(const char *buf, size_t tam, Tinstance *I)
+{
+  const char *p = buf, *fim = buf + tam;
+  int i, item, peso;
+  double valor;
+
+  I->mapa = NULL;
+  I->tam_mapa = 0;
+  I->C = NULL;
+  I->item = NULL;
+
+  if (!(p = le_inteiro(p, fim, &(I->n))) || !(p = le_inteiro(p, fim, &(I->k))) || I->n < 1 || I->k < 1)
+    return 0;
+
+  // aloca memória
+  (*I).C = (int *)malloc(sizeof(int) * ((*I).k));
+  (*I).item = (Titem *)malloc(sizeof(Titem) * ((*I).n));
+
+  for (i = 0; i < (*I).k; i++)
+  {
+    if (!(p = le_inteiro(p, fim, &((*I).C[i]))))
+      goto erro;
+  }
+
+  for (i = 0; i < (*I).n; i++)
+  {
+    if (!(p = le_inteiro(p, fim, &item)) || !(p = le_inteiro(p, fim, &peso)) || !(p = le_real(p, fim, &valor)))
+      goto erro;
+    if (item < 1 || item > (*I).n)
+      goto erro;
+    (*I).item[i].num = item;
+    (*I).item[i].peso = peso;
+    (*I).item[i].valor = valor;
+  }
+  return 1;
+
+erro:
+  free_instancia(*I);
+  I->C = NULL;
+  I->item = NULL;
+  return 0;
+}
+
+/* carrega a instancia a partir de um arquivo .mkpb em memoria; as
+   capacidades apontam para dentro de dados, que deve continuar valido
+   enquanto a instancia for usada */
+int carga_instancia_mkpb(void *dados, size_t tam, Tinstance *I)
+{
+  Tmkpb *cab = (Tmkpb *)dados;
+  double *valor;
+  int *peso, i;
+
+  I->mapa = NULL;
+  I->tam_mapa = 0;
+  I->C = NULL;
+  I->item = NULL;
+
+  if (tam < sizeof(Tmkpb) || memcmp(cab->magico, MKPB_MAGICO, 4) != 0 || cab->versao != MKPB_VERSAO)
+    return 0;
+  if (cab->n < 1 || cab->k < 1 || tam < MKPB_TAMANHO(cab->n, cab->k))
+    return 0;
+
+  I->n = cab->n;
+  I->k = cab->k;
+  valor = (double *)((char *)dados + sizeof(Tmkpb));
+  I->C = (int *)(valor + I->n);
+  peso = I->C + I->k;
+
+  // os itens ainda sao guardados como vetor de Titem
+  I->item = (Titem *)malloc(sizeof(Titem) * I->n);
+  for (i = 0; i < I->n; i++)
+  {
+    I->item[i].num = i + 1;
+    I->item[i].peso = peso[i];
+    I->item[i].valor = valor[i];
+  }
+  return 1;
+}
+
+/* carrega os dados da instancia de entrada: arquivos terminados em .mkpb
+   sao mapeados em memoria, os demais sao lidos como texto */
+int carga_instancia(char *filename, Tinstance *I)
+{
+  struct stat st;
+  char *buf;
+  void *mapa;
+  size_t len;
+  int fd, ok, i;
+
+  fd = open(filename, O_RDONLY);
+  if (fd < 0 || fstat(fd, &st) != 0)
+  {
+    printf("\nProblema na abertura do arquivo %s\n", filename);
+    if (fd >= 0)
+      close(fd);
+    return 0;
+  }
+
+  len = strlen(filename);
+  if (len > 5 && strcmp(filename + len - 5, ".mkpb") == 0)
+  {
+    mapa = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapa == MAP_FAILED)
+    {
+      printf("\nProblema no mapeamento do arquivo %s\n", filename);
+      return 0;
+    }
+    ok = carga_instancia_mkpb(mapa, st.st_size, I);
+    if (!ok)
+    {
+      munmap(mapa, st.st_size);
+      return 0;
+    }
+    I->mapa = mapa;
+    I->tam_mapa = st.st_size;
+  }
+  else
+  {
+    // le o arquivo inteiro de uma vez e analisa o texto em memoria
+    buf = (char *)malloc(st.st_size + 1);
+    ok = (read(fd, buf, st.st_size) == st.st_size);
+    close(fd);
+    if (ok)
+      ok = carga_instancia_texto(buf, st.st_size, I);
+    free(buf);
+    if (!ok)
+      return 0;
+  }
+
+#ifdef DEBUG
+  printf("n=%d k=%d\n", (*I).n, (*I).k);
+  for (i = 0; i < (*I).k; i++)
+  {
+    printf("C[%d]=%d\n", i + 1, (*I).C[i]);
+  }
+  for (i = 0; i < (*I).n; i++)
+  {
+    printf("p[%d]=%d e v[%d]=%lf\n", (*I).item[i].num, (*I).item[i].peso, (*I).item[i].num, (*I).item[i].valor);
+  }
+#else
+  (void)i;
+#endif
+  return 1;
+}
+
+/* grava a instancia no formato binario .mkpb (os itens sao gravados na ordem
+   dos seus numeros, que devem ser distintos) */
+int grava_instancia_mkpb(char *filename, Tinstance I)
+{
+  FILE *fout;
+  Tmkpb cab;
+  double *valor;
+  int *peso, i, ok;
+
+  valor = (double *)malloc(sizeof(double) * I.n);
+  peso = (int *)malloc(sizeof(int) * I.n);
+  for (i = 0; i < I.n; i++)
+    peso[i] = -1;
+  for (i = 0; i < I.n; i++)
+  {
+    if (peso[I.item[i].num - 1] != -1)
+    {
+      printf("\nItem %d repetido na instancia\n", I.item[i].num);
+      free(valor);
+      free(peso);
+      return 0;
+    }
+    valor[I.item[i].num - 1] = I.item[i].valor;
+    peso[I.item[i].num - 1] = I.item[i].peso;
+  }
+
+  memset(&cab, 0, sizeof(cab));
+  memcpy(cab.magico, MKPB_MAGICO, 4);
+  cab.versao = MKPB_VERSAO;
+  cab.n = I.n;
+  cab.k = I.k;
+
+  fout = fopen(filename, "wb");
+  if (!fout)
+  {
+    printf("\nProblema na abertura do arquivo %s\n", filename);
+    free(valor);
+    free(peso);
+    return 0;
+  }
+  ok = fwrite(&cab, sizeof(cab), 1, fout) == 1 &&
+       fwrite(valor, sizeof(double), I.n, fout) == (size_t)I.n &&
+       fwrite(I.C, sizeof(int), I.k, fout) == (size_t)I.k &&
+       fwrite(peso, sizeof(int), I.n, fout) == (size_t)I.n;
+  ok = (fclose(fout) == 0) && ok;
+
+  free(valor);
+  free(peso);
+  return ok;
+}
+
+/* grava a instancia no formato texto .mochila (uma capacidade por linha) */
+int grava_instancia_texto(char *filename, Tinstance I)
+{
+  FILE *fout;
+  int i, ok = 1;
+
+  fout = fopen(filename, "w");
+  if (!fout)
+  {
+    printf("\nProblema na abertura do arquivo %s\n", filename);
+    return 0;
+  }
+  fprintf(fout, "%d %d\n", I.n, I.k);
+  for (i = 0; i < I.k; i++)
+    fprintf(fout, "%d\n", I.C[i]);
+  for (i = 0; i < I.n && ok; i++)
+    ok = fprintf(fout, "%d %d %.15g\n", I.item[i].num, I.item[i].peso, I.item[i].valor) > 0;
+  ok = (fclose(fout) == 0) && ok;
+  return ok;
+}
+
+/* converte uma instancia (texto ou binaria) para o formato binario */
+int converte_instancia(char *entrada, char *saida)
+{
+  Tinstance I;
+  int ok;
+
+  if (!carga_instancia(entrada, &I))
+  {
+    printf("\nProblema na carga da instância: %s\n", entrada);
+    return 0;
+  }
+  ok = grava_instancia_mkpb(saida, I);
+  free_instancia(I);
+  return ok;
+}
+
+/* libera memoria alocada pelo programa para guardar a instancia */
+void free_instancia(Tinstance I)
+{
+  free(I.item);
+  if (I.mapa != NULL)
+    munmap(I.mapa, I.tam_mapa);
+  else
+    free(I.C);
+}
+
+/* eof */
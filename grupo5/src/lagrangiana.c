@@ -0,0 +1,479 @@
+/* lagrangiana.c
+relaxacao lagrangiana do modelo F1 (tipo 8)
+
+As restricoes de unicidade (x_i1 + ... + x_ik <= 1) sao relaxadas com
+multiplicadores lambda_i >= 0 e o problema se decompoe em k mochilas 0-1
+independentes, uma para cada mochila j, com os valores v_i - lambda_i:
+
+   L(lambda) = sum_i lambda_i
+             + sum_j max { sum_i (v_i - lambda_i) x_ij : sum_i p_i x_ij <= C_j }
+
+L(lambda) eh um limitante superior para qualquer lambda >= 0 e, como as
+mochilas 0-1 nao tem a propriedade de integralidade, o menor L(lambda) eh pelo
+menos tao bom quanto a relaxacao linear (que aqui eh a surrogate de Dantzig, ver
+limite_linear). Os multiplicadores partem da razao critica da surrogate, como
+sugerido por Martello e Toth, e sao ajustados pelo metodo do subgradiente.
+
+Cada mochila eh resolvida por MT1 (glp_knapsack) com os valores escalados e
+arredondados para cima, o que mantem o limitante valido; se o MT1 atingir o
+limite de retrocessos, a mochila contribui com o seu limitante de Dantzig.
+Mochilas com a mesma capacidade sao o mesmo subproblema e sao resolvidas uma
+unica vez. Os subproblemas de cada iteracao sao divididos entre threads que
+ficam paradas em uma barreira entre as iteracoes.
+
+A cada iteracao a heuristica lagrangiana monta uma solucao viavel: cada item
+fica na primeira mochila cuja solucao o escolheu e os itens que sobraram sao
+colocados pela razao valor/peso (first-fit).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <glpk.h>
+#include "mochila_multipla.h"
+
+#define LAGR_ITER_MAX 500     /* iteracoes do subgradiente */
+#define LAGR_SEM_MELHORA 20   /* iteracoes sem melhora antes de reduzir o passo */
+#define LAGR_PASSO_MIN 0.0001 /* menor fator do passo */
+#define LAGR_ESCALA_MAX 1000  /* maior escala dos valores das mochilas */
+#define LAGR_MT1_LIMITE 20000 /* retrocessos de cada chamada do MT1 */
+
+// estado compartilhado pelas threads
+typedef struct
+{
+  Tinstance I;
+  int n;           /* itens considerados (que cabem em alguma mochila) */
+  int *ord;        /* itens considerados em ordem decrescente de valor/peso */
+  int nq;          /* total de subproblemas (capacidades distintas) */
+  int *cap;        /* capacidade de cada subproblema */
+  int *mult;       /* mochilas de cada subproblema */
+  int *classe;     /* subproblema de cada mochila */
+  char **xq;       /* solucao de cada subproblema (por item) */
+  double *zq;      /* limitante de cada subproblema */
+  double *reduzido; /* valor lagrangiano v_i - lambda_i de cada item */
+  double escala;   /* escala dos valores passados ao MT1 */
+  int proximo;     /* proximo subproblema a resolver */
+  int termina;     /* 1 quando as threads devem terminar */
+  pthread_mutex_t trava;
+  pthread_barrier_t inicio, fim;
+} Tlagrange;
+
+// area de trabalho de cada thread (vetores de 1 a n, como no glp_knapsack)
+typedef struct
+{
+  Tlagrange *L;
+  int *a, *c, *pos;
+  char *x;
+  Tchave *chaves;
+} Tlag_trab;
+
+/* limitante de Dantzig da mochila (a, c) de capacidade b, com m itens */
+static double dantzig(Tlag_trab *W, int m, int b)
+{
+  double ub = 0.0;
+  int t, i;
+
+  for (t = 0; t < m; t++)
+  {
+    W->chaves[t].chave = (double)W->c[t + 1] / W->a[t + 1];
+    W->chaves[t].i = t + 1;
+  }
+  qsort(W->chaves, m, sizeof(Tchave), comparador_chave);
+  for (t = 0; t < m && b > 0; t++)
+  {
+    i = W->chaves[t].i;
+    if (W->a[i] <= b)
+    {
+      b -= W->a[i];
+      ub += W->c[i];
+    }
+    else
+    {
+      ub += (double)W->c[i] * b / W->a[i];
+      break;
+    }
+  }
+  return ub;
+}
+
+/* resolve o subproblema q com os valores lagrangianos atuais */
+static void resolve_subproblema(Tlag_trab *W, int q)
+{
+  Tlagrange *L = W->L;
+  int t, i, m = 0, z, lim = LAGR_MT1_LIMITE;
+
+  memset(L->xq[q], 0, L->I.n);
+  for (t = 0; t < L->n; t++)
+  {
+    i = L->ord[t];
+    if (L->reduzido[i] > 0.0 && L->I.item[i].peso <= L->cap[q])
+    {
+      m++;
+      W->pos[m] = i;
+      W->a[m] = L->I.item[i].peso;
+      W->c[m] = (int)ceil(L->escala * L->reduzido[i]);
+      if (W->c[m] < 1)
+        W->c[m] = 1;
+    }
+  }
+  if (m == 0)
+  {
+    L->zq[q] = 0.0;
+    return;
+  }
+
+  z = glp_knapsack(m, W->a, L->cap[q], W->c, W->x, GLP_KS_MT1, &lim);
+  for (t = 1; t <= m; t++)
+    if (W->x[t])
+      L->xq[q][W->pos[t]] = 1;
+  // sem a prova de otimalidade, so o limitante de Dantzig eh valido
+  L->zq[q] = ((lim == -1) ? dantzig(W, m, L->cap[q]) : z) / L->escala;
+}
+
+/* resolve os subproblemas ainda nao atribuidos a nenhuma thread */
+static void resolve_subproblemas(Tlag_trab *W)
+{
+  Tlagrange *L = W->L;
+  int q;
+
+  for (;;)
+  {
+    pthread_mutex_lock(&L->trava);
+    q = L->proximo++;
+    pthread_mutex_unlock(&L->trava);
+    if (q >= L->nq)
+      break;
+    resolve_subproblema(W, q);
+  }
+}
+
+/* laco das threads auxiliares: espera o inicio de cada iteracao */
+static void *trabalhador_lagrange(void *arg)
+{
+  Tlag_trab *W = (Tlag_trab *)arg;
+
+  for (;;)
+  {
+    pthread_barrier_wait(&W->L->inicio);
+    if (W->L->termina)
+      break;
+    resolve_subproblemas(W);
+    pthread_barrier_wait(&W->L->fim);
+  }
+  // libera o ambiente do GLPK desta thread
+  glp_free_env();
+  return NULL;
+}
+
+/* area de trabalho de uma thread, tirada da arena pela thread principal
+   antes de criar as auxiliares (que nao alocam nada) */
+static void aloca_trabalho(Tlag_trab *W, Tlagrange *L, Tarena *A)
+{
+  W->L = L;
+  W->a = (int *)arena_aloca(A, sizeof(int) * (L->I.n + 1));
+  W->c = (int *)arena_aloca(A, sizeof(int) * (L->I.n + 1));
+  W->pos = (int *)arena_aloca(A, sizeof(int) * (L->I.n + 1));
+  W->x = (char *)arena_aloca(A, sizeof(char) * (L->I.n + 1));
+  W->chaves = (Tchave *)arena_aloca(A, sizeof(Tchave) * (L->I.n > 0 ? L->I.n : 1));
+}
+
+/* limitante da relaxacao linear: surrogate de Dantzig dos itens considerados;
+   devolve tambem a razao valor/peso do item critico */
+static double limite_linear(Tlagrange *L, double *razao)
+{
+  long long cap = 0;
+  double ub = 0.0;
+  int t, j, i;
+
+  for (j = 0; j < L->I.k; j++)
+    cap += L->I.C[j];
+  *razao = 0.0;
+  for (t = 0; t < L->n; t++)
+  {
+    i = L->ord[t];
+    if (L->I.item[i].peso <= cap)
+    {
+      cap -= L->I.item[i].peso;
+      ub += L->I.item[i].valor;
+    }
+    else
+    {
+      *razao = L->I.item[i].valor / L->I.item[i].peso;
+      ub += *razao * cap;
+      break;
+    }
+  }
+  return ub;
+}
+
+/* heuristica lagrangiana: solucao viavel a partir das solucoes das mochilas;
+   sol[i] recebe a mochila do item i (0 = fora) */
+static double heuristica_lagrange(Tlagrange *L, int *sol, int *res)
+{
+  double z = 0.0;
+  int j, t, i, q;
+
+  memset(sol, 0, sizeof(int) * L->I.n);
+  for (j = 0; j < L->I.k; j++)
+  {
+    res[j] = L->I.C[j];
+    q = L->classe[j];
+    for (t = 0; t < L->n; t++)
+    {
+      i = L->ord[t];
+      if (L->xq[q][i] && sol[i] == 0 && L->I.item[i].peso <= res[j])
+      {
+        sol[i] = j + 1;
+        res[j] -= L->I.item[i].peso;
+        z += L->I.item[i].valor;
+      }
+    }
+  }
+  // completa com os itens livres
+  for (t = 0; t < L->n; t++)
+  {
+    i = L->ord[t];
+    if (sol[i] != 0)
+      continue;
+    for (j = 0; j < L->I.k; j++)
+    {
+      if (L->I.item[i].peso <= res[j])
+      {
+        sol[i] = j + 1;
+        res[j] -= L->I.item[i].peso;
+        z += L->I.item[i].valor;
+        break;
+      }
+    }
+  }
+  return z;
+}
+
+/* relaxacao lagrangiana com otimizacao por subgradiente: devolve o valor da
+   melhor solucao da heuristica lagrangiana (que fica em I.item[].index) e
+   guarda o limitante superior em info->best_dualBound; nthreads <= 0 usa
+   todos os nucleos e limite eh o tempo maximo em ms */
+double lagrangiana(Tinstance I, int nthreads, double limite, my_infoT *info)
+{
+  Tlagrange L;
+  Tlag_trab *W;
+  Tchave *chaves;
+  pthread_t *threads = NULL;
+  double *lambda, *g, inicio, razao, ub, ub_lp, lb, z, valor, norma, passo, mu, maxv, soma;
+  int *sol, *melhor, *res, i, j, q, t, it, sem_melhora, maxC, inteiro;
+  Tarena *A = info->arena;
+  Tmarca m = arena_marca(A);
+
+  inicio = glp_mono_time();
+  L.I = I;
+
+  // itens que cabem em alguma mochila, em ordem de valor/peso
+  L.ord = (int *)arena_aloca(A, sizeof(int) * I.n);
+  chaves = (Tchave *)arena_aloca(A, sizeof(Tchave) * (I.n > I.k ? I.n : I.k));
+  maxC = 0;
+  for (j = 0; j < I.k; j++)
+    if (I.C[j] > maxC)
+      maxC = I.C[j];
+  L.n = 0;
+  inteiro = 1;
+  maxv = 1.0;
+  soma = 1.0;
+  for (i = 0; i < I.n; i++)
+  {
+    if (I.item[i].valor != floor(I.item[i].valor))
+      inteiro = 0;
+    if (I.item[i].peso <= maxC && I.item[i].valor > 0)
+    {
+      chaves[L.n].chave = I.item[i].valor / I.item[i].peso;
+      chaves[L.n].i = i;
+      L.n++;
+      soma += I.item[i].valor;
+      if (I.item[i].valor > maxv)
+        maxv = I.item[i].valor;
+    }
+  }
+  qsort(chaves, L.n, sizeof(Tchave), comparador_chave);
+  for (t = 0; t < L.n; t++)
+    L.ord[t] = chaves[t].i;
+
+  // subproblemas: um para cada capacidade distinta
+  for (j = 0; j < I.k; j++)
+  {
+    chaves[j].chave = I.C[j];
+    chaves[j].i = j;
+  }
+  qsort(chaves, I.k, sizeof(Tchave), comparador_chave);
+  L.cap = (int *)arena_aloca(A, sizeof(int) * I.k);
+  L.mult = (int *)arena_aloca(A, sizeof(int) * I.k);
+  L.classe = (int *)arena_aloca(A, sizeof(int) * I.k);
+  L.nq = 0;
+  for (t = 0; t < I.k; t++)
+  {
+    j = chaves[t].i;
+    if (L.nq == 0 || L.cap[L.nq - 1] != I.C[j])
+    {
+      L.cap[L.nq] = I.C[j];
+      L.mult[L.nq] = 0;
+      L.nq++;
+    }
+    L.mult[L.nq - 1]++;
+    L.classe[j] = L.nq - 1;
+  }
+  L.xq = (char **)arena_aloca(A, sizeof(char *) * L.nq);
+  for (q = 0; q < L.nq; q++)
+    L.xq[q] = (char *)arena_aloca(A, sizeof(char) * I.n);
+  L.zq = (double *)arena_aloca(A, sizeof(double) * L.nq);
+
+  // escala dos valores: o MT1 trabalha com inteiros e calcula produtos
+  // capacidade x valor, que devem caber em um int
+  L.escala = LAGR_ESCALA_MAX;
+  if (L.escala * maxv * maxC > INT_MAX / 4)
+    L.escala = (INT_MAX / 4) / (maxv * maxC);
+  if (L.escala * soma > INT_MAX / 4)
+    L.escala = (INT_MAX / 4) / soma;
+
+  L.reduzido = (double *)arena_aloca(A, sizeof(double) * I.n);
+  lambda = (double *)arena_aloca_zerada(A, sizeof(double) * I.n);
+  g = (double *)arena_aloca(A, sizeof(double) * I.n);
+  sol = (int *)arena_aloca(A, sizeof(int) * I.n);
+  melhor = (int *)arena_aloca_zerada(A, sizeof(int) * I.n);
+  res = (int *)arena_aloca(A, sizeof(int) * I.k);
+
+  // threads: a thread principal tambem resolve subproblemas
+  if (nthreads <= 0)
+    nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (nthreads > L.nq)
+    nthreads = L.nq;
+  if (nthreads < 1)
+    nthreads = 1;
+  W = (Tlag_trab *)arena_aloca(A, sizeof(Tlag_trab) * nthreads);
+  for (t = 0; t < nthreads; t++)
+    aloca_trabalho(&W[t], &L, A);
+  L.termina = 0;
+  pthread_mutex_init(&L.trava, NULL);
+  if (nthreads > 1)
+  {
+    pthread_barrier_init(&L.inicio, NULL, nthreads);
+    pthread_barrier_init(&L.fim, NULL, nthreads);
+    threads = (pthread_t *)arena_aloca(A, sizeof(pthread_t) * (nthreads - 1));
+    for (t = 1; t < nthreads; t++)
+      pthread_create(&threads[t - 1], NULL, trabalhador_lagrange, &W[t]);
+  }
+
+  // multiplicadores iniciais pela razao critica da surrogate
+  ub_lp = limite_linear(&L, &razao);
+  for (t = 0; t < L.n; t++)
+  {
+    i = L.ord[t];
+    valor = I.item[i].valor - razao * I.item[i].peso;
+    lambda[i] = (valor > 0.0) ? valor : 0.0;
+  }
+
+  ub = ub_lp;
+  lb = 0.0;
+  mu = 2.0;
+  sem_melhora = 0;
+  for (it = 0; it < LAGR_ITER_MAX; it++)
+  {
+    // subproblemas
+    for (t = 0; t < L.n; t++)
+      L.reduzido[L.ord[t]] = I.item[L.ord[t]].valor - lambda[L.ord[t]];
+    L.proximo = 0;
+    if (nthreads > 1)
+      pthread_barrier_wait(&L.inicio);
+    resolve_subproblemas(&W[0]);
+    if (nthreads > 1)
+      pthread_barrier_wait(&L.fim);
+
+    z = 0.0;
+    for (t = 0; t < L.n; t++)
+      z += lambda[L.ord[t]];
+    for (q = 0; q < L.nq; q++)
+      z += L.mult[q] * L.zq[q];
+    if (z < ub - EPSILON)
+    {
+      ub = z;
+      sem_melhora = 0;
+    }
+    else if (++sem_melhora >= LAGR_SEM_MELHORA)
+    {
+      mu /= 2.0;
+      sem_melhora = 0;
+    }
+
+    // heuristica lagrangiana
+    valor = heuristica_lagrange(&L, sol, res);
+    if (valor > lb + EPSILON)
+    {
+      lb = valor;
+      memcpy(melhor, sol, sizeof(int) * I.n);
+      PRINTF("lagrangiana: it=%d nova solucao %.0lf\n", it, lb);
+    }
+    PRINTF("lagrangiana: it=%d L=%.2lf ub=%.2lf lb=%.0lf mu=%.4lf\n", it, z, ub, lb, mu);
+
+    if ((inteiro ? floor(ub + EPSILON) : ub) <= lb + EPSILON || mu < LAGR_PASSO_MIN)
+      break;
+    if (glp_difftime(glp_mono_time(), inicio) * 1000 >= limite)
+      break;
+
+    // subgradiente (projetado: multiplicadores nulos nao ficam negativos)
+    norma = 0.0;
+    for (t = 0; t < L.n; t++)
+    {
+      i = L.ord[t];
+      g[i] = 1.0;
+      for (j = 0; j < I.k; j++)
+        g[i] -= L.xq[L.classe[j]][i];
+      if (lambda[i] <= 0.0 && g[i] > 0.0)
+        g[i] = 0.0;
+      norma += g[i] * g[i];
+    }
+    if (norma == 0.0)
+      break; // as mochilas formam uma solucao viavel e complementar
+    passo = mu * (z - lb) / norma;
+    for (t = 0; t < L.n; t++)
+    {
+      i = L.ord[t];
+      lambda[i] -= passo * g[i];
+      if (lambda[i] < 0.0)
+        lambda[i] = 0.0;
+    }
+  }
+
+  if (inteiro)
+    ub = floor(ub + EPSILON);
+  if (ub < lb)
+    ub = lb;
+
+  for (i = 0; i < I.n; i++)
+    I.item[i].index = melhor[i];
+
+  info->nodes = (it < LAGR_ITER_MAX) ? it + 1 : it; // iteracoes
+  info->ativos = 0;
+  info->best_primalBound = lb;
+  info->best_dualBound = ub;
+  info->gap = (ub - lb) / (lb + 2.2204460492503131e-16); // como em glp_ios_mip_gap
+
+  PRINTF("lagrangiana: z=%.0lf ub=%.2lf (linear=%.2lf) iteracoes=%d escala=%lf\n", lb, ub, ub_lp, info->nodes, L.escala);
+
+  // termina as threads
+  if (nthreads > 1)
+  {
+    L.termina = 1;
+    pthread_barrier_wait(&L.inicio);
+    for (t = 1; t < nthreads; t++)
+      pthread_join(threads[t - 1], NULL);
+    pthread_barrier_destroy(&L.inicio);
+    pthread_barrier_destroy(&L.fim);
+  }
+  pthread_mutex_destroy(&L.trava);
+
+  arena_volta(A, m);
+  return lb;
+}
+
+/* eof */
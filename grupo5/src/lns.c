@@ -0,0 +1,326 @@
+/* lns.c
+busca em vizinhanca grande (LNS) iterada em torno do destroy/repair (tipo 15)
+
+A heuristica melhorada (tipos 5 e 6) faz um unico destroy/repair com limiares
+fixos. Aqui o destroy/repair eh repetido ate o tempo limite (-l):
+ - a solucao inicial eh a gulosa seguida da busca local (busca_local.c), para
+   ter uma boa solucao ja nos primeiros instantes;
+ - a cada iteracao um operador de destroy libera uma fracao dos itens das
+   mochilas e dos itens fora delas: guiado pela relaxacao linear (itens com
+   menor valor na relaxacao, como no destroy_rins), aleatorio, ou por mochila
+   (itens de algumas mochilas sorteadas, que sao reotimizadas juntas);
+ - o repair eh um sub-MIP no mesmo modelo do GLPK (carga_lp): os itens que
+   ficaram sao fixados nas suas mochilas, o simplex dual parte da base
+   anterior e o B&B recebe a solucao atual como solucao inicial, com tempo
+   limitado (LNS_SUB_MIP do tempo total);
+ - o tamanho da vizinhanca de cada operador se adapta: cresce quando o sub-MIP
+   eh resolvido sem melhora e diminui quando ele esgota o tempo; o operador eh sorteado
+   com pesos que aumentam com as melhorias que ele encontra.
+Cada melhoria eh registrada na trajetoria (tempo, valor). No portfolio (tipo
+30, portfolio.c), a LNS publica as suas melhorias e parte da incumbente
+compartilhada quando ela eh melhor que a solucao atual.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <glpk.h>
+#include "mochila_multipla.h"
+
+#define LNS_OPERADORES 3      /* destroy: relaxacao linear, aleatorio, por mochila */
+#define LNS_FRACAO_INICIAL 0.1 /* fracao inicial dos itens (ou mochilas) liberados */
+#define LNS_FRACAO_MIN 0.02
+#define LNS_FRACAO_MAX 0.5
+#define LNS_SUB_MIP 0.02      /* fracao do tempo limite de cada sub-MIP */
+#define LNS_PESO_MIN 0.1      /* peso minimo de um operador */
+
+/* sorteia um operador com probabilidade proporcional ao peso */
+static int sorteia_operador(double *peso, glp_rng *rng)
+{
+  double soma = 0.0, r;
+  int op;
+
+  for (op = 0; op < LNS_OPERADORES; op++)
+    soma += peso[op];
+  r = glp_rng_unif_01(rng) * soma;
+  for (op = 0; op < LNS_OPERADORES - 1; op++)
+  {
+    r -= peso[op];
+    if (r < 0.0)
+      break;
+  }
+  return op;
+}
+
+/* libera os q itens com as maiores chaves entre os m de chaves[] */
+static void libera(Tchave *chaves, int m, int q, int *livre)
+{
+  int t;
+
+  if (q < 1)
+    q = 1;
+  if (q > m)
+    q = m;
+  qsort(chaves, m, sizeof(Tchave), comparador_chave);
+  for (t = 0; t < q; t++)
+    livre[chaves[t].i] = 1;
+}
+
+/* destroy: marca em livre[] os itens liberados (uma fracao dos itens das
+   mochilas e uma fracao dos itens fora delas, para que o sub-MIP continue
+   pequeno) e, no operador por mochila, as mochilas liberadas */
+static void destroi(Tinstance I, int op, double fracao, int *atual, double *x, glp_rng *rng, int *livre, int *mochila_livre, Tchave *chaves)
+{
+  int i, j, m = 0, usados = 0, q, t, aux;
+  double soma;
+
+  for (i = 0; i < I.n; i++)
+  {
+    livre[i] = 0;
+    usados += (atual[i] != 0);
+  }
+  for (j = 0; j < I.k; j++)
+    mochila_livre[j] = 1;
+
+  if (op == 2)
+  {
+    // por mochila: os itens livres so podem ir para algumas mochilas sorteadas
+    q = (int)(fracao * I.k + 0.5);
+    if (q < 2)
+      q = 2;
+    if (q > I.k)
+      q = I.k;
+    for (j = 0; j < I.k; j++)
+    {
+      chaves[j].i = j;
+      mochila_livre[j] = 0;
+    }
+    for (t = 0; t < q; t++)
+    {
+      j = t + glp_rng_unif(rng, I.k - t);
+      aux = chaves[t].i;
+      chaves[t].i = chaves[j].i;
+      chaves[j].i = aux;
+      mochila_livre[chaves[t].i] = 1;
+    }
+  }
+
+  // itens nas mochilas (no operador por mochila, so nas mochilas sorteadas)
+  for (i = 0; i < I.n; i++)
+  {
+    if (atual[i] == 0 || !mochila_livre[atual[i] - 1])
+      continue;
+    chaves[m].i = i;
+    if (op == 1)
+      chaves[m].chave = glp_rng_unif_01(rng);
+    else // menor valor na relaxacao primeiro (desempate aleatorio)
+      chaves[m].chave = -(x[(atual[i] - 1) * I.n + i] + 0.1 * glp_rng_unif_01(rng));
+    m++;
+  }
+  if (m > 0)
+    libera(chaves, m, (int)(fracao * usados + 0.5), livre);
+
+  // itens fora das mochilas
+  m = 0;
+  for (i = 0; i < I.n; i++)
+  {
+    if (atual[i] != 0)
+      continue;
+    chaves[m].i = i;
+    if (op == 1)
+      chaves[m].chave = glp_rng_unif_01(rng);
+    else
+    {
+      for (soma = 0.0, j = 0; j < I.k; j++)
+        soma += x[j * I.n + i];
+      chaves[m].chave = soma + 0.1 * glp_rng_unif_01(rng);
+    }
+    m++;
+  }
+  if (m > 0)
+    libera(chaves, m, (int)(fracao * (I.n - usados) + 0.5), livre);
+}
+
+/* LNS iterada; a solucao fica em I.item[].index (itens na ordem do numero) e
+   as melhorias em traj */
+double lns(Tinstance I, Tparametros *par, glp_rng *rng, my_infoT *info, Ttrajetoria *traj)
+{
+  glp_prob *lp;
+  glp_smcp param_lp;
+  glp_iocp param_ilp;
+  double *x, *x0, z, z_lp, z_sub, inicio, decorrido, fracao[LNS_OPERADORES], peso[LNS_OPERADORES], ganho;
+  int *atual, *livre, *mochila_livre, *capacidade, i, j, col, op, ret, iter = 0, melhorias = 0;
+  Tchave *chaves;
+  Tarena *A = info->arena;
+  Tmarca m = arena_marca(A);
+
+  inicio = glp_mono_time();
+  // as colunas do modelo seguem a ordem dos itens (j * n + i + 1)
+  qsort(I.item, I.n, sizeof(Titem), comparador_num);
+
+  glp_term_out(GLP_OFF);
+  FASE_INICIO(info->crono, FASE_MODELO);
+  carga_lp(&lp, I, A);
+  FASE_FIM(info->crono);
+  glp_init_smcp(&param_lp);
+  param_lp.msg_lev = GLP_MSG_OFF;
+  FASE_INICIO(info->crono, FASE_RELAXACAO);
+  glp_simplex(lp, &param_lp);
+  FASE_FIM(info->crono);
+  z_lp = glp_get_obj_val(lp);
+  x = (double *)arena_aloca(A, sizeof(double) * (I.n * I.k));
+  for (col = 1; col <= I.n * I.k; col++)
+    x[col - 1] = glp_get_col_prim(lp, col);
+
+  // solucao inicial: gulosa, com os itens fora da relaxacao trocados pelo
+  // repair (destroy_rins/repair_rins, como na gulosa melhorada), seguida da
+  // busca local; as capacidades originais sao restauradas, pois as
+  // heuristicas deixam as residuais em I.C
+  capacidade = (int *)arena_aloca(A, sizeof(int) * I.k);
+  memcpy(capacidade, I.C, sizeof(int) * I.k);
+  z = guloso(I, A);
+  qsort(I.item, I.n, sizeof(Titem), comparador_num);
+  z = destroy_rins(I, z, 1.0, x);
+  z = repair_rins(I, z, x, A);
+  memcpy(I.C, capacidade, sizeof(int) * I.k);
+  z = busca_local(I, par->limite * LNS_SUB_MIP, info);
+  atual = (int *)arena_aloca(A, sizeof(int) * I.n);
+  for (i = 0; i < I.n; i++)
+    atual[i] = I.item[i].index;
+  registra_melhoria(traj, glp_difftime(glp_mono_time(), inicio), z);
+  PRINTF("lns: solucao inicial %.0lf (relaxacao %.2lf)\n", z, z_lp);
+  if (info->portfolio != NULL)
+    portfolio_publica(info->portfolio, I, z);
+
+  livre = (int *)arena_aloca(A, sizeof(int) * I.n);
+  mochila_livre = (int *)arena_aloca(A, sizeof(int) * I.k);
+  chaves = (Tchave *)arena_aloca(A, sizeof(Tchave) * (I.n > I.k ? I.n : I.k));
+  x0 = (double *)arena_aloca(A, sizeof(double) * (I.n * I.k + 1));
+  for (op = 0; op < LNS_OPERADORES; op++)
+  {
+    fracao[op] = LNS_FRACAO_INICIAL;
+    peso[op] = 1.0;
+  }
+
+  glp_init_iocp(&param_ilp);
+  param_ilp.msg_lev = GLP_MSG_OFF;
+  param_ilp.cb_func = my_callback;
+  param_ilp.cb_info = info;
+  info->mip = lp;
+  param_lp.meth = GLP_DUALP;
+
+  while ((decorrido = glp_difftime(glp_mono_time(), inicio) * 1000) < par->limite && z < z_lp - EPSILON)
+  {
+    // portfolio (tipo 30): para quando outro metodo terminou e parte da
+    // incumbente compartilhada, se ela for melhor
+    if (info->portfolio != NULL)
+    {
+      if (portfolio_parou(info->portfolio))
+        break;
+      z = portfolio_atualiza(info->portfolio, z, atual);
+    }
+    iter++;
+    op = sorteia_operador(peso, rng);
+    destroi(I, op, fracao[op], atual, x, rng, livre, mochila_livre, chaves);
+
+    // sub-MIP: fixa os itens que ficaram; a solucao atual eh viavel
+    x0[0] = 0.0;
+    for (i = 0; i < I.n; i++)
+    {
+      for (j = 0; j < I.k; j++)
+      {
+        col = j * I.n + i + 1;
+        x0[col] = (atual[i] == j + 1) ? 1.0 : 0.0;
+        if (!livre[i])
+          glp_set_col_bnds(lp, col, GLP_FX, x0[col], x0[col]);
+        else if (!mochila_livre[j])
+          glp_set_col_bnds(lp, col, GLP_FX, 0.0, 0.0);
+        else
+          glp_set_col_bnds(lp, col, GLP_DB, 0.0, 1.0);
+      }
+    }
+    FASE_INICIO(info->crono, FASE_RELAXACAO);
+    glp_simplex(lp, &param_lp);
+    FASE_FIM(info->crono);
+    if (glp_get_status(lp) != GLP_OPT)
+      continue;
+
+    param_ilp.tm_lim = (int)(par->limite * LNS_SUB_MIP);
+    if (param_ilp.tm_lim > par->limite - decorrido)
+      param_ilp.tm_lim = (int)(par->limite - decorrido);
+    if (param_ilp.tm_lim < 1)
+      param_ilp.tm_lim = 1;
+    info->x_inicial = x0;
+    FASE_INICIO(info->crono, FASE_BB);
+    ret = glp_intopt(lp, &param_ilp);
+    FASE_FIM(info->crono);
+    info->x_inicial = NULL;
+
+    ganho = 0.0;
+    if (glp_mip_status(lp) == GLP_OPT || glp_mip_status(lp) == GLP_FEAS)
+    {
+      z_sub = glp_mip_obj_val(lp);
+      if (z_sub > z - EPSILON)
+      {
+        // aceita tambem solucoes de mesmo valor (diversificacao)
+        ganho = (z_sub > z + EPSILON) ? 3.0 : 0.5;
+        for (i = 0; i < I.n; i++)
+        {
+          atual[i] = 0;
+          for (j = 0; j < I.k; j++)
+            if (glp_mip_col_val(lp, j * I.n + i + 1) > 0.5)
+            {
+              atual[i] = j + 1;
+              break;
+            }
+        }
+        if (z_sub > z + EPSILON)
+        {
+          melhorias++;
+          registra_melhoria(traj, glp_difftime(glp_mono_time(), inicio), z_sub);
+          PRINTF("lns: iteracao %d operador %d fracao %.3lf nova solucao %.0lf\n", iter, op, fracao[op], z_sub);
+          if (info->portfolio != NULL)
+          {
+            for (i = 0; i < I.n; i++)
+              I.item[i].index = atual[i];
+            portfolio_publica(info->portfolio, I, z_sub);
+          }
+        }
+        z = z_sub;
+      }
+    }
+
+    // tamanho da vizinhanca: cresce se o sub-MIP foi resolvido sem melhora e
+    // diminui se ele esgotou o tempo
+    if (ret == GLP_ETMLIM)
+      fracao[op] *= 0.7;
+    else if (ganho < 1.0)
+      fracao[op] *= 1.1;
+    if (fracao[op] < LNS_FRACAO_MIN)
+      fracao[op] = LNS_FRACAO_MIN;
+    if (fracao[op] > LNS_FRACAO_MAX)
+      fracao[op] = LNS_FRACAO_MAX;
+    peso[op] = 0.8 * peso[op] + 0.2 * ganho;
+    if (peso[op] < LNS_PESO_MIN)
+      peso[op] = LNS_PESO_MIN;
+  }
+
+  for (i = 0; i < I.n; i++)
+    I.item[i].index = atual[i];
+  PRINTF("lns: z=%.0lf iteracoes=%d melhorias=%d fracoes=%.3lf/%.3lf/%.3lf pesos=%.2lf/%.2lf/%.2lf\n", z, iter, melhorias, fracao[0], fracao[1], fracao[2], peso[0], peso[1], peso[2]);
+
+  // a relaxacao linear eh o limitante dual
+  info->nodes = iter;
+  info->ativos = 0;
+  info->best_primalBound = z;
+  info->best_dualBound = z_lp;
+  info->gap = (z_lp - z) / (z + DBL_EPSILON);
+
+  // libera memoria
+  glp_delete_prob(lp);
+  arena_volta(A, m);
+  return z;
+}
+
+/* eof */
@@ -0,0 +1,314 @@
+/* lote.c
+modo em lote: resolve todas as instancias de um diretorio (ou listadas em um
+manifesto) para uma lista de tipos, distribuindo os pares (instancia, tipo)
+entre um conjunto de threads. Cada thread usa o seu proprio ambiente do GLPK
+(o GLPK deve ser compilado com suporte a TLS, ver env/tls.c) e o libera ao
+terminar. Os resultados sao gravados em uma unica tabela, na ordem dos pares.
+O modo de experimento (experimento.c) usa as mesmas threads, executando cada
+par varias vezes com sementes diferentes. A memoria de trabalho dos metodos
+sai de uma arena por thread (ver arena.c), reaproveitada entre os pares.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <glpk.h>
+#include "mochila_multipla.h"
+
+// estado compartilhado entre as threads do lote
+typedef struct
+{
+  char **arquivos;       /* instancias */
+  int narquivos;         /* total de instancias */
+  int tipos[MAX_TIPOS];  /* tipos a executar em cada instancia */
+  int ntipos;            /* total de tipos */
+  int nrep;              /* execucoes de cada par */
+  unsigned semente;      /* semente da primeira execucao (0 = a de par) */
+  int proximo;           /* proxima execucao */
+  int total;             /* total de execucoes */
+  Tresultado *res;       /* resultado de cada par */
+  Tparametros par;       /* parametros dos metodos */
+  pthread_mutex_t trava; /* protege proximo */
+} Tlote;
+
+/* le a lista de tipos no formato "1,2,5" ou "1-6" (ou combinacoes) */
+int le_tipos(char *str, int *tipos)
+{
+  int n = 0, a, b, t;
+  char *p = str, *fim;
+
+  while (*p)
+  {
+    a = strtol(p, &fim, 10);
+    if (fim == p)
+      return 0;
+    b = a;
+    p = fim;
+    if (*p == '-')
+    {
+      p++;
+      b = strtol(p, &fim, 10);
+      if (fim == p)
+        return 0;
+      p = fim;
+    }
+    for (t = a; t <= b; t++)
+    {
+      if (t < 1 || t > TIPO_MAX || n == MAX_TIPOS)
+        return 0;
+      tipos[n++] = t;
+    }
+    if (*p == ',')
+      p++;
+    else if (*p)
+      return 0;
+  }
+  return n;
+}
+
+// Função auxiliar de comparacao para o qsort dos nomes de arquivos
+static int comparador_nome(const void *a, const void *b)
+{
+  return strcmp(*(char **)a, *(char **)b);
+}
+
+/* acrescenta um arquivo na lista, aumentando-a quando necessario */
+static void adiciona_arquivo(char ***arquivos, int *n, int *cap, const char *nome)
+{
+  if (*n == *cap)
+  {
+    *cap = (*cap == 0) ? 64 : 2 * (*cap);
+    *arquivos = (char **)realloc(*arquivos, sizeof(char *) * (*cap));
+  }
+  (*arquivos)[(*n)++] = strdup(nome);
+}
+
+/* monta a lista de instancias: todos os arquivos .mochila (ou .mkpb) de um
+   diretorio ou as linhas de um manifesto (uma instancia por linha, '#' inicia
+   comentario) */
+int lista_instancias(char *entrada, char ***arquivos)
+{
+  struct stat st;
+  struct dirent *d;
+  DIR *dir;
+  FILE *fin;
+  char nome[FILENAME_MAX], *p;
+  int n = 0, cap = 0, len;
+
+  *arquivos = NULL;
+  if (stat(entrada, &st) != 0)
+  {
+    printf("\nProblema na abertura de %s\n", entrada);
+    return 0;
+  }
+
+  if (S_ISDIR(st.st_mode))
+  {
+    dir = opendir(entrada);
+    if (!dir)
+    {
+      printf("\nProblema na abertura do diretorio %s\n", entrada);
+      return 0;
+    }
+    while ((d = readdir(dir)) != NULL)
+    {
+      len = strlen(d->d_name);
+      if ((len > 8 && strcmp(d->d_name + len - 8, ".mochila") == 0) || (len > 5 && strcmp(d->d_name + len - 5, ".mkpb") == 0))
+      {
+        snprintf(nome, sizeof(nome), "%s/%s", entrada, d->d_name);
+        adiciona_arquivo(arquivos, &n, &cap, nome);
+      }
+    }
+    closedir(dir);
+    // ordem deterministica, independente do sistema de arquivos
+    if (n > 0)
+      qsort(*arquivos, n, sizeof(char *), comparador_nome);
+  }
+  else
+  {
+    fin = fopen(entrada, "r");
+    if (!fin)
+    {
+      printf("\nProblema na abertura do arquivo %s\n", entrada);
+      return 0;
+    }
+    while (fgets(nome, sizeof(nome), fin))
+    {
+      if ((p = strchr(nome, '#')) != NULL)
+        *p = '\0';
+      len = strlen(nome);
+      while (len > 0 && (nome[len - 1] == '\n' || nome[len - 1] == '\r' || nome[len - 1] == ' ' || nome[len - 1] == '\t'))
+        nome[--len] = '\0';
+      p = nome;
+      while (*p == ' ' || *p == '\t')
+        p++;
+      if (*p)
+        adiciona_arquivo(arquivos, &n, &cap, p);
+    }
+    fclose(fin);
+  }
+  return n;
+}
+
+/* laco de cada thread: pega a proxima execucao de um par (instancia, tipo)
+   e a executa; a execucao r de cada par usa a semente L->semente + r */
+static void *trabalhador(void *arg)
+{
+  Tlote *L = (Tlote *)arg;
+  Tparametros par = L->par;
+  Tarena arena;
+  int j, par_j, r;
+
+  // nenhuma saida do GLPK no terminal nesta thread
+  glp_term_out(GLP_OFF);
+  arena_cria(&arena);
+
+  for (;;)
+  {
+    pthread_mutex_lock(&L->trava);
+    j = L->proximo++;
+    pthread_mutex_unlock(&L->trava);
+    if (j >= L->total)
+      break;
+    par_j = j / L->nrep;
+    r = j % L->nrep;
+    if (L->semente != 0)
+      par.semente = L->semente + r;
+    // as repeticoes de um par rodam ao mesmo tempo e gravariam os mesmos
+    // arquivos <instancia>-<tipo>.*: so a primeira grava
+    par.grava_saida = L->par.grava_saida && r == 0;
+    executa_metodo(L->arquivos[par_j / L->ntipos], L->tipos[par_j % L->ntipos], &par, &arena, &L->res[j]);
+  }
+
+  // libera a arena e o ambiente do GLPK desta thread
+  arena_libera(&arena);
+  glp_free_env();
+  return NULL;
+}
+
+/* executa nrep vezes cada par (instancia, tipo) em nthreads threads (<= 0
+   usa todos os nucleos); devolve os resultados na ordem (instancia, tipo,
+   execucao). Com semente != 0 a execucao r usa a semente semente + r */
+Tresultado *executa_pares(char **arquivos, int narquivos, int *tipos, int ntipos, int nrep, unsigned semente, int nthreads, Tparametros *par)
+{
+  Tlote L;
+  pthread_t *threads;
+  int i;
+
+  L.arquivos = arquivos;
+  L.narquivos = narquivos;
+  memcpy(L.tipos, tipos, sizeof(int) * ntipos);
+  L.ntipos = ntipos;
+  L.nrep = nrep;
+  L.semente = semente;
+
+  // as threads ja estao ocupadas com o lote: cada metodo usa uma so thread;
+  // os arquivos de depuracao de nome fixo seriam gravados ao mesmo tempo
+  L.par = *par;
+  L.par.nthreads = 1;
+  L.par.grava_modelo = 0;
+
+  L.total = narquivos * ntipos * nrep;
+  L.proximo = 0;
+  L.res = (Tresultado *)calloc(L.total, sizeof(Tresultado));
+  pthread_mutex_init(&L.trava, NULL);
+
+  if (nthreads <= 0)
+    nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (nthreads < 1)
+    nthreads = 1;
+  if (nthreads > L.total)
+    nthreads = L.total;
+
+  threads = (pthread_t *)malloc(sizeof(pthread_t) * nthreads);
+  for (i = 0; i < nthreads; i++)
+    pthread_create(&threads[i], NULL, trabalhador, &L);
+  for (i = 0; i < nthreads; i++)
+    pthread_join(threads[i], NULL);
+
+  pthread_mutex_destroy(&L.trava);
+  free(threads);
+  return L.res;
+}
+
+/* executa o lote; nthreads <= 0 usa todos os nucleos disponiveis e saida ==
+   NULL grava a tabela na saida padrao */
+int executa_lote(char *entrada, char *tipos, int nthreads, char *saida, Tparametros *par)
+{
+  Tresultado *res;
+  FILE *fout;
+  char **arquivos;
+  double antes, agora;
+  int lista[MAX_TIPOS], ntipos, narquivos, total, i, j, falhas;
+
+  ntipos = le_tipos(tipos, lista);
+  if (ntipos == 0)
+  {
+    printf("Lista de tipos invalida: %s\n", tipos);
+    return 0;
+  }
+
+  narquivos = lista_instancias(entrada, &arquivos);
+  if (narquivos == 0)
+  {
+    printf("Nenhuma instancia encontrada em %s\n", entrada);
+    free(arquivos);
+    return 0;
+  }
+
+  if (nthreads <= 0)
+    nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  total = narquivos * ntipos;
+  antes = glp_mono_time();
+  res = executa_pares(arquivos, narquivos, lista, ntipos, 1, 0, nthreads, par);
+  agora = glp_mono_time();
+
+  fout = stdout;
+  if (saida != NULL)
+  {
+    fout = fopen(saida, "w");
+    if (!fout)
+    {
+      printf("\nProblema na abertura do arquivo %s\n", saida);
+      fout = stdout;
+    }
+  }
+
+  // tabela unica com o resultado de todos os pares
+  fprintf(fout, "instancia;tipo;n;k;z;dual;primal,gap;nos;ativos;tempo");
+  if (par->fases)
+    cronometro_cabecalho(fout);
+  fprintf(fout, "\n");
+  falhas = 0;
+  for (j = 0; j < total; j++)
+  {
+    if (res[j].ok)
+    {
+      imprime_resultado(fout, &res[j]);
+      imprime_distribuicao(stderr, &res[j]);
+      imprime_memoria(stderr, &res[j]);
+    }
+    else
+    {
+      printf("Problema na carga da instância: %s\n", res[j].arquivo);
+      falhas++;
+    }
+  }
+  if (fout != stdout)
+    fclose(fout);
+
+  fprintf(stderr, "lote: %d execucoes (%d instancias x %d tipos) em %d threads, %d falhas, tempo total=%lf\n", total, narquivos, ntipos, (nthreads < total) ? nthreads : total, falhas, glp_difftime(agora, antes));
+
+  // libera memoria alocada
+  for (i = 0; i < narquivos; i++)
+    free(arquivos[i]);
+  free(arquivos);
+  free(res);
+  return 1;
+}
+
+/* eof */
@@ -39,74 +39,30 @@ variaveis: xij binarias = 1 se o item i eh transportado na mochila j
 #include <glpk.h>
 #include <time.h>
 #include <string.h>
-
-#define EPSILON 0.000001
-
+#include <float.h>
+#include <math.h>
+#include "mochila_multipla.h"
+
+/* carrega o modelo de PLI nas estruturas do GLPK
+   os nomes das restricoes e variaveis so sao criados com DEBUG (para gravar o
+   mochila.lp), pois cada nome eh inserido no indice de nomes do GLPK; a matriz
+   de coeficientes eh montada diretamente por colunas (glp_load_cols) */
+int carga_lp(glp_prob **lp, Tinstance I, Tarena *A)
+{
+  int *ptr, *ind, nrows, ncols, i, k, row, col, nz;
+  double *val;
+  Tmarca m = arena_marca(A);
 #ifdef DEBUG
-#define PRINTF(...) printf(__VA_ARGS__)
-#else
-#define PRINTF(...)
-#endif
-
-typedef struct
-{
-  int num;      /* numero do item */
-  double valor; /* valor do item */
-  int peso;     /* peso do item */
-  int index;    /* mochila ao qual o item pertence */
-} Titem;
-
-typedef struct
-{
-  int n;       /* total de itens */
-  Titem *item; /* conjunto dos itens */
-  int k;       /* total de mochilas */
-  int *C;      /* capacidade das mochilas */
-} Tinstance;
-
-// estrutura usada pela callback para salvar informações do B&B
-typedef struct
-{
-  glp_prob *mip;
-  int nodes;
-  int ativos;
-  double best_dualBound;
-  double best_primalBound;
-  double gap;
-} my_infoT;
-
-void my_callback(glp_tree *tree, void *infop);
-int carga_lp(glp_prob **lp, Tinstance I);
-int carga_instancia(char *filename, Tinstance *I);
-void free_instancia(Tinstance I);
-int RandomInteger(int low, int high);
-int comparador(const void *valor1, const void *valor2);
-int comparador_num(const void *num1, const void *num2);
-double guloso(Tinstance I);
-double random_heuristica(Tinstance I);
-double heuristica_melhorada(Tinstance I, my_infoT *info, int tipo);
-void troca(Titem *a, Titem *b);
-double heuristica(Tinstance I, int tipo, my_infoT *info);
-double otimiza_PLI(Tinstance I, int tipo, double *x, my_infoT *info);
-void gerar_arquivo_sol(char *filename, int tipo, double z, Tinstance I);
-void gerar_arquivo_out(char *filename, int tipo, double z, double tempo);
-double destroy_rins(Tinstance I, double z, double xx, double *x);
-double repair_rins(Tinstance I, double z, double *x);
-
-/* carrega o modelo de PLI nas estruturas do GLPK */
-int carga_lp(glp_prob **lp, Tinstance I)
-{
-  int *ia, *ja, nrows, ncols, i, k, row, col, nz;
-  double *ar;
   char name[80]; // nome da restricao
+#endif
 
   nrows = I.k + I.n; // 1 restricao de capacidade para cada mochila + 1 para cada item
   ncols = I.n * I.k;
 
-  // Aloca matriz de coeficientes
-  ia = (int *)malloc(sizeof(int) * (I.n * I.k * 2 + 1));
-  ja = (int *)malloc(sizeof(int) * (I.n * I.k * 2 + 1));
-  ar = (double *)malloc(sizeof(double) * (I.n * I.k * 2 + 1));
+  // Aloca matriz de coeficientes (por colunas: 2 coeficientes por variavel)
+  ptr = (int *)arena_aloca(A, sizeof(int) * (ncols + 2));
+  ind = (int *)arena_aloca(A, sizeof(int) * (ncols * 2 + 1));
+  val = (double *)arena_aloca(A, sizeof(double) * (ncols * 2 + 1));
 
   // Cria problema de PL
   *lp = glp_create_prob();
@@ -120,8 +76,10 @@ int carga_lp(glp_prob **lp, Tinstance I)
   row = 1;
   for (k = 0; k < I.k; k++)
   {
+#ifdef DEBUG
     sprintf(name, "capacidade_Mochila_%d", row); /* nome das restricoes */
     glp_set_row_name(*lp, row, name);
+#endif
     glp_set_row_bnds(*lp, row, GLP_UP, 0.0, I.C[row - 1]);
     row++;
   }
@@ -129,8 +87,10 @@ int carga_lp(glp_prob **lp, Tinstance I)
   // criar uma restricao de unicidade para cada item
   for (i = 0; i < I.n; i++)
   {
+#ifdef DEBUG
     sprintf(name, "unicidade_%d", row); /* nome das restricoes */
     glp_set_row_name(*lp, row, name);
+#endif
     glp_set_row_bnds(*lp, row, GLP_UP, 0.0, 1.0);
     row++;
   }
@@ -138,128 +98,123 @@ int carga_lp(glp_prob **lp, Tinstance I)
   glp_add_cols(*lp, ncols);
 
   col = 1;
+  nz = 1;
   for (k = 1; k <= I.k; k++)
   {
     for (i = 0; i < I.n; i++)
     {
-      name[0] = '\0';
+#ifdef DEBUG
       sprintf(name, "x%d_%d", i + 1, k); /* as variaveis referem-se `as variaveis xi_k para cada item i e cada mochila k */
       glp_set_col_name(*lp, col, name);
-      glp_set_col_bnds(*lp, col, GLP_DB, 0.0, 1.0);
+#endif
       glp_set_obj_coef(*lp, col, I.item[i].valor);
-      glp_set_col_kind(*lp, col, GLP_BV); // especifica que a variaval xik eh binaria
-      col++;
-    }
-  }
+      glp_set_col_kind(*lp, col, GLP_BV); // especifica que a variaval xik eh binaria (limites 0 e 1)
 
-  // Configura matriz de coeficientes ...
-  nz = 1;
-  //coeficientes para as restricoes de cada item
-  for (k = 1; k <= I.k; k++) //para cada mochila
-  {
-    for (i = 1; i <= I.n; i++) //para cada item
-    {
-      // restr de capacidade
-      ia[nz] = k;                  // linha (indice da restricao)
-      ja[nz] = (k - 1) * I.n + i;  // coluna (indice da variavel = xik)
-      ar[nz] = I.item[i - 1].peso; // coeficiente da matriz de coeficientes na linha e coluna
+      // Configura matriz de coeficientes: coluna da variavel xik
+      ptr[col] = nz;
+      ind[nz] = k;                // restr de capacidade da mochila k
+      val[nz] = I.item[i].peso;
       nz++;
-    }
-  }
-
-  // coeficientes para as restricoes de unicidade
-  for (i = 1; i <= I.n; i++) //para cada item
-  {
-    for (k = 1; k <= I.k; k++) //para cada mochila
-    {
-      // restr de unicidade
-      ia[nz] = I.k + i;
-      ja[nz] = (k - 1) * I.n + i;
-      ar[nz] = 1.0;
+      ind[nz] = I.k + i + 1;      // restr de unicidade do item i
+      val[nz] = 1.0;
       nz++;
+      col++;
     }
   }
+  ptr[col] = nz;
 
   // Carrega PL
-  glp_load_matrix(*lp, nz - 1, ia, ja, ar);
+  glp_load_cols(*lp, ptr, ind, val);
 
-  // libera memoria
-  free(ia);
-  free(ja);
-  free(ar);
+  // devolve a memoria de trabalho
+  arena_volta(A, m);
   return 1;
 }
 
-/* carrega os dados da instancia de entrada */
-int carga_instancia(char *filename, Tinstance *I)
+/* quebra de simetria das mochilas de mesma capacidade: qualquer solucao pode
+   ter as mochilas de uma classe permutadas, por isso as mochilas da classe
+   sao ordenadas
+    - tipo 1: pela carga (a carga de cada mochila nao eh menor que a da
+      seguinte), uma restricao com 2n coeficientes por par de mochilas;
+    - tipo 2: pelo primeiro item de cada uma, com os itens em ordem
+      decrescente de peso. Com as mochilas da classe nessa ordem, a de
+      posicao p tem o primeiro item na posicao >= p, logo os itens das
+      posicoes t < p ficam fora dela: sao so limites de colunas (x[i][j] = 0),
+      sem linhas nem coeficientes novos no modelo.
+   Devolve o total de restricoes (tipo 1) ou de colunas fixadas (tipo 2). */
+int carga_simetria(glp_prob *lp, Tinstance I, int tipo, Tarena *A)
 {
-  FILE *fin;
-  int i, capacidade, item, peso;
-  double valor;
-
-  fin = fopen(filename, "r");
-  if (!fin)
+  Tchave *chaves, *ordem;
+  int *ind, i, j, t, a, b, p, row, total = 0;
+  double *val;
+  Tmarca m = arena_marca(A);
+
+  // mochilas em ordem de capacidade (desempate pelo indice)
+  chaves = (Tchave *)arena_aloca(A, sizeof(Tchave) * I.k);
+  for (j = 0; j < I.k; j++)
   {
-    printf("\nProblema na abertura do arquivo %s\n", filename);
-    return 0;
+    chaves[j].chave = I.C[j] + (double)(I.k - j) / (I.k + 1);
+    chaves[j].i = j;
   }
+  qsort(chaves, I.k, sizeof(Tchave), comparador_chave);
 
-  fscanf(fin, "%d %d", &(I->n), &(I->k));
-
-  // aloca memória
-  (*I).C = (int *)malloc(sizeof(int) * ((*I).k));
-  (*I).item = (Titem *)malloc(sizeof(Titem) * ((*I).n));
-
-  for (i = 0; i < (*I).k; i++)
+  if (tipo == 2)
   {
-    fscanf(fin, "%d", &capacidade);
-    (*I).C[i] = capacidade;
-  }
+    // itens em ordem decrescente de peso
+    ordem = (Tchave *)arena_aloca(A, sizeof(Tchave) * I.n);
+    for (i = 0; i < I.n; i++)
+    {
+      ordem[i].chave = I.item[i].peso;
+      ordem[i].i = i;
+    }
+    qsort(ordem, I.n, sizeof(Tchave), comparador_chave);
 
-  for (i = 0; i < (*I).n; i++)
-  {
-    fscanf(fin, "%d %d %lf", &item, &peso, &valor);
-    if (item < 1 || item > (*I).n)
+    // p = posicao da mochila na sua classe
+    for (j = 0, p = 0; j < I.k; j++)
     {
-      fclose(fin);
-      return 0;
+      p = (j > 0 && I.C[chaves[j].i] == I.C[chaves[j - 1].i]) ? p + 1 : 0;
+      b = chaves[j].i;
+      for (t = 0; t < p && t < I.n; t++)
+      {
+        glp_set_col_bnds(lp, b * I.n + ordem[t].i + 1, GLP_FX, 0.0, 0.0);
+        total++;
+      }
     }
-    (*I).item[i].num = item;
-    (*I).item[i].peso = peso;
-    (*I).item[i].valor = valor;
+    arena_volta(A, m);
+    return total;
   }
 
-#ifdef DEBUG
-  printf("n=%d k=%d\n", (*I).n, (*I).k);
-  for (i = 0; i < (*I).k; i++)
+  // carga(a) - carga(b) >= 0
+  ind = (int *)arena_aloca(A, sizeof(int) * (2 * I.n + 1));
+  val = (double *)arena_aloca(A, sizeof(double) * (2 * I.n + 1));
+  for (j = 0; j + 1 < I.k; j++)
   {
-    printf("C[%d]=%d\n", i + 1, (*I).C[i]);
-  }
-  for (i = 0; i < (*I).n; i++)
-  {
-    printf("p[%d]=%d e v[%d]=%lf\n", (*I).item[i].num, (*I).item[i].peso, (*I).item[i].num, (*I).item[i].valor);
+    a = chaves[j].i;
+    b = chaves[j + 1].i;
+    if (I.C[a] != I.C[b])
+      continue;
+    for (i = 0; i < I.n; i++)
+    {
+      ind[i + 1] = a * I.n + i + 1;
+      val[i + 1] = I.item[i].peso;
+      ind[I.n + i + 1] = b * I.n + i + 1;
+      val[I.n + i + 1] = -I.item[i].peso;
+    }
+    row = glp_add_rows(lp, 1);
+    glp_set_row_bnds(lp, row, GLP_LO, 0.0, 0.0);
+    glp_set_mat_row(lp, row, 2 * I.n, ind, val);
+    total++;
   }
-#endif
-  fclose(fin);
-  return 1;
-}
 
-/* libera memoria alocada pelo programa para guardar a instancia */
-void free_instancia(Tinstance I)
-{
-  free(I.item);
-  free(I.C);
+  arena_volta(A, m);
+  return total;
 }
 
-/* sorteia um numero aleatorio entre [low,high] */
-int RandomInteger(int low, int high)
+/* sorteia um numero aleatorio entre [low,high] (cada thread usa o seu
+   proprio gerador) */
+int RandomInteger(glp_rng *rng, int low, int high)
 {
-  int k;
-  double d;
-
-  d = (double)rand() / ((double)RAND_MAX + 1);
-  k = d * (high - low + 1);
-  return low + k;
+  return low + glp_rng_unif(rng, high - low + 1);
 }
 
 // callback usada para salvar informações da execução do B&B
@@ -270,21 +225,49 @@ void my_callback(glp_tree *tree, void *infop)
 
   info = (my_infoT *)infop;
 
+  // portfolio (tipo 30): parada e troca da incumbente com os outros metodos
+  if (info->portfolio != NULL && portfolio_callback(tree, info->portfolio))
+    return;
+
   switch (glp_ios_reason(tree))
   {
+  case GLP_IHEUR:
+    // solucao viavel conhecida antes do B&B (ver heuristica_melhorada)
+    if (info->x_inicial != NULL)
+    {
+      glp_ios_heur_sol(tree, info->x_inicial);
+      info->x_inicial = NULL;
+    }
+    // arredondamento e reparo da relaxacao do no (-h)
+    if (info->heur_no != NULL)
+      heuristica_no(tree, info->heur_no);
+    break;
+  case GLP_ICUTGEN:
+    // desigualdades de cobertura das mochilas (-c)
+    if (info->cortes != NULL)
+      separa_coberturas(tree, info->cortes);
+    break;
   case GLP_ISELECT:
   case GLP_IBINGO:
     glp_ios_tree_size(tree, &(info->ativos), &(info->nodes), NULL);
     bestnode = glp_ios_best_node(tree);
     info->best_dualBound = glp_ios_node_bound(tree, bestnode);
     info->best_primalBound = glp_mip_obj_val(info->mip);
-    info->gap = glp_ios_mip_gap(tree);
-#ifdef DEBUG
-    if (info->best_dualBound < 1e10)
-      printf("%d\t%d\t%d\t%.2lf\t%.2lf\t%.2lf\n", info->ativos, info->nodes, bestnode, info->best_primalBound, info->best_dualBound, 100 * (info->gap));
-    else
-      printf("%d\t%d\t%d\t%.2lf\t*\t%.2lf\n", info->ativos, info->nodes, bestnode, info->best_primalBound, 100 * (info->gap));
-#endif
+    // o gap de glp_ios_mip_gap, sem percorrer de novo os nos ativos
+    info->gap = glp_mip_status(info->mip) == GLP_FEAS ? fabs(info->best_primalBound - info->best_dualBound) / (fabs(info->best_primalBound) + DBL_EPSILON) : DBL_MAX;
+    // o limitante lagrangiano pode ser melhor que o dos nos ativos; se a
+    // melhor solucao o atingir, ela eh otima e o B&B pode parar
+    if (info->limite_lagrangiano < info->best_dualBound)
+    {
+      info->best_dualBound = info->limite_lagrangiano;
+      if (info->gap < DBL_MAX)
+        info->gap = (info->best_dualBound - info->best_primalBound) / (info->best_primalBound + DBL_EPSILON);
+      if (glp_mip_status(info->mip) != GLP_UNDEF && info->best_primalBound >= info->best_dualBound - EPSILON)
+        glp_ios_terminate(tree);
+    }
+    // amostra para o arquivo .bb (-m)
+    if (info->telemetria != NULL)
+      telemetria_amostra(info->telemetria, glp_ios_reason(tree) == GLP_IBINGO, info);
     break;
   default:
     break;
@@ -292,14 +275,20 @@ void my_callback(glp_tree *tree, void *infop)
 }
 
 // parameter info = guarda informações de execução do B&B
-double otimiza_PLI(Tinstance I, int tipo, double *x, my_infoT *info)
+// com par->preprocessa (so no tipo 2), o B&B usa o modelo reduzido de
+// preprocessamento.c e as reducoes ficam em red
+double otimiza_PLI(Tinstance I, int tipo, Tparametros *par, double *x, my_infoT *info, Treducao *red)
 {
   glp_prob *lp;
   double z, valor;
   //  clock_t antes, agora;
   glp_smcp param_lp;
   glp_iocp param_ilp;
-  int i, k;
+  Tpreprocessamento P;
+  Theur_no H;
+  Tcortes S;
+  int i, k, c, reduzido, otimo = 0;
+  Tmarca m = arena_marca(info->arena);
 #ifdef DEBUG
   int status;
 #endif
@@ -307,8 +296,38 @@ double otimiza_PLI(Tinstance I, int tipo, double *x, my_infoT *info)
   // desabilita saidas do GLPK no terminal
   glp_term_out(GLP_OFF);
 
-  // carga do lp
-  carga_lp(&lp, I);
+  // carga do lp (a quebra de simetria supoe o modelo completo)
+  reduzido = (tipo == 2 && par->preprocessa);
+  if (reduzido)
+  {
+    preprocessa(I, TEMPO_LIMITE * PRE_FRACAO_INICIAL, info, &P);
+    // a solucao inicial (-w), se for melhor, substitui a heuristica na fixacao
+    if (info->x_inicial != NULL)
+    {
+      valor = 0.0;
+      for (c = 0; c < I.n * I.k; c++)
+        valor += info->x_inicial[c + 1] * I.item[c % I.n].valor;
+      if (valor > P.z_inc)
+      {
+        P.z_inc = P.red.lb = valor;
+        memcpy(P.x_inc, info->x_inicial + 1, sizeof(double) * I.n * I.k);
+      }
+    }
+    FASE_INICIO(info->crono, FASE_MODELO);
+    carga_lp_reduzido(&lp, I, &P, info->arena);
+    FASE_FIM(info->crono);
+  }
+  else
+  {
+    FASE_INICIO(info->crono, FASE_MODELO);
+    carga_lp(&lp, I, info->arena);
+    if (par->simetria)
+    {
+      k = carga_simetria(lp, I, par->simetria, info->arena);
+      PRINTF("simetria: %d restricoes ou colunas fixadas\n", k);
+    }
+    FASE_FIM(info->crono);
+  }
 
   // configura simplex
   glp_init_smcp(&param_lp);
@@ -317,7 +336,7 @@ double otimiza_PLI(Tinstance I, int tipo, double *x, my_infoT *info)
   // configura optimizer
   glp_init_iocp(&param_ilp);
   param_ilp.msg_lev = GLP_MSG_ALL;
-  param_ilp.tm_lim = 1000;
+  param_ilp.tm_lim = (int)info->limite_bb;
   param_ilp.out_frq = 100;
 
   // ativa my callback
@@ -326,11 +345,48 @@ double otimiza_PLI(Tinstance I, int tipo, double *x, my_infoT *info)
 
   info->mip = lp;
   // Executa Solver de PL
+  FASE_INICIO(info->crono, FASE_RELAXACAO);
   glp_simplex(lp, &param_lp); // resolve o problema relaxado
-  if (tipo == 2)
+  FASE_FIM(info->crono);
+  if (reduzido)
   {
+    // fixacao pelos custos reduzidos; as colunas retiradas sao nao basicas e
+    // a base continua otima para o simplex seguinte
+    otimo = fixa_custos_reduzidos(lp, &P, info->arena);
+    FASE_INICIO(info->crono, FASE_RELAXACAO);
+    if (!otimo && P.red.fixadas > 0)
+      glp_simplex(lp, &param_lp);
+    FASE_FIM(info->crono);
+    info->x_inicial = solucao_reduzida(&P, lp, info->arena);
+    *red = P.red;
+  }
+  if (tipo == 2 && !otimo)
+  {
+    if (par->heur_no > 0)
+    {
+      heuristica_no_cria(&H, I, reduzido ? P.col : NULL, glp_get_num_cols(lp), par->heur_no, info->arena);
+      info->heur_no = &H;
+    }
+    if (par->cortes)
+    {
+      cortes_cria(&S, I, reduzido ? P.col : NULL, glp_get_num_cols(lp), lp, info->arena);
+      info->cortes = &S;
+    }
+    FASE_INICIO(info->crono, FASE_BB);
     glp_intopt(lp, &param_ilp); // resolve o problema inteiro
+    FASE_FIM(info->crono);
+    if (info->heur_no != NULL)
+    {
+      PRINTF("heuristica nos nos: %d chamadas, %d melhorias, %.3lf s\n", H.chamadas, H.melhorias, H.tempo);
+      info->heur_no = NULL;
+    }
+    if (info->cortes != NULL)
+    {
+      PRINTF("cortes de cobertura: %d (%d agregados)\n", S.cortes, S.agregados);
+      info->cortes = NULL;
+    }
   }
+  info->x_inicial = NULL;
 
 #ifdef DEBUG
   if (tipo == 2)
@@ -347,34 +403,76 @@ double otimiza_PLI(Tinstance I, int tipo, double *x, my_infoT *info)
     z = glp_mip_obj_val(lp);
   }
 
-  for (k = 0; k < I.k; k++)
+  if (reduzido)
   {
-    for (i = 0; i < I.n; i++)
+    // volta as variaveis x_ij; a heuristica fica se o B&B nao a melhorou
+    // (as colunas fixadas so excluem solucoes que nao a melhoram)
+    if (otimo || (glp_mip_status(lp) != GLP_OPT && glp_mip_status(lp) != GLP_FEAS) || z < P.z_inc)
     {
-      if (tipo == 1)
-        valor = glp_get_col_prim(lp, k * I.n + i + 1); // recupera o valor da variavel xik relaxado (continuo)
-      else
-        valor = glp_mip_col_val(lp, k * I.n + i + 1); // recupera o valor da variavel xik
-      if (valor > EPSILON)
-        PRINTF("x%d_%d = %.2lf\n", i + 1, k + 1, valor);
-      x[k * I.n + i] = valor;
+      z = P.z_inc;
+      memcpy(x, P.x_inc, sizeof(double) * I.n * I.k);
+    }
+    else
+    {
+      memset(x, 0, sizeof(double) * I.n * I.k);
+      for (c = 1; c <= P.m; c++)
+        x[P.col[c]] = glp_mip_col_val(lp, c);
+    }
+    info->best_primalBound = z;
+    if (otimo || glp_mip_status(lp) == GLP_OPT)
+      info->best_dualBound = z;
+    else if (info->best_dualBound < z)
+      info->best_dualBound = z;
+    info->gap = (info->best_dualBound - z) / (z + DBL_EPSILON);
+  }
+  else
+  {
+    for (k = 0; k < I.k; k++)
+    {
+      for (i = 0; i < I.n; i++)
+      {
+        if (tipo == 1)
+          valor = glp_get_col_prim(lp, k * I.n + i + 1); // recupera o valor da variavel xik relaxado (continuo)
+        else
+          valor = glp_mip_col_val(lp, k * I.n + i + 1); // recupera o valor da variavel xik
+        if (valor > EPSILON)
+          PRINTF("x%d_%d = %.2lf\n", i + 1, k + 1, valor);
+        x[k * I.n + i] = valor;
+      }
     }
   }
 
 #ifdef DEBUG
-  // Grava solucao e PL
-  PRINTF("\n---LP gravado em mochila.lp e solucao em mochila.sol");
-  glp_write_lp(lp, NULL, "mochila.lp");
-  if (tipo == 1)
-    glp_print_sol(lp, "mochila.sol");
-  else
-    glp_print_mip(lp, "mochila.sol");
+  // Grava solucao e PL (nomes fixos: so com uma execucao por processo)
+  if (par->grava_modelo)
+  {
+    PRINTF("\n---LP gravado em mochila.lp e solucao em mochila.sol");
+    glp_write_lp(lp, NULL, "mochila.lp");
+    if (tipo == 1)
+      glp_print_sol(lp, "mochila.sol");
+    else
+      glp_print_mip(lp, "mochila.sol");
+  }
 #endif
-  // Destroi problema
+  // Destroi problema (e devolve a arena: preprocessamento, heuristica e cortes)
   glp_delete_prob(lp);
+  arena_volta(info->arena, m);
   return z;
 }
 
+/* limitante lagrangiano para a callback do B&B do tipo 2 (-g 1), com ate um
+   decimo do tempo limite do B&B; o tempo gasto sai do tempo limite do B&B */
+void limite_lagrangiano_bb(Tinstance I, Tparametros *par, my_infoT *info)
+{
+  double inicio = glp_mono_time();
+
+  lagrangiana(I, par->nthreads, info->limite_bb / 10, info);
+  info->limite_lagrangiano = info->best_dualBound;
+  info->limite_bb -= 1000 * glp_difftime(glp_mono_time(), inicio);
+  if (info->limite_bb < 1)
+    info->limite_bb = 1;
+}
+
 // Função auxiliar de comparacao para o qsort
 int comparador(const void *valor1, const void *valor2)
 {
@@ -409,95 +507,117 @@ int comparador_num(const void *num1, const void *num2)
   }
 }
 
-//Primeira heuristica implementada pelo grupo
-double guloso(Tinstance I)
+// Função auxiliar de comparacao para o qsort (Tchave em ordem decrescente)
+int comparador_chave(const void *a, const void *b)
 {
-  double z = 0.0; // Melhor resposta;
-  int j;          // Indice da mochila
-
-  qsort(I.item, I.n, sizeof(Titem), comparador); //Ordenacao da lista de itens pelo valor de cada item
+  double ca = ((Tchave *)a)->chave, cb = ((Tchave *)b)->chave;
+  return (ca > cb) ? -1 : (ca < cb);
+}
 
-  // Inicializa os index do item com valor zero
-  for (int i = 0; i < I.n; i++)
-    I.item[i].index = 0;
+// Coloca os itens, na ordem S->ordem, na primeira mochila em que cabem (a
+// arvore das capacidades acha a mochila em O(log k)); as capacidades
+// residuais ficam em C e a mochila de cada item em index
+static double preenche_ordem(Tsoa *S, int *C, int k, int *index, Tarena *A)
+{
+  Tcapacidades T;
+  int i, t, j;
+  Tmarca m = arena_marca(A);
 
-  // Percorre toda lista de itens
-  for (int i = 0; i < I.n; i++)
+  capacidades_cria(&T, C, k, ENCAIXE_PRIMEIRA, A);
+  for (t = 0; t < S->n; t++)
   {
-    j = 0;
-    while (j < I.k) // Tenta colocar o item em alguma mochila
+    i = S->ordem[t];
+    j = capacidades_escolhe(&T, S->peso[i], ENCAIXE_PRIMEIRA); // Tenta colocar o item em alguma mochila
+    if (j >= 0)
     {
-      if (I.item[i].peso <= I.C[j]) // Verifica se o peso do item não
-      {                             // ultrapassa a capacidade da mochila
-        I.item[i].index = j + 1;
-        I.C[j] -= I.item[i].peso;
-        z += I.item[i].valor;
-        j = I.k;
-      }
-      else
-        j++;
+      index[i] = j + 1;
+      capacidades_retira(&T, j, S->peso[i]);
     }
   }
+  arena_volta(A, m);
+  return objetivo(S->valor, index, S->n);
+}
+
+//Primeira heuristica implementada pelo grupo
+// Os itens sao tomados em ordem decrescente de valor e, depois, de valor/peso
+// (cada ordem eh uma permutacao das posicoes: I.item nao eh reordenado); fica
+// a melhor das duas solucoes. A razao sozinha perde para o valor quando os
+// itens leves tem razao alta e deixam folgas que os itens grandes nao usam
+double guloso(Tinstance I, Tarena *A)
+{
+  Tsoa S;        // Itens em vetores separados
+  double z, z2;  // Melhor resposta e resposta da segunda ordem
+  int *C2, *index2;
+  Tmarca m = arena_marca(A);
+
+  soa_carrega(&S, I, A);
+  C2 = (int *)arena_aloca(A, sizeof(int) * I.k);
+  index2 = (int *)arena_aloca_zerada(A, sizeof(int) * I.n);
+  memcpy(C2, I.C, sizeof(int) * I.k);
+
+  ordena_permutacao(S.valor, S.n, S.ordem, A); // Ordenacao dos itens pelo valor
+  z = preenche_ordem(&S, I.C, I.k, S.index, A);
+
+  calcula_razao(S.valor, S.peso, S.razao, S.n); // Ordenacao dos itens por valor/peso
+  ordena_permutacao(S.razao, S.n, S.ordem, A);
+  z2 = preenche_ordem(&S, C2, I.k, index2, A);
+  if (z2 > z)
+  {
+    z = z2;
+    memcpy(S.index, index2, sizeof(int) * I.n);
+    memcpy(I.C, C2, sizeof(int) * I.k);
+  }
 
+  soa_devolve(&S, I);
+  arena_volta(A, m);
   return z;
 }
 
 // Função que troca dois itens da lista de itens de lugar
 void troca(Titem *a, Titem *b)
 {
-  Titem aux;
-
-  aux.num = (*a).num;
-  aux.valor = (*a).valor;
-  aux.peso = (*a).peso;
-  aux.index = (*a).index;
+  Titem aux = *a;
 
-  (*a).num = (*b).num;
-  (*a).valor = (*b).valor;
-  (*a).peso = (*b).peso;
-  (*a).index = (*b).index;
-
-  (*b).num = aux.num;
-  (*b).valor = aux.valor;
-  (*b).peso = aux.peso;
-  (*b).index = aux.index;
+  *a = *b;
+  *b = aux;
 }
 
 //Segunda heuristica implementada pelo grupo
-double random_heuristica(Tinstance I)
+// O sorteio eh feito sobre uma permutacao das posicoes dos itens, sem mover
+// os itens; a sequencia de sorteios eh a mesma de antes
+double random_heuristica(Tinstance I, glp_rng *rng, Tarena *A)
 {
-  double z = 0.0; // Melhor resposta
-  int i;          // Item escolhido aleatoriamente
-  int j;          // Indice da mochila
-  int n = I.n;    // Numero de itens restantes na lista de itens
-
-  for (int k = 0; k < I.n; k++)
-    I.item[k].index = 0;
-
-  srand(time(NULL));
+  Tsoa S;      // Itens em vetores separados
+  double z;    // Melhor resposta
+  int i;       // Item escolhido aleatoriamente
+  int j;       // Indice da mochila
+  int n = I.n; // Numero de itens restantes na lista de itens
+  int t;
+  Tmarca m = arena_marca(A);
+
+  soa_carrega(&S, I, A);
+  for (t = 0; t < S.n; t++)
+    S.ordem[t] = t;
 
   while (n > 0)
   {
-    i = RandomInteger(0, n - 1); // Escolhe um item aleatoriamente
-    j = 0;
-
-    while (j < I.k) // Verifica em qual mochila colocar o item
+    t = RandomInteger(rng, 0, n - 1); // Escolhe um item aleatoriamente
+    i = S.ordem[t];
+    j = primeira_mochila(I.C, I.k, S.peso[i]); // Verifica em qual mochila colocar o item
+    if (j >= 0)
     {
-      if (I.item[i].peso <= I.C[j])
-      {
-        I.item[i].index = j + 1;
-        I.C[j] -= I.item[i].peso;
-        z += I.item[i].valor;
-        j = I.k;
-      }
-      else
-        j++;
+      S.index[i] = j + 1;
+      I.C[j] -= S.peso[i];
     }
 
-    troca(&I.item[i], &I.item[n - 1]); // Troca o item escolhido pelo ultimo item
-    n--;                               // Tira o ultimo item da lista para ele nao ser escolhido novamente
+    S.ordem[t] = S.ordem[n - 1]; // Troca o item escolhido pelo ultimo item
+    S.ordem[n - 1] = i;
+    n--;                         // Tira o ultimo item da lista para ele nao ser escolhido novamente
   }
 
+  z = objetivo(S.valor, S.index, S.n);
+  soa_devolve(&S, I);
+  arena_volta(A, m);
   return z;
 }
 
@@ -518,51 +638,73 @@ double destroy_rins(Tinstance I, double z, double xx, double *x)
   return z;
 }
 
-double repair_rins(Tinstance I, double z, double *x)
+double repair_rins(Tinstance I, double z, double *x, Tarena *A)
 {
+  Tcapacidades T;
   int j;
+  Tmarca m = arena_marca(A);
+
+  // cada item fora das mochilas vai para a ultima mochila em que cabe
+  capacidades_cria(&T, I.C, I.k, ENCAIXE_ULTIMA, A);
   for (int i = 0; i < I.n; i++)
   {
-    j = I.k - 1;
-    while (j >= 0) // Tenta colocar o item em alguma mochila
+    if (I.item[i].index != 0)
+      continue;
+    j = capacidades_escolhe(&T, I.item[i].peso, ENCAIXE_ULTIMA);
+    if (j >= 0)
     {
-      if (I.item[i].peso <= I.C[j] && I.item[i].index == 0) // Verifica se o peso do item não
-      {                                                     // ultrapassa a capacidade da mochila e se o item ainda não
-        I.item[i].index = j + 1;                            // foi escolhido
-        I.C[j] -= I.item[i].peso;
-        z += I.item[i].valor;
-        j = I.k;
-      }
-      else
-        j--;
+      I.item[i].index = j + 1;
+      capacidades_retira(&T, j, I.item[i].peso);
+      z += I.item[i].valor;
     }
   }
+  arena_volta(A, m);
   return z;
 }
 
 //Heuristica guloso melhorada
-double heuristica_melhorada(Tinstance I, my_infoT *info, int tipo)
+double heuristica_melhorada(Tinstance I, my_infoT *info, int tipo, glp_rng *rng)
 {
   // double z1 = 0.0; // Melhor resposta do relaxado
   double z2 = 0.0; // Melhor resposta do guloso
   double soma = 0.0;
-  double *x, *x2;
-  int j;
-  Tinstance I_PLI;
+  double *x, *x0;
+  int i, j, col, livres, *inicial, *final, *capacidade;
+  glp_prob *lp;
+  glp_smcp param_lp;
+  glp_iocp param_ilp;
+  Tinstance J;
+  Tarena *A = info->arena;
+  Tmarca m = arena_marca(A);
+
+  // as colunas do modelo seguem a ordem dos itens (j * n + i + 1): os itens
+  // ficam na ordem do numero, que as heuristicas abaixo nao alteram
+  qsort(I.item, I.n, sizeof(Titem), comparador_num);
+  capacidade = (int *)arena_aloca(A, sizeof(int) * I.k);
+  memcpy(capacidade, I.C, sizeof(int) * I.k);
+
+  // um unico modelo eh usado para a relaxacao e para o sub-MIP
+  glp_term_out(GLP_OFF);
+  FASE_INICIO(info->crono, FASE_MODELO);
+  carga_lp(&lp, I, A);
+  FASE_FIM(info->crono);
+  glp_init_smcp(&param_lp);
+  param_lp.msg_lev = GLP_MSG_OFF;
+  FASE_INICIO(info->crono, FASE_RELAXACAO);
+  glp_simplex(lp, &param_lp); // resolve o problema relaxado
+  FASE_FIM(info->crono);
 
-  // aloca memória
-  (I_PLI).C = (int *)malloc(sizeof(int) * ((I).k));
-  (I_PLI).item = (Titem *)malloc(sizeof(Titem) * ((I).n));
+  x = (double *)arena_aloca(A, sizeof(double) * (I.n * I.k));
+  inicial = (int *)arena_aloca(A, sizeof(int) * I.n);
+  for (col = 1; col <= I.n * I.k; col++)
+    x[col - 1] = glp_get_col_prim(lp, col);
 
-  x = (double *)malloc(sizeof(double) * (I.n * I.k));
-  otimiza_PLI(I, 1, x, &info);
   if (tipo == 5){
-    z2 = guloso(I);
+    z2 = guloso(I, A);
   }
   if (tipo == 6){
-    z2 = random_heuristica(I);
+    z2 = random_heuristica(I, rng, A);
   }
-  qsort(I.item, I.n, sizeof(Titem), comparador_num);
 
   z2 = destroy_rins(I, z2, 1.0, x);
 
@@ -570,104 +712,136 @@ double heuristica_melhorada(Tinstance I, my_infoT *info, int tipo)
   if (z2 == 0.0)
   {
     if (tipo == 5){
-      z2 = guloso(I);
+      z2 = guloso(I, A);
     }
     if (tipo == 6){
-      z2 = random_heuristica(I);
+      z2 = random_heuristica(I, rng, A);
     }
-    qsort(I.item, I.n, sizeof(Titem), comparador_num);
+    for (i = 0; i < I.n; i++)
+      inicial[i] = I.item[i].index;
     z2 = destroy_rins(I, z2, 0.1, x);
   }
   else
   {
     // repair:
-    z2 = repair_rins(I, z2, x);
+    z2 = repair_rins(I, z2, x, A);
+    for (i = 0; i < I.n; i++)
+      inicial[i] = I.item[i].index;
     z2 = destroy_rins(I, z2, 1.0, x);
   }
 
-  j = 0;
-  for (int i = 0; i < I.n; i++)
+  // sub-MIP: os itens que ficaram nas mochilas sao fixados nelas (fixando os
+  // limites das colunas do proprio modelo) e os demais sao otimizados nas
+  // capacidades residuais; a solucao anterior ao destroy, que eh viavel para
+  // o sub-MIP, eh a solucao inicial do B&B
+  x0 = (double *)arena_aloca_zerada(A, sizeof(double) * (I.n * I.k + 1));
+  livres = 0;
+  for (i = 0; i < I.n; i++)
   {
+    if (inicial[i] != 0)
+      x0[(inicial[i] - 1) * I.n + i + 1] = 1.0;
     if (I.item[i].index == 0)
-    {                                    // item nao foi pego
-      I_PLI.item[j].num = I.item[i].num; // I_PLI copia o item nao pego
-      I_PLI.item[j].valor = I.item[i].valor;
-      I_PLI.item[j].peso = I.item[i].peso;
-      I_PLI.item[j].index = I.item[i].index;
-      j++;
+    {
+      livres++; // item nao foi pego
+      continue;
+    }
+    for (j = 0; j < I.k; j++)
+    {
+      col = j * I.n + i + 1;
+      glp_set_col_bnds(lp, col, GLP_FX, x0[col], x0[col]);
     }
   }
 
-  I_PLI.n = j + 1; //Total de itens que ainda pode ser levado
-  I_PLI.k = I.k;   //Total de mochila
-  for (int i = 0; i < I.k; i++)
+  if (livres > 0)
   {
-    I_PLI.C[i] = I.C[i];
-  }
+    // a base otima da relaxacao continua dual viavel: o simplex dual so
+    // corrige as colunas fixadas
+    param_lp.meth = GLP_DUALP;
+    FASE_INICIO(info->crono, FASE_RELAXACAO);
+    glp_simplex(lp, &param_lp);
+    FASE_FIM(info->crono);
+
+    glp_init_iocp(&param_ilp);
+    param_ilp.msg_lev = GLP_MSG_OFF;
+    param_ilp.tm_lim = TEMPO_LIMITE;
+    param_ilp.cb_func = my_callback;
+    param_ilp.cb_info = info;
+    info->mip = lp;
+    info->x_inicial = x0;
+    FASE_INICIO(info->crono, FASE_BB);
+    if (glp_get_status(lp) == GLP_OPT)
+      glp_intopt(lp, &param_ilp);
+    FASE_FIM(info->crono);
+    info->x_inicial = NULL;
 
-  x2 = (double *)malloc(sizeof(double) * (I_PLI.n * I_PLI.k));
-  otimiza_PLI(I_PLI, 2, x2, &info);
-
-  for (int i = 0; i < I_PLI.n; i++)
-  {
-    for (int j = 0; j < I_PLI.k; j++)
+    for (i = 0; i < I.n; i++)
     {
-      if (x2[j * I_PLI.n + i] == 1.0) // item levado
+      if (I.item[i].index != 0)
+        continue;
+      // sem solucao do B&B (tempo esgotado antes da primeira), volta a
+      // solucao inicial
+      if (glp_mip_status(lp) != GLP_OPT && glp_mip_status(lp) != GLP_FEAS)
       {
-        I.item[I_PLI.item[i].num - 1].index = (j + 1);
-        break;
+        I.item[i].index = inicial[i];
+        continue;
+      }
+      for (j = 0; j < I.k; j++)
+      {
+        if (glp_mip_col_val(lp, j * I.n + i + 1) > 0.5) // item levado
+        {
+          I.item[i].index = (j + 1);
+          break;
+        }
       }
     }
   }
 
-  for (int i = 0; i < I.n; i++)
+  // a solucao final eh conferida com as capacidades originais; se o sub-MIP
+  // devolver uma solucao inviavel, fica a solucao inicial
+  J = I;
+  J.C = capacidade;
+  final = (int *)arena_aloca(A, sizeof(int) * I.n);
+  for (i = 0; i < I.n; i++)
+    final[i] = I.item[i].index;
+  if (!valida_solucao(J, final, &soma))
   {
-    if (I.item[i].index != 0)
-    {
-      soma += I.item[i].valor;
-    }
+    PRINTF("heuristica_melhorada: solucao inviavel, mantida a inicial\n");
+    for (i = 0; i < I.n; i++)
+      I.item[i].index = inicial[i];
+    valida_solucao(J, inicial, &soma);
   }
 
   // libera memoria alocada
-  free_instancia(I_PLI);
-  free(x2);
-  free(x);
+  glp_delete_prob(lp);
+  arena_volta(A, m);
   return soma;
 }
 
 /* heuristica a ser implementada */
-double heuristica(Tinstance I, int tipo, my_infoT *info)
+double heuristica(Tinstance I, int tipo, glp_rng *rng, my_infoT *info)
 {
   double z = 0.0;
 
   if (tipo == 3)
   {
-    z = guloso(I);
+    z = guloso(I, info->arena);
   }
   else if (tipo == 4)
   {
-    z = random_heuristica(I);
+    z = random_heuristica(I, rng, info->arena);
   }
   else
   {
-    z = heuristica_melhorada(I, &info, tipo);
+    z = heuristica_melhorada(I, info, tipo, rng);
   }
 
   return z;
 }
 
-void gerar_arquivo_sol(char *filename, int tipo, double z, Tinstance I)
+/* imprime a solucao em I.item[].index no formato .sol */
+void imprime_solucao(FILE *arquivo_saida, double z, Tinstance I)
 {
-  FILE *arquivo_saida;
-  char nomeArquivo[64];
   int soma;
-  char str[32];
-
-  sprintf(str, "-%d.sol", tipo);
-  strcpy(nomeArquivo, filename);
-  strcat(nomeArquivo, str);
-
-  arquivo_saida = fopen(nomeArquivo, "w");
 
   fprintf(arquivo_saida, "%.0lf %d\n", z, I.k);
 
@@ -690,25 +864,49 @@ void gerar_arquivo_sol(char *filename, int tipo, double z, Tinstance I)
     }
     fprintf(arquivo_saida, "\n");
   }
+}
+
+void gerar_arquivo_sol(char *filename, int tipo, double z, Tinstance I)
+{
+  FILE *arquivo_saida;
+  char nomeArquivo[FILENAME_MAX];
+  char str[32];
 
+  sprintf(str, "-%d.sol", tipo);
+  strcpy(nomeArquivo, filename);
+  strcat(nomeArquivo, str);
+
+  arquivo_saida = fopen(nomeArquivo, "w");
+  imprime_solucao(arquivo_saida, z, I);
   fclose(arquivo_saida);
 }
 
-void gerar_arquivo_out(char *filename, int tipo, double z, double tempo)
+void gerar_arquivo_out(char *filename, int tipo, double z, double ub, double tempo, Tcronometro *crono)
 {
   FILE *arquivo_saida;
-  char nomeArquivo[100];
+  char nomeArquivo[FILENAME_MAX];
   const char *gerador;
-  int status;
-  char UB[10];
+  int status = GLP_UNDEF;
+  char UB[32];
+  char nome[64], sufixo[16];
 
   const char *implementacao1 = "-1";
   const char *implementacao2 = "-2";
+  const char *implementacao3 = "-3";
+  const char *implementacao4 = "-4";
+  const char *implementacao5 = "-5";
+  const char *implementacao6 = "-6";
+  const char *implementacao7 = "-7";
 
   const char *heuristica1 = "-1";
   const char *heuristica2 = "-2";
   const char *heuristica3 = "-3";
   const char *heuristica4 = "-4";
+  const char *heuristica5 = "-5";
+  // tipos 10 a 14: heuristica construtiva + busca local
+  const char *busca_local[] = {"-6", "-7", "-8", "-9", "-10"};
+  const char *gerador_busca_local[] = {"10:gulosa + busca local", "11:aleatória + busca local", "12:gulosa melhorada + busca local", "13:aleatória melhorada + busca local", "14:multi-start aleatório + busca local"};
+  const char *heuristica11 = "-11";
 
   strcpy(nomeArquivo, filename);
 
@@ -721,6 +919,41 @@ void gerar_arquivo_out(char *filename, int tipo, double z, double tempo)
     else
       gerador = "2:branch-and-bound";
   }
+  else if (tipo == 7)
+  {
+    strcat(nomeArquivo, implementacao3);
+    strcat(nomeArquivo, "-0");
+    gerador = "7:branch-and-bound MTM";
+    status = (ub - z < 0.5) ? GLP_OPT : GLP_FEAS;
+  }
+  else if (tipo == 8)
+  {
+    strcat(nomeArquivo, implementacao4);
+    strcat(nomeArquivo, "-0");
+    gerador = "8:relaxacao lagrangiana";
+    status = (ub - z < 0.5) ? GLP_OPT : GLP_FEAS;
+  }
+  else if (tipo == TIPO_COLUNAS)
+  {
+    strcat(nomeArquivo, implementacao5);
+    strcat(nomeArquivo, "-0");
+    gerador = "16:geracao de colunas";
+    status = (ub - z < 0.5) ? GLP_OPT : GLP_FEAS;
+  }
+  else if (tipo == TIPO_PD)
+  {
+    strcat(nomeArquivo, implementacao6);
+    strcat(nomeArquivo, "-0");
+    gerador = "29:programacao dinamica";
+    status = (ub - z < 0.5) ? GLP_OPT : GLP_FEAS;
+  }
+  else if (tipo == TIPO_PORTFOLIO)
+  {
+    strcat(nomeArquivo, implementacao7);
+    strcat(nomeArquivo, "-0");
+    gerador = "30:portfolio";
+    status = (ub - z < 0.5) ? GLP_OPT : GLP_FEAS;
+  }
   else
   {
     strcat(nomeArquivo, implementacao2);
@@ -739,11 +972,34 @@ void gerar_arquivo_out(char *filename, int tipo, double z, double tempo)
       strcat(nomeArquivo, heuristica3);
       gerador = "5:gulosa melhorada";
     }
-    else
+    else if (tipo == 6)
     {
       strcat(nomeArquivo, heuristica4);
       gerador = "6:aleatória melhorada";
     }
+    else if (tipo == 9)
+    {
+      strcat(nomeArquivo, heuristica5);
+      gerador = "9:multi-start aleatório";
+    }
+    else if (tipo == TIPO_LNS)
+    {
+      strcat(nomeArquivo, heuristica11);
+      gerador = "15:LNS iterada";
+    }
+    else if (tipo >= TIPO_CONSTRUTIVA)
+    {
+      // tipos 17 a 28: heuristicas -12 a -23
+      sprintf(sufixo, "-%d", tipo - TIPO_CONSTRUTIVA + 12);
+      strcat(nomeArquivo, sufixo);
+      nome_construtiva(tipo, nome, sizeof(nome));
+      gerador = nome;
+    }
+    else
+    {
+      strcat(nomeArquivo, busca_local[tipo - TIPO_BUSCA_LOCAL]);
+      gerador = gerador_busca_local[tipo - TIPO_BUSCA_LOCAL];
+    }
     status = 10;
   }
 
@@ -753,80 +1009,558 @@ void gerar_arquivo_out(char *filename, int tipo, double z, double tempo)
 
   if (tipo < 3)
     sprintf(UB, "%.0lf", z);
+  else if (tipo == 7 || tipo == 8 || tipo == TIPO_COLUNAS || tipo == TIPO_PD || tipo == TIPO_PORTFOLIO)
+    sprintf(UB, "%.0lf", ub);
   else
     sprintf(UB, " ");
 
   fprintf(arquivo_saida, "%s;%s;%lf;%.0lf;%s;%d", filename, gerador, tempo, z, UB, status);
+  // tempo de cada fase (so com -f 1)
+  if (crono != NULL)
+    cronometro_imprime(arquivo_saida, crono);
 
   fclose(arquivo_saida);
 }
 
-/* programa principal */
-int main(int argc, char **argv)
+/* grava a trajetoria das melhorias (uma linha "tempo;valor" por melhoria) */
+void gerar_arquivo_trajetoria(char *filename, int tipo, Ttrajetoria *traj)
 {
-  double z, *x, tempo;
-  clock_t antes, agora;
-  int tipo;
-  Tinstance I;
-  my_infoT info;
+  FILE *arquivo_saida;
+  char nomeArquivo[FILENAME_MAX];
+  int i;
 
-  // checa linha de comando
-  if (argc < 3)
-  {
-    printf("\nSintaxe: mochila <instancia.txt> <tipo>\n\t<tipo>: 1 = relaxacao linear, 2 = solucao inteira\n");
-    exit(1);
-  }
+  sprintf(nomeArquivo, "%s-%d.traj", filename, tipo);
+  arquivo_saida = fopen(nomeArquivo, "w");
+  if (arquivo_saida == NULL)
+    return;
+  for (i = 0; i < traj->n; i++)
+    fprintf(arquivo_saida, "%lf;%.0lf\n", traj->tempo[i], traj->z[i]);
+  fclose(arquivo_saida);
+}
 
-  // ler a entrada
-  if (!carga_instancia(argv[1], &I))
+/* acrescenta uma melhoria (instante em segundos, valor) a trajetoria */
+void registra_melhoria(Ttrajetoria *traj, double tempo, double z)
+{
+  if (traj->n == traj->cap)
   {
-    printf("\nProblema na carga da instância: %s", argv[1]);
-    exit(1);
+    traj->cap = 2 * traj->cap + 16;
+    traj->tempo = (double *)realloc(traj->tempo, sizeof(double) * traj->cap);
+    traj->z = (double *)realloc(traj->z, sizeof(double) * traj->cap);
   }
+  traj->tempo[traj->n] = tempo;
+  traj->z[traj->n] = z;
+  traj->n++;
+}
 
-  tipo = atoi(argv[2]);
-  if (tipo < 1 || tipo > 6)
-  {
-    printf("Tipo invalido\nUse: tipo=1 (relaxacao linear), 2 (solucao inteira), 3 (heuristica gulosa), 4 (heuristica aleatoria), 5 (heuristica gulosa melhorada), 6 (heuristica aleatoria melhorada)\n");
-    exit(1);
-  }
+/* zera res para a execucao do metodo tipo sobre a instancia do arquivo
+   (NULL para as instancias recebidas pelo modo servico); a memoria de
+   trabalho do metodo sai da arena A, que eh da thread que chama */
+void inicia_resultado(char *arquivo, int tipo, Tparametros *par, Tarena *A, Tresultado *res)
+{
+  res->arquivo = arquivo;
+  res->tipo = tipo;
+  res->ok = 0;
+  res->semente = 0;
+  res->n = 0;
+  res->k = 0;
+  res->z = 0.0;
+  res->tempo = 0.0;
+  res->dist.n = 0;
+  res->traj.n = 0;
+  res->traj.cap = 0;
+  res->traj.tempo = NULL;
+  res->traj.z = NULL;
+  res->memoria = 0;
 
   // inicializa info
-  info.best_dualBound = 0;
-  info.best_primalBound = 0;
-  info.gap = 0;
-  info.nodes = 0;
-  info.ativos = 0;
+  res->info.mip = NULL;
+  res->info.best_dualBound = 0;
+  res->info.best_primalBound = 0;
+  res->info.gap = 0;
+  res->info.nodes = 0;
+  res->info.ativos = 0;
+  res->info.limite_lagrangiano = DBL_MAX;
+  res->info.limite_bb = TEMPO_LIMITE;
+  res->info.x_inicial = NULL;
+  res->info.heur_no = NULL;
+  res->info.cortes = NULL;
+  res->info.telemetria = NULL;
+  res->info.portfolio = NULL;
+  res->info.arena = A;
+  memset(&res->red, 0, sizeof(Treducao));
+
+  // cronometro das fases (-f 1)
+  res->fases = par->fases;
+  cronometro_zera(&res->crono);
+  res->info.crono = par->fases ? &res->crono : NULL;
+}
 
-  antes = clock();
+/* executa o metodo tipo sobre a instancia I ja carregada (res preparado por
+   inicia_resultado); a solucao fica em I.item[].index, exceto no tipo 1. Nao
+   grava arquivos de saida, o que fica com quem chama */
+void resolve_instancia(Tinstance I, int tipo, Tparametros *par, Tresultado *res)
+{
+  double *x, *x0, z0, antes, agora;
+  glp_rng *rng;
+  unsigned semente;
+  int base, i, j, *capacidade, *index;
+  char *arquivo = res->arquivo;
+  // heuristica construtiva de cada tipo com busca local
+  static const int heuristica_base[] = {3, 4, 5, 6, 9};
+
+  res->n = I.n;
+  res->k = I.k;
+  // arena vazia, com o bloco do tamanho estimado para (n, k)
+  arena_prepara(res->info.arena, I.n, I.k);
+
+  // sem semente na linha de comando, os metodos aleatorios usam o relogio
+  semente = par->semente ? par->semente : (unsigned)time(NULL);
+  res->semente = semente;
+
+  // o tempo eh medido pelo relogio monotonico (e nao por clock()), pois no
+  // modo em lote varias instancias sao resolvidas ao mesmo tempo no mesmo
+  // processo
+  antes = glp_mono_time();
+  if (par->amostragem > 0 && par->grava_saida)
+    res->info.telemetria = telemetria_abre(arquivo, tipo, par->amostragem);
   if (tipo < 3)
   {
     // aloca memoria para a solucao
-    x = (double *)malloc(sizeof(double) * (I.n * I.k));
-    z = otimiza_PLI(I, tipo, x, &info);
-    free(x);
+    x = (double *)arena_aloca(res->info.arena, sizeof(double) * (I.n * I.k));
+    x0 = NULL;
+    if (tipo == 2 && par->solucao != NULL)
+    {
+      // solucao inicial lida de um arquivo .sol (-w), injetada pela callback
+      FASE_INICIO(res->info.crono, FASE_LEITURA);
+      index = (int *)arena_aloca(res->info.arena, sizeof(int) * I.n);
+      if (strcmp(par->solucao, "1") == 0)
+        z0 = melhor_arquivo_sol(arquivo, I, index);
+      else
+        z0 = le_arquivo_sol(par->solucao, I, index);
+      if (z0 >= 0.0)
+      {
+        x0 = (double *)arena_aloca_zerada(res->info.arena, sizeof(double) * (I.n * I.k + 1));
+        for (i = 0; i < I.n; i++)
+          if (index[i] != 0)
+            x0[(index[i] - 1) * I.n + i + 1] = 1.0;
+        res->info.x_inicial = x0;
+        PRINTF("solucao inicial: z=%.0lf\n", z0);
+      }
+      FASE_FIM(res->info.crono);
+    }
+    if (tipo == 2 && par->lagrangiano)
+    {
+      FASE_INICIO(res->info.crono, FASE_RELAXACAO);
+      limite_lagrangiano_bb(I, par, &res->info);
+      FASE_FIM(res->info.crono);
+    }
+    res->z = otimiza_PLI(I, tipo, par, x, &res->info, &res->red);
+    res->info.x_inicial = NULL;
+    if (tipo == 2)
+      for (i = 0; i < I.n; i++)
+      {
+        I.item[i].index = 0;
+        for (j = 0; j < I.k; j++)
+          if (x[j * I.n + i] > 0.5)
+            I.item[i].index = j + 1;
+      }
+  }
+  else if (tipo == 7)
+  {
+    // branch-and-bound especifico para a mochila multipla
+    FASE_INICIO(res->info.crono, FASE_BB);
+    res->z = bb_mkp(I, par->limite, &res->info);
+    FASE_FIM(res->info.crono);
+  }
+  else if (tipo == 8)
+  {
+    // relaxacao lagrangiana com heuristica lagrangiana
+    FASE_INICIO(res->info.crono, FASE_RELAXACAO);
+    res->z = lagrangiana(I, par->nthreads, par->limite, &res->info);
+    FASE_FIM(res->info.crono);
+  }
+  else if (tipo == 9)
+  {
+    // multi-start da heuristica aleatoria em paralelo
+    FASE_INICIO(res->info.crono, FASE_HEURISTICA);
+    res->z = multi_start(I, par, semente, &res->info, &res->dist);
+    FASE_FIM(res->info.crono);
+  }
+  else if (tipo == TIPO_LNS)
+  {
+    // destroy/repair iterado ate o tempo limite
+    rng = glp_rng_create((int)(semente & 0x7FFFFFFF));
+    FASE_INICIO(res->info.crono, FASE_HEURISTICA);
+    res->z = lns(I, par, rng, &res->info, &res->traj);
+    FASE_FIM(res->info.crono);
+    glp_rng_delete(rng);
+  }
+  else if (tipo == TIPO_COLUNAS)
+  {
+    // geracao de colunas seguida do B&B sobre as colunas geradas
+    FASE_INICIO(res->info.crono, FASE_RELAXACAO);
+    res->z = geracao_colunas(I, par, &res->info);
+    FASE_FIM(res->info.crono);
+  }
+  else if (tipo == TIPO_PD)
+  {
+    // programacao dinamica sobre as capacidades residuais (bb_mkp se a
+    // memoria ou o tempo acabarem)
+    FASE_INICIO(res->info.crono, FASE_BB);
+    res->z = pd_mkp(I, par->limite, &res->info);
+    FASE_FIM(res->info.crono);
+  }
+  else if (tipo == TIPO_PORTFOLIO)
+  {
+    // construtivas, LNS e B&B em paralelo com a incumbente compartilhada
+    FASE_INICIO(res->info.crono, FASE_HEURISTICA);
+    res->z = portfolio(I, par, semente, &res->info, &res->traj);
+    FASE_FIM(res->info.crono);
+  }
+  else if (tipo >= TIPO_CONSTRUTIVA)
+  {
+    // heuristica construtiva: ordem dos itens e encaixe nas mochilas
+    FASE_INICIO(res->info.crono, FASE_HEURISTICA);
+    res->z = construtiva(I, (tipo - TIPO_CONSTRUTIVA) / ENCAIXES, (tipo - TIPO_CONSTRUTIVA) % ENCAIXES, res->info.arena);
+    FASE_FIM(res->info.crono);
+  }
+  else if (tipo >= TIPO_BUSCA_LOCAL)
+  {
+    // heuristica construtiva seguida da busca local; as heuristicas deixam as
+    // capacidades residuais em I.C, por isso as originais sao guardadas
+    base = heuristica_base[tipo - TIPO_BUSCA_LOCAL];
+    capacidade = (int *)arena_aloca(res->info.arena, sizeof(int) * I.k);
+    memcpy(capacidade, I.C, sizeof(int) * I.k);
+    rng = glp_rng_create((int)(semente & 0x7FFFFFFF));
+    FASE_INICIO(res->info.crono, FASE_HEURISTICA);
+    if (base == 9)
+      multi_start(I, par, semente, &res->info, &res->dist);
+    else
+      heuristica(I, base, rng, &res->info);
+    FASE_FIM(res->info.crono);
+    glp_rng_delete(rng);
+    memcpy(I.C, capacidade, sizeof(int) * I.k);
+    res->z = busca_local(I, par->limite, &res->info);
   }
   else
   {
     // heuristica
-    z = heuristica(I, tipo, &info);
+    rng = glp_rng_create((int)(semente & 0x7FFFFFFF));
+    FASE_INICIO(res->info.crono, FASE_HEURISTICA);
+    res->z = heuristica(I, tipo, rng, &res->info);
+    FASE_FIM(res->info.crono);
+    glp_rng_delete(rng);
+  }
+  agora = glp_mono_time();
+  res->tempo = glp_difftime(agora, antes);
+  if (res->info.telemetria != NULL)
+  {
+    telemetria_fecha(res->info.telemetria, &res->info);
+    res->info.telemetria = NULL;
   }
-  agora = clock();
 
-  PRINTF("Valor da solucao: %lf\tTempo gasto=%lf\n", z, ((double)agora - antes) / CLOCKS_PER_SEC);
+  res->memoria = res->info.arena->pico;
 
-  printf("%s;%d;%d;%d;%.0lf;%lf;%lf,%.3lf;%d;%d;%lf\n", argv[1], tipo, I.n, I.k, z, info.best_dualBound, info.best_primalBound, 100 * info.gap, info.nodes, info.ativos, ((double)agora - antes) / CLOCKS_PER_SEC);
+  PRINTF("Valor da solucao: %lf\tTempo gasto=%lf\n", res->z, res->tempo);
+  res->ok = 1;
+}
+
+/* executa o metodo tipo sobre a instancia do arquivo e preenche res
+   (usada tanto pelo programa principal quanto pelo modo em lote) */
+int executa_metodo(char *arquivo, int tipo, Tparametros *par, Tarena *A, Tresultado *res)
+{
+  Tinstance I;
+
+  inicia_resultado(arquivo, tipo, par, A, res);
+
+  // ler a entrada
+  FASE_INICIO(res->info.crono, FASE_LEITURA);
+  if (!carga_instancia(arquivo, &I))
+  {
+    FASE_FIM(res->info.crono);
+    return 0;
+  }
+  FASE_FIM(res->info.crono);
 
-  tempo = ((double)agora - antes) / CLOCKS_PER_SEC;
+  resolve_instancia(I, tipo, par, res);
 
-  if (tipo > 2)
+  if (tipo > 2 && par->grava_saida)
   {
-    gerar_arquivo_sol(argv[1], tipo, z, I);
-    gerar_arquivo_out(argv[1], tipo, z, tempo);
+    FASE_INICIO(res->info.crono, FASE_SAIDA);
+    gerar_arquivo_sol(arquivo, tipo, res->z, I);
+    if (res->traj.n > 0)
+      gerar_arquivo_trajetoria(arquivo, tipo, &res->traj);
+    FASE_FIM(res->info.crono);
+    gerar_arquivo_out(arquivo, tipo, res->z, res->info.best_dualBound, res->tempo, res->info.crono);
   }
+  free(res->traj.tempo);
+  free(res->traj.z);
+  res->traj.tempo = res->traj.z = NULL;
 
   // libera memoria alocada
   free_instancia(I);
+  return 1;
+}
+
+/* imprime a linha de resultado (formato csv separado por ';') */
+void imprime_resultado(FILE *saida, Tresultado *res)
+{
+  fprintf(saida, "%s;%d;%d;%d;%.0lf;%lf;%lf,%.3lf;%d;%d;%lf", res->arquivo, res->tipo, res->n, res->k, res->z, res->info.best_dualBound, res->info.best_primalBound, 100 * res->info.gap, res->info.nodes, res->info.ativos, res->tempo);
+  // tempo de cada fase (so com -f 1)
+  if (res->fases)
+    cronometro_imprime(saida, &res->crono);
+  fprintf(saida, "\n");
+}
+
+/* imprime a distribuicao dos valores do multi-start */
+void imprime_distribuicao(FILE *saida, Tresultado *res)
+{
+  if (res->dist.n == 0)
+    return;
+  fprintf(saida, "%s: construcoes=%d min=%.0lf q1=%.0lf mediana=%.0lf q3=%.0lf max=%.0lf media=%.2lf desvio=%.2lf\n", res->arquivo, res->dist.n, res->dist.min, res->dist.q1, res->dist.mediana, res->dist.q3, res->dist.max, res->dist.media, res->dist.desvio);
+}
+
+/* imprime as reducoes do preprocessamento (tipo 2 com -p 1) */
+void imprime_reducao(FILE *saida, Tresultado *res)
+{
+  if (!res->red.feito)
+    return;
+  fprintf(saida, "%s: preprocessamento lb=%.0lf itens eliminados=%d colunas eliminadas=%d de %d (restam %d) fixadas em 1=%d restricoes eliminadas=%d reducao das capacidades=%lld\n", res->arquivo, res->red.lb, res->red.itens, res->red.colunas, res->n * res->k, res->red.restantes, res->red.fixadas, res->red.linhas, res->red.capacidade);
+}
+
+/* imprime o pico da memoria de trabalho do metodo (ver arena.c) */
+void imprime_memoria(FILE *saida, Tresultado *res)
+{
+  fprintf(saida, "%s: memoria de trabalho: pico=%zu bytes\n", res->arquivo, res->memoria);
+}
+
+/* valores padrao dos parametros dos metodos */
+void parametros_padrao(Tparametros *par)
+{
+  par->nthreads = 0;
+  par->semente = 0;
+  par->repeticoes = 0;
+  par->limite = TEMPO_LIMITE;
+  par->fases = 0;
+  par->simetria = 0;
+  par->execucoes = 1;
+  par->preprocessa = 0;
+  par->solucao = NULL;
+  par->heur_no = 0;
+  par->cortes = 0;
+  par->lagrangiano = 0;
+  par->amostragem = 0.0;
+  par->grava_modelo = 1;
+  par->grava_saida = 1;
+}
+
+/* le a opcao argv[*i] (e o seu valor); devolve 0 se a opcao for invalida */
+int le_opcao(int argc, char **argv, int *i, Tparametros *par)
+{
+  char *op = argv[*i];
+
+  if (*i + 1 >= argc || op[0] != '-' || op[1] == '\0' || op[2] != '\0')
+    return 0;
+  (*i)++;
+  switch (op[1])
+  {
+  case 's':
+    par->semente = (unsigned)strtoul(argv[*i], NULL, 10);
+    break;
+  case 't':
+    par->nthreads = atoi(argv[*i]);
+    break;
+  case 'r':
+    par->repeticoes = atoi(argv[*i]);
+    break;
+  case 'l':
+    par->limite = atof(argv[*i]);
+    break;
+  case 'f':
+    par->fases = atoi(argv[*i]);
+    break;
+  case 'e':
+    par->simetria = atoi(argv[*i]);
+    break;
+  case 'p':
+    par->preprocessa = atoi(argv[*i]);
+    break;
+  case 'h':
+    par->heur_no = atoi(argv[*i]);
+    if (par->heur_no < 0)
+      return 0;
+    break;
+  case 'm':
+    par->amostragem = atof(argv[*i]);
+    if (par->amostragem < 0)
+      return 0;
+    break;
+  case 'c':
+    par->cortes = atoi(argv[*i]);
+    break;
+  case 'g':
+    par->lagrangiano = atoi(argv[*i]);
+    break;
+  case 'w':
+    par->solucao = argv[*i];
+    break;
+  case 'x':
+    par->execucoes = atoi(argv[*i]);
+    if (par->execucoes < 1)
+      return 0;
+    break;
+  default:
+    return 0;
+  }
+  return 1;
+}
+
+/* programa principal */
+int main(int argc, char **argv)
+{
+  int tipo, nthreads, i;
+  char *saida;
+  Tresultado res;
+  Tparametros par;
+  Tarena arena;
+
+  parametros_padrao(&par);
+
+  // modo em lote: resolve todas as instancias de um diretorio (ou manifesto)
+  if (argc >= 4 && strcmp(argv[1], "-lote") == 0)
+  {
+    nthreads = 0;
+    saida = NULL;
+    for (i = 4; i < argc; i++)
+    {
+      if (argv[i][0] == '-')
+      {
+        if (!le_opcao(argc, argv, &i, &par))
+        {
+          printf("Opcao invalida: %s\n", argv[i]);
+          exit(1);
+        }
+      }
+      else if (i == 4)
+        nthreads = atoi(argv[i]);
+      else
+        saida = argv[i];
+    }
+    if (!executa_lote(argv[2], argv[3], nthreads, saida, &par))
+      exit(1);
+    return 0;
+  }
+
+  // modo de experimento: tabelas dos relatorios (T1, T2 e T3) por familia
+  if (argc >= 4 && strcmp(argv[1], "-experimento") == 0)
+  {
+    nthreads = 1;
+    saida = NULL;
+    for (i = 4; i < argc; i++)
+    {
+      if (argv[i][0] == '-')
+      {
+        if (!le_opcao(argc, argv, &i, &par))
+        {
+          printf("Opcao invalida: %s\n", argv[i]);
+          exit(1);
+        }
+      }
+      else if (i == 4)
+        nthreads = atoi(argv[i]);
+      else
+        saida = argv[i];
+    }
+    if (!executa_experimento(argv[2], argv[3], nthreads, saida, &par))
+      exit(1);
+    return 0;
+  }
+
+  // modo servico: resolve as instancias recebidas pela entrada padrao ou por
+  // um socket local ate o pedido "fim"
+  if (argc >= 3 && strcmp(argv[1], "-servico") == 0)
+  {
+    nthreads = 0;
+    for (i = 3; i < argc; i++)
+    {
+      if (argv[i][0] == '-')
+      {
+        if (!le_opcao(argc, argv, &i, &par))
+        {
+          printf("Opcao invalida: %s\n", argv[i]);
+          exit(1);
+        }
+      }
+      else
+        nthreads = atoi(argv[i]);
+    }
+    if (!executa_servico(argv[2], nthreads, &par))
+      exit(1);
+    return 0;
+  }
+
+  // converte uma instancia para o formato binario .mkpb
+  if (argc >= 4 && strcmp(argv[1], "-converte") == 0)
+  {
+    if (!converte_instancia(argv[2], argv[3]))
+      exit(1);
+    return 0;
+  }
+
+  // gera uma instancia: classe 1 a 5, capacidades s(emelhantes) ou d(iferentes)
+  if (argc >= 9 && strcmp(argv[1], "-gera") == 0)
+  {
+    if (strcmp(argv[6], "s") != 0 && strcmp(argv[6], "d") != 0)
+    {
+      printf("Capacidades invalidas: %s (use s ou d)\n", argv[6]);
+      exit(1);
+    }
+    if (!gera_arquivo(argv[8], atoi(argv[2]), atoi(argv[3]), atoi(argv[4]), atoi(argv[5]), argv[6][0] == 's', (unsigned)strtoul(argv[7], NULL, 10)))
+      exit(1);
+    return 0;
+  }
+
+  // checa linha de comando
+  if (argc < 3)
+  {
+    printf("\nSintaxe: mochila <instancia.txt> <tipo>\n\t<tipo>: 1 = relaxacao linear, 2 = solucao inteira\n");
+    printf("\tmochila -converte <instancia.mochila> <instancia.mkpb>\n");
+    printf("\tmochila -gera <n> <k> <R> <classe> <s|d> <semente> <instancia.mochila|instancia.mkpb>\n\t<classe>: 1 = nao correlacionada, 2 = fracamente, 3 = fortemente, 4 = inversamente correlacionada, 5 = soma de subconjuntos\n");
+    printf("\tmochila -lote <diretorio|manifesto> <tipos> [threads] [saida.csv] [opcoes]\n\t<tipos>: lista de tipos, ex.: 1,2,3 ou 1-6\n");
+    printf("\tmochila -experimento <diretorio|manifesto> <tipos> [threads] [prefixo] [opcoes]\n");
+    printf("\tmochila -servico <socket | - = entrada padrao> [threads] [opcoes]\n\t<pedido>: linha \"<tipo> <limite em ms> <bytes>\" seguida da instancia (.mochila ou .mkpb); \"fim\" encerra\n");
+    printf("\t[opcoes]: -s <semente> -t <threads por metodo> -r <construcoes do multi-start> -l <tempo limite em ms> -f <1 = tempo de cada fase> -e <quebra de simetria das mochilas iguais (tipos 1 e 2): 1 = pela carga, 2 = pelos itens mais pesados> -x <execucoes de cada par no modo de experimento> -p <1 = preprocessamento do modelo antes do B&B (tipo 2)> -w <arquivo.sol | 1 = melhor .sol da instancia: solucao inicial do B&B (tipo 2)> -h <freq: heuristica primal a cada freq nos do B&B (tipo 2)> -c <1 = desigualdades de cobertura no B&B (tipo 2)> -g <1 = limitante lagrangiano na callback do B&B (tipo 2)> -m <ms entre as amostras do B&B gravadas em <instancia>-<tipo>.bb>\n");
+    exit(1);
+  }
+
+  tipo = atoi(argv[2]);
+  if (tipo < 1 || tipo > TIPO_MAX)
+  {
+    printf("Tipo invalido\nUse: tipo=1 (relaxacao linear), 2 (solucao inteira), 3 (heuristica gulosa), 4 (heuristica aleatoria), 5 (heuristica gulosa melhorada), 6 (heuristica aleatoria melhorada), 7 (branch-and-bound MTM), 8 (relaxacao lagrangiana), 9 (multi-start aleatorio), 10 a 14 (tipos 3, 4, 5, 6 e 9 seguidos de busca local), 15 (LNS iterada), 16 (geracao de colunas), 17 a 28 (construtivas: ordem por valor, valor/peso, peso ou relaxacao, cada uma com encaixe na primeira, na melhor ou na pior mochila), 29 (programacao dinamica exata para capacidades pequenas), 30 (portfolio: construtivas, LNS e B&B em paralelo)\n");
+    exit(1);
+  }
+
+  for (i = 3; i < argc; i++)
+  {
+    if (!le_opcao(argc, argv, &i, &par))
+    {
+      printf("Opcao invalida: %s\n", argv[i]);
+      exit(1);
+    }
+  }
+
+  arena_cria(&arena);
+  if (!executa_metodo(argv[1], tipo, &par, &arena, &res))
+  {
+    printf("\nProblema na carga da instância: %s", argv[1]);
+    exit(1);
+  }
+  arena_libera(&arena);
+
+  imprime_resultado(stdout, &res);
+  imprime_distribuicao(stdout, &res);
+  imprime_reducao(stdout, &res);
+  imprime_memoria(stderr, &res);
 
   return 0;
 }
@@ -0,0 +1,469 @@
+/* mochila_multipla.h
+definicoes compartilhadas pelos modulos do programa mochila_multipla
+(estruturas da instancia, informacoes do B&B e prototipos)
+*/
+
+#ifndef MOCHILA_MULTIPLA_H
+#define MOCHILA_MULTIPLA_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <glpk.h>
+
+#define EPSILON 0.000001
+
+#define TIPO_MAX 30 /* maior tipo (metodo) valido */
+#define TIPO_BUSCA_LOCAL 10 /* tipos 10 a 14: heuristica construtiva + busca local */
+#define TIPO_LNS 15 /* LNS iterada */
+#define TIPO_COLUNAS 16 /* geracao de colunas */
+#define TIPO_CONSTRUTIVA 17 /* tipos 17 a 28: ordem (valor, valor/peso, peso, relaxacao) x encaixe (primeira, melhor, pior) */
+#define TIPO_PD 29 /* programacao dinamica exata (capacidades pequenas) */
+#define TIPO_PORTFOLIO 30 /* construtivas, LNS e B&B em paralelo */
+
+// ordens dos itens e encaixes das heuristicas construtivas (construtiva.c)
+enum
+{
+  ORDEM_VALOR,
+  ORDEM_RAZAO,
+  ORDEM_PESO,
+  ORDEM_RELAXACAO,
+  ORDENS
+};
+enum
+{
+  ENCAIXE_PRIMEIRA,
+  ENCAIXE_MELHOR,
+  ENCAIXE_PIOR,
+  ENCAIXES,
+  ENCAIXE_ULTIMA = ENCAIXES /* so para o repair_rins */
+};
+
+#define TEMPO_LIMITE 1000 /* tempo limite dos metodos exatos (em ms) */
+#define PRE_FRACAO_INICIAL 0.02 /* fracao de TEMPO_LIMITE para a solucao heuristica do preprocessamento */
+
+#ifdef DEBUG
+#define PRINTF(...) printf(__VA_ARGS__)
+#else
+#define PRINTF(...)
+#endif
+
+typedef struct
+{
+  int num;      /* numero do item */
+  double valor; /* valor do item */
+  int peso;     /* peso do item */
+  int index;    /* mochila ao qual o item pertence */
+} Titem;
+
+typedef struct
+{
+  int n;       /* total de itens */
+  Titem *item; /* conjunto dos itens */
+  int k;       /* total de mochilas */
+  int *C;      /* capacidade das mochilas */
+  void *mapa;      /* arquivo .mkpb mapeado em memoria (NULL se lido do texto) */
+  size_t tam_mapa; /* tamanho do mapeamento */
+} Tinstance;
+
+// cabecalho do formato binario .mkpb (ver instancia.c)
+#define MKPB_MAGICO "MKPB"
+#define MKPB_VERSAO 1
+typedef struct
+{
+  char magico[4];
+  int32_t versao;
+  int32_t n;
+  int32_t k;
+} Tmkpb;
+
+/* tamanho em bytes de um arquivo .mkpb com n itens e k mochilas */
+#define MKPB_TAMANHO(n, k) (sizeof(Tmkpb) + (size_t)(n) * sizeof(double) + ((size_t)(k) + (n)) * sizeof(int32_t))
+
+// chave de ordenacao de um item ou mochila (as funcoes de comparacao nao usam
+// variaveis globais, pois o modo em lote executa varios metodos ao mesmo tempo)
+typedef struct
+{
+  double chave;
+  int i;
+} Tchave;
+
+// memoria de trabalho das heuristicas e da carga dos modelos (ver arena.c)
+typedef struct Tbloco Tbloco;
+typedef struct
+{
+  Tbloco *primeiro; /* blocos encadeados (o primeiro vem de arena_prepara) */
+  Tbloco *atual;    /* bloco das proximas alocacoes */
+  size_t usado;     /* bytes usados no bloco atual */
+  size_t em_uso;    /* bytes em uso em todos os blocos */
+  size_t pico;      /* maior em_uso desde arena_prepara */
+  size_t reservada; /* bytes alocados nos blocos */
+} Tarena;
+
+// posicao da arena, para devolver o que foi alocado depois dela
+typedef struct
+{
+  Tbloco *bloco;
+  size_t usado, em_uso;
+} Tmarca;
+
+// itens guardados como vetores separados (SoA, ver vetores.c): a posicao i
+// corresponde ao item I.item[i]
+typedef struct
+{
+  int n;         /* total de itens */
+  double *valor; /* valor de cada item */
+  int *peso;     /* peso de cada item */
+  int *index;    /* mochila de cada item (0 = fora das mochilas) */
+  double *razao; /* valor / peso de cada item */
+  int *ordem;    /* permutacao das posicoes dos itens */
+} Tsoa;
+
+// capacidades residuais das mochilas em arvores (ver construtiva.c)
+typedef struct
+{
+  int k;      /* total de mochilas */
+  int *C;     /* capacidades residuais (alteradas pelas escolhas) */
+  int folhas; /* folhas da arvore de segmentos (potencia de 2 >= k) */
+  int *arv;   /* arvore de segmentos: maior residuo de cada intervalo */
+  int raiz;   /* treap por (residuo, indice), so no best-fit */
+  int *esq, *dir, *prio;
+} Tcapacidades;
+
+// estrutura usada pela callback para salvar informações do B&B
+// fases da execucao medidas pelo cronometro (ver cronometro.c)
+enum
+{
+  FASE_LEITURA,    /* carga da instancia */
+  FASE_MODELO,     /* montagem do modelo do GLPK */
+  FASE_RELAXACAO,  /* simplex e relaxacao lagrangiana */
+  FASE_BB,         /* branch-and-bound (GLPK, MTM e sub-MIPs) */
+  FASE_HEURISTICA, /* heuristicas construtivas, multi-start e LNS */
+  FASE_BUSCA,      /* busca local */
+  FASE_SAIDA,      /* gravacao dos arquivos de saida */
+  FASES
+};
+
+#define CRONOMETRO_PILHA 8 /* fases aninhadas */
+
+typedef struct
+{
+  double parede[FASES]; /* tempo de relogio de cada fase (em segundos) */
+  double cpu[FASES];    /* tempo de CPU de cada fase (em segundos) */
+  int pilha[CRONOMETRO_PILHA]; /* fases abertas */
+  int topo;
+  double marca_parede, marca_cpu; /* instante da ultima troca de fase */
+} Tcronometro;
+
+// abre/fecha uma fase; c == NULL (cronometro desligado) nao custa nada
+#define FASE_INICIO(c, f)          \
+  do                               \
+  {                                \
+    if ((c) != NULL)               \
+      cronometro_inicia((c), (f)); \
+  } while (0)
+#define FASE_FIM(c)           \
+  do                          \
+  {                           \
+    if ((c) != NULL)          \
+      cronometro_para((c));   \
+  } while (0)
+
+// heuristica primal nos nos do B&B (ver heuristica_no.c)
+typedef struct
+{
+  Tinstance I;
+  int m;           /* colunas do modelo */
+  const int *col;  /* variavel x_ij (j*n + i) de cada coluna (NULL = modelo completo) */
+  int *coluna;     /* coluna de cada x_ij (0 = fora do modelo) */
+  int freq;        /* a heuristica roda a cada freq nos */
+  double inicio;   /* inicio do B&B */
+  double tempo;    /* tempo gasto na heuristica (em segundos) */
+  int nos, chamadas, melhorias;
+  int *index;      /* mochila de cada item na solucao construida */
+  int *res;        /* capacidades residuais */
+  double *maior;   /* maior x_ij fracionario de cada item */
+  double *x;       /* solucao nas colunas do modelo (1..m) */
+  Tchave *chaves;
+} Theur_no;
+
+// separacao de desigualdades de cobertura no B&B (ver cortes.c)
+typedef struct
+{
+  Tinstance I;
+  int m;           /* colunas do modelo */
+  int *coluna;     /* coluna de cada x_ij (0 = fora do modelo) */
+  long long *C;    /* capacidade de cada mochila (linhas 1..k do modelo) */
+  int *classe;     /* primeira mochila com a mesma capacidade */
+  int no, rodadas; /* no corrente e rodadas de separacao nele */
+  int cortes;      /* cortes acrescentados */
+  int agregados;   /* dos quais das classes de mochilas iguais */
+  int *item;       /* coluna (ou item) de cada posicao da mochila separada */
+  int *peso;
+  double *ys;      /* valor da relaxacao de cada posicao */
+  int *alfa;       /* coeficientes do corte */
+  int *na;         /* pesos da cobertura em ordem decrescente */
+  long long *mu;   /* somas dos h maiores pesos da cobertura */
+  Tchave *chaves;
+  int *ind;        /* corte no formato de glp_ios_add_row */
+  double *val;
+} Tcortes;
+
+// amostras do B&B gravadas em segundo plano (ver telemetria.c)
+typedef struct Ttelemetria Ttelemetria;
+
+// participacao de um metodo no portfolio (ver portfolio.c)
+typedef struct Tportfolio Tportfolio;
+
+typedef struct
+{
+  glp_prob *mip;
+  int nodes;
+  int ativos;
+  double best_dualBound;
+  double best_primalBound;
+  double gap;
+  double limite_lagrangiano; /* limitante da relaxacao lagrangiana (DBL_MAX se nao calculado) */
+  double limite_bb;          /* tempo limite do B&B do GLPK (em ms) */
+  const double *x_inicial;   /* solucao viavel injetada no B&B (colunas 1..n*k) ou NULL */
+  Tcronometro *crono;        /* tempo de cada fase (NULL = desligado) */
+  Theur_no *heur_no;         /* heuristica primal nos nos (NULL = desligada) */
+  Tcortes *cortes;           /* separacao de coberturas (NULL = desligada) */
+  Ttelemetria *telemetria;   /* amostras do B&B (NULL = desligada) */
+  Tportfolio *portfolio;     /* incumbente compartilhada do tipo 30 (NULL = fora do portfolio) */
+  Tarena *arena;             /* memoria de trabalho das heuristicas e dos modelos */
+} my_infoT;
+
+// parametros dos metodos, lidos da linha de comando
+typedef struct
+{
+  int nthreads;     /* threads de cada metodo (0 = todos os nucleos) */
+  unsigned semente; /* semente dos metodos aleatorios (0 = relogio) */
+  int repeticoes;   /* construcoes do multi-start (0 = ate o tempo limite) */
+  double limite;    /* tempo limite (em ms) dos metodos 7 a 16 */
+  int fases;        /* 1 = mede o tempo de cada fase */
+  int simetria;     /* ordem das mochilas de mesma capacidade (tipos 1 e 2): 0 = nenhuma, 1 = carga, 2 = menor item */
+  int execucoes;    /* execucoes de cada par (instancia, tipo) no modo de experimento */
+  int preprocessa;  /* 1 = reduz o modelo F1 antes do B&B (tipo 2) */
+  char *solucao;    /* arquivo .sol da solucao inicial do tipo 2 ("1" = a melhor ao lado da instancia) ou NULL */
+  int heur_no;      /* heuristica primal a cada heur_no nos do B&B do tipo 2 (0 = desligada) */
+  int cortes;       /* 1 = desigualdades de cobertura no B&B do tipo 2 */
+  int lagrangiano;  /* 1 = limitante lagrangiano na callback do B&B do tipo 2 */
+  double amostragem; /* intervalo (em ms) entre as amostras do B&B gravadas em .bb (0 = nenhuma) */
+  int grava_modelo; /* 1 = grava mochila.lp e mochila.sol na versao DEBUG (0 no lote e no servico) */
+  int grava_saida;  /* 1 = grava os arquivos .sol, .out, .traj e .bb da instancia (0 nas repeticoes do experimento) */
+} Tparametros;
+
+// reducoes feitas pelo preprocessamento do modelo F1 (ver preprocessamento.c)
+typedef struct
+{
+  int feito;            /* 1 se o preprocessamento foi executado */
+  int itens;            /* itens eliminados (nao cabem ou sao dominados) */
+  int colunas;          /* colunas eliminadas (de n*k) */
+  int linhas;           /* restricoes de unicidade eliminadas (itens com ate 1 coluna) */
+  int fixadas;          /* colunas fixadas em 1 pelo custo reduzido */
+  long long capacidade; /* soma das reducoes das capacidades */
+  int restantes;        /* colunas do modelo reduzido */
+  double lb;            /* valor da solucao heuristica usada na fixacao */
+} Treducao;
+
+// modelo F1 reduzido: as colunas vivas e a solucao heuristica
+typedef struct
+{
+  Treducao red;
+  int n, k;
+  int *C;        /* capacidades reduzidas */
+  int *vivo;     /* 1 se o item continua no modelo */
+  int m;         /* colunas do modelo */
+  int *col;      /* col[c]: variavel x_ij (j*n + i) da coluna c do modelo (1..m) */
+  double *x_inc; /* solucao heuristica (n*k) */
+  double z_inc;  /* valor da solucao heuristica */
+  int inteiro;   /* 1 se todos os valores sao inteiros */
+} Tpreprocessamento;
+
+// distribuicao dos valores das construcoes do multi-start
+typedef struct
+{
+  int n; /* total de construcoes (0 se o metodo nao for multi-start) */
+  double min, q1, mediana, q3, max;
+  double media, desvio;
+} Tdistribuicao;
+
+// trajetoria das melhorias de um metodo: instante (em segundos) e valor de
+// cada nova melhor solucao
+typedef struct
+{
+  int n;         /* total de melhorias (0 se o metodo nao registra) */
+  int cap;       /* tamanho alocado */
+  double *tempo;
+  double *z;
+} Ttrajetoria;
+
+// resultado da execucao de um metodo (tipo) sobre uma instancia
+typedef struct
+{
+  char *arquivo; /* arquivo da instancia */
+  int tipo;      /* metodo executado */
+  int ok;        /* 0 se a instancia nao pode ser carregada */
+  unsigned semente; /* semente usada pelos metodos aleatorios */
+  int n;         /* total de itens */
+  int k;         /* total de mochilas */
+  double z;      /* valor da solucao */
+  my_infoT info; /* informacoes do B&B */
+  double tempo;  /* tempo gasto (em segundos) */
+  Tdistribuicao dist; /* distribuicao do multi-start */
+  Ttrajetoria traj;   /* melhorias ao longo do tempo (LNS) */
+  int fases;          /* 1 se crono foi medido */
+  Tcronometro crono;  /* tempo de cada fase */
+  Treducao red;       /* reducoes do preprocessamento (tipo 2 com -p 1) */
+  size_t memoria;     /* pico da memoria de trabalho (em bytes) */
+} Tresultado;
+
+/* mochila_multipla.c */
+void my_callback(glp_tree *tree, void *infop);
+int carga_lp(glp_prob **lp, Tinstance I, Tarena *A);
+int carga_simetria(glp_prob *lp, Tinstance I, int tipo, Tarena *A);
+int RandomInteger(glp_rng *rng, int low, int high);
+int comparador(const void *valor1, const void *valor2);
+int comparador_num(const void *num1, const void *num2);
+int comparador_chave(const void *a, const void *b);
+double guloso(Tinstance I, Tarena *A);
+double random_heuristica(Tinstance I, glp_rng *rng, Tarena *A);
+double heuristica_melhorada(Tinstance I, my_infoT *info, int tipo, glp_rng *rng);
+void troca(Titem *a, Titem *b);
+double heuristica(Tinstance I, int tipo, glp_rng *rng, my_infoT *info);
+double otimiza_PLI(Tinstance I, int tipo, Tparametros *par, double *x, my_infoT *info, Treducao *red);
+void limite_lagrangiano_bb(Tinstance I, Tparametros *par, my_infoT *info);
+void imprime_solucao(FILE *arquivo_saida, double z, Tinstance I);
+void gerar_arquivo_sol(char *filename, int tipo, double z, Tinstance I);
+void gerar_arquivo_out(char *filename, int tipo, double z, double ub, double tempo, Tcronometro *crono);
+void gerar_arquivo_trajetoria(char *filename, int tipo, Ttrajetoria *traj);
+void registra_melhoria(Ttrajetoria *traj, double tempo, double z);
+double destroy_rins(Tinstance I, double z, double xx, double *x);
+double repair_rins(Tinstance I, double z, double *x, Tarena *A);
+void inicia_resultado(char *arquivo, int tipo, Tparametros *par, Tarena *A, Tresultado *res);
+void resolve_instancia(Tinstance I, int tipo, Tparametros *par, Tresultado *res);
+int executa_metodo(char *arquivo, int tipo, Tparametros *par, Tarena *A, Tresultado *res);
+void imprime_resultado(FILE *saida, Tresultado *res);
+void imprime_distribuicao(FILE *saida, Tresultado *res);
+void imprime_reducao(FILE *saida, Tresultado *res);
+void imprime_memoria(FILE *saida, Tresultado *res);
+void parametros_padrao(Tparametros *par);
+int le_opcao(int argc, char **argv, int *i, Tparametros *par);
+
+/* instancia.c */
+int carga_instancia(char *filename, Tinstance *I);
+int carga_instancia_texto(const char *buf, size_t tam, Tinstance *I);
+int carga_instancia_mkpb(void *dados, size_t tam, Tinstance *I);
+int grava_instancia_mkpb(char *filename, Tinstance I);
+int grava_instancia_texto(char *filename, Tinstance I);
+int converte_instancia(char *entrada, char *saida);
+void free_instancia(Tinstance I);
+
+/* bb_mkp.c */
+double bb_mkp(Tinstance I, double limite, my_infoT *info);
+
+/* lagrangiana.c */
+double lagrangiana(Tinstance I, int nthreads, double limite, my_infoT *info);
+
+/* multistart.c */
+double multi_start(Tinstance I, Tparametros *par, unsigned semente, my_infoT *info, Tdistribuicao *dist);
+
+/* pd_mkp.c */
+double pd_mkp(Tinstance I, double limite, my_infoT *info);
+int bitset_piso(const uint64_t *b, int r);
+void bitset_desloca_ou(uint64_t *restrict dst, const uint64_t *restrict src, int palavras, int p);
+
+/* preprocessamento.c */
+void preprocessa(Tinstance I, double limite, my_infoT *info, Tpreprocessamento *P);
+int carga_lp_reduzido(glp_prob **lp, Tinstance I, Tpreprocessamento *P, Tarena *A);
+int fixa_custos_reduzidos(glp_prob *lp, Tpreprocessamento *P, Tarena *A);
+double *solucao_reduzida(Tpreprocessamento *P, glp_prob *lp, Tarena *A);
+
+/* busca_local.c */
+double busca_local(Tinstance I, double limite, my_infoT *info);
+
+/* lns.c */
+double lns(Tinstance I, Tparametros *par, glp_rng *rng, my_infoT *info, Ttrajetoria *traj);
+
+/* geracao_colunas.c */
+double geracao_colunas(Tinstance I, Tparametros *par, my_infoT *info);
+
+/* vetores.c */
+void soa_carrega(Tsoa *S, Tinstance I, Tarena *A);
+void soa_devolve(Tsoa *S, Tinstance I);
+void calcula_razao(const double *valor, const int *peso, double *razao, int n);
+void ordena_permutacao(const double *chave, int n, int *ordem, Tarena *A);
+int primeira_mochila(const int *C, int k, int peso);
+double objetivo(const double *valor, const int *index, int n);
+
+/* construtiva.c */
+void capacidades_cria(Tcapacidades *T, int *C, int k, int encaixe, Tarena *A);
+int capacidades_escolhe(Tcapacidades *T, int peso, int encaixe);
+void capacidades_retira(Tcapacidades *T, int j, int peso);
+double construtiva(Tinstance I, int ordem, int encaixe, Tarena *A);
+void nome_construtiva(int tipo, char *nome, size_t tam);
+
+/* arena.c */
+void arena_cria(Tarena *A);
+void arena_libera(Tarena *A);
+void arena_prepara(Tarena *A, int n, int k);
+void *arena_aloca(Tarena *A, size_t tam);
+void *arena_aloca_zerada(Tarena *A, size_t tam);
+Tmarca arena_marca(Tarena *A);
+void arena_volta(Tarena *A, Tmarca m);
+void arena_pico_auxiliar(Tarena *A, size_t pico);
+
+/* cronometro.c */
+void cronometro_zera(Tcronometro *c);
+void cronometro_inicia(Tcronometro *c, int f);
+void cronometro_para(Tcronometro *c);
+void cronometro_cabecalho(FILE *saida);
+void cronometro_imprime(FILE *saida, Tcronometro *c);
+
+/* lote.c */
+#define MAX_TIPOS 64 /* tipos de uma lista do modo em lote */
+int le_tipos(char *str, int *tipos);
+int lista_instancias(char *entrada, char ***arquivos);
+Tresultado *executa_pares(char **arquivos, int narquivos, int *tipos, int ntipos, int nrep, unsigned semente, int nthreads, Tparametros *par);
+int executa_lote(char *entrada, char *tipos, int nthreads, char *saida, Tparametros *par);
+
+/* servico.c */
+int executa_servico(char *caminho, int nthreads, Tparametros *par);
+
+
+/* heuristica_no.c */
+void heuristica_no_cria(Theur_no *H, Tinstance I, const int *col, int m, int freq, Tarena *A);
+void heuristica_no(glp_tree *tree, Theur_no *H);
+
+/* cortes.c */
+void cortes_cria(Tcortes *S, Tinstance I, const int *col, int m, glp_prob *lp, Tarena *A);
+void separa_coberturas(glp_tree *tree, Tcortes *S);
+
+/* portfolio.c */
+double portfolio(Tinstance I, Tparametros *par, unsigned semente, my_infoT *info, Ttrajetoria *traj);
+void portfolio_publica(Tportfolio *P, Tinstance I, double z);
+double portfolio_atualiza(Tportfolio *P, double z, int *atual);
+int portfolio_parou(Tportfolio *P);
+int portfolio_callback(glp_tree *tree, Tportfolio *P);
+
+/* telemetria.c */
+Ttelemetria *telemetria_abre(char *filename, int tipo, double periodo);
+void telemetria_amostra(Ttelemetria *T, int melhoria, my_infoT *info);
+void telemetria_fecha(Ttelemetria *T, my_infoT *info);
+
+/* solucao.c */
+int valida_solucao(Tinstance I, const int *index, double *z);
+double le_arquivo_sol(char *arquivo, Tinstance I, int *index);
+double melhor_arquivo_sol(char *instancia, Tinstance I, int *index);
+
+/* gerador.c */
+#define CLASSES 5 /* classes de instancias do gerador */
+int gera_instancia(Tinstance *I, int n, int k, int R, int classe, int similares, unsigned semente);
+int gera_arquivo(char *arquivo, int n, int k, int R, int classe, int similares, unsigned semente);
+
+/* experimento.c */
+int executa_experimento(char *entrada, char *tipos, int nthreads, char *prefixo, Tparametros *par);
+
+#endif
+
+/* eof */
@@ -0,0 +1,220 @@
+/* multistart.c
+multi-start da heuristica aleatoria (tipo 9)
+
+Executa varias construcoes independentes da heuristica aleatoria
+(random_heuristica) em paralelo e fica com a melhor. Cada thread tem o seu
+proprio gerador de numeros aleatorios (glp_rng, o gerador de Knuth de
+misc/rng.c) e o reinicia no inicio de cada construcao com uma semente derivada
+da semente do metodo e do numero da construcao. Assim a construcao r eh sempre
+a mesma, qualquer que seja o numero de threads, e com o numero de construcoes
+fixo (-r) o resultado eh reprodutivel. Sem -r, as construcoes continuam ate o
+tempo limite (-l), trocando nucleos por qualidade no mesmo tempo de relogio.
+Cada thread tem uma arena propria (ver arena.c), cujo pico eh somado ao da
+arena do metodo; cada construcao devolve a sua memoria de trabalho ao terminar.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <glpk.h>
+#include "mochila_multipla.h"
+
+// estado compartilhado pelas threads
+typedef struct
+{
+  Tinstance I;
+  int repeticoes;  /* total de construcoes (0 = ate o tempo limite) */
+  double limite;   /* tempo limite (em ms) */
+  double inicio;   /* instante de inicio */
+  unsigned semente;
+  int proxima;     /* proxima construcao */
+  double *valores; /* valor de cada construcao */
+  int cap;         /* tamanho de valores */
+  double z_melhor; /* melhor valor */
+  int r_melhor;    /* construcao de melhor valor */
+  int *melhor;     /* mochila de cada item (pelo numero) na melhor solucao */
+  pthread_mutex_t trava;
+} Tmulti;
+
+// argumento de cada thread
+typedef struct
+{
+  Tmulti *M;
+  int principal; /* 1 na thread que chamou multi_start */
+  Tarena arena;  /* memoria de trabalho da thread */
+} Tmulti_arg;
+
+/* semente da construcao r (espalha as sementes consecutivas) */
+static int semente_construcao(unsigned semente, int r)
+{
+  unsigned s = semente * 2654435761u + (unsigned)r * 40503u + 1u;
+  return (int)(s & 0x7FFFFFFF);
+}
+
+/* laco de cada thread: pega a proxima construcao e a executa */
+static void *trabalhador_multi(void *arg)
+{
+  Tmulti_arg *A = (Tmulti_arg *)arg;
+  Tmulti *M = A->M;
+  Tinstance J;
+  glp_rng *rng;
+  double z;
+  int r, i;
+  Tmarca m = arena_marca(&A->arena);
+
+  // copia da instancia (a heuristica altera as capacidades e a ordem dos itens)
+  J = M->I;
+  J.mapa = NULL;
+  J.item = (Titem *)arena_aloca(&A->arena, sizeof(Titem) * J.n);
+  J.C = (int *)arena_aloca(&A->arena, sizeof(int) * J.k);
+  rng = glp_rng_create(1);
+
+  for (;;)
+  {
+    pthread_mutex_lock(&M->trava);
+    if ((M->repeticoes > 0 && M->proxima >= M->repeticoes) ||
+        (M->proxima > 0 && glp_difftime(glp_mono_time(), M->inicio) * 1000 >= M->limite))
+    {
+      pthread_mutex_unlock(&M->trava);
+      break;
+    }
+    r = M->proxima++;
+    pthread_mutex_unlock(&M->trava);
+
+    memcpy(J.item, M->I.item, sizeof(Titem) * J.n);
+    memcpy(J.C, M->I.C, sizeof(int) * J.k);
+    glp_rng_init(rng, semente_construcao(M->semente, r));
+    z = random_heuristica(J, rng, &A->arena);
+
+    pthread_mutex_lock(&M->trava);
+    if (r >= M->cap)
+    {
+      while (r >= M->cap)
+        M->cap *= 2;
+      M->valores = (double *)realloc(M->valores, sizeof(double) * M->cap);
+    }
+    M->valores[r] = z;
+    // empate: fica a construcao de menor numero (independe das threads)
+    if (z > M->z_melhor + EPSILON || (z > M->z_melhor - EPSILON && r < M->r_melhor))
+    {
+      M->z_melhor = z;
+      M->r_melhor = r;
+      for (i = 0; i < J.n; i++)
+        M->melhor[J.item[i].num - 1] = J.item[i].index;
+      PRINTF("multi_start: construcao %d nova solucao %.0lf\n", r, z);
+    }
+    pthread_mutex_unlock(&M->trava);
+  }
+
+  glp_rng_delete(rng);
+  arena_volta(&A->arena, m);
+  // libera o ambiente do GLPK das threads criadas aqui
+  if (!A->principal)
+    glp_free_env();
+  return NULL;
+}
+
+// Função auxiliar de comparacao para o qsort (valores em ordem crescente)
+static int comparador_valor(const void *a, const void *b)
+{
+  double va = *(double *)a, vb = *(double *)b;
+  return (va > vb) - (va < vb);
+}
+
+/* calcula a distribuicao dos valores das construcoes */
+static void distribuicao(double *valores, int n, Tdistribuicao *dist)
+{
+  double soma = 0.0, soma2 = 0.0;
+  int i;
+
+  qsort(valores, n, sizeof(double), comparador_valor);
+  for (i = 0; i < n; i++)
+  {
+    soma += valores[i];
+    soma2 += valores[i] * valores[i];
+  }
+  dist->n = n;
+  dist->min = valores[0];
+  dist->q1 = valores[(n - 1) / 4];
+  dist->mediana = valores[(n - 1) / 2];
+  dist->q3 = valores[3 * (n - 1) / 4];
+  dist->max = valores[n - 1];
+  dist->media = soma / n;
+  dist->desvio = (n > 1) ? sqrt(fmax(0.0, (soma2 - soma * soma / n) / (n - 1))) : 0.0;
+}
+
+/* executa as construcoes aleatorias em paralelo; a melhor solucao fica em
+   I.item[].index e a distribuicao dos valores em dist */
+double multi_start(Tinstance I, Tparametros *par, unsigned semente, my_infoT *info, Tdistribuicao *dist)
+{
+  Tmulti M;
+  Tmulti_arg *args;
+  pthread_t *threads;
+  size_t pico = 0;
+  int nthreads, i, t;
+
+  M.I = I;
+  M.repeticoes = par->repeticoes;
+  M.limite = par->limite;
+  M.inicio = glp_mono_time();
+  M.semente = semente;
+  M.proxima = 0;
+  M.cap = (par->repeticoes > 0) ? par->repeticoes : 1024;
+  M.valores = (double *)malloc(sizeof(double) * M.cap);
+  M.z_melhor = -1.0;
+  M.r_melhor = 0;
+  M.melhor = (int *)calloc(I.n, sizeof(int));
+  pthread_mutex_init(&M.trava, NULL);
+
+  nthreads = par->nthreads;
+  if (nthreads <= 0)
+    nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (par->repeticoes > 0 && nthreads > par->repeticoes)
+    nthreads = par->repeticoes;
+  if (nthreads < 1)
+    nthreads = 1;
+
+  // a thread principal tambem executa construcoes
+  args = (Tmulti_arg *)malloc(sizeof(Tmulti_arg) * nthreads);
+  threads = (pthread_t *)malloc(sizeof(pthread_t) * nthreads);
+  for (t = 0; t < nthreads; t++)
+  {
+    args[t].M = &M;
+    args[t].principal = (t == 0);
+    arena_cria(&args[t].arena);
+  }
+  for (t = 1; t < nthreads; t++)
+    pthread_create(&threads[t], NULL, trabalhador_multi, &args[t]);
+  trabalhador_multi(&args[0]);
+  for (t = 1; t < nthreads; t++)
+    pthread_join(threads[t], NULL);
+  for (t = 0; t < nthreads; t++)
+  {
+    pico += args[t].arena.pico;
+    arena_libera(&args[t].arena);
+  }
+  arena_pico_auxiliar(info->arena, pico);
+
+  for (i = 0; i < I.n; i++)
+    I.item[i].index = M.melhor[I.item[i].num - 1];
+  distribuicao(M.valores, M.proxima, dist);
+
+  info->nodes = M.proxima; // construcoes
+  info->ativos = 0;
+  info->best_primalBound = M.z_melhor;
+
+  PRINTF("multi_start: z=%.0lf construcoes=%d threads=%d\n", M.z_melhor, M.proxima, nthreads);
+
+  // libera memoria
+  pthread_mutex_destroy(&M.trava);
+  free(M.valores);
+  free(M.melhor);
+  free(args);
+  free(threads);
+  return M.z_melhor;
+}
+
+/* eof */
@@ -0,0 +1,644 @@
+/* pd_mkp.c
+programacao dinamica exata para instancias de capacidades pequenas (tipo 29)
+
+Os itens sao decididos um a um, em ordem decrescente de valor/peso, e o estado
+depois dos t primeiros itens eh o vetor das capacidades residuais das
+mochilas. Tres redutores mantem o conjunto de estados pequeno:
+
+ - as somas alcancaveis pelos itens que faltam (t..n-1) ficam em um bitset,
+   calculado de tras para frente por deslocamento e ou de palavras de 64 bits
+   (R_t = R_t+1 | R_t+1 << p_t, um laco sem desvio que o compilador vetoriza).
+   Como a carga que ainda entra em uma mochila eh uma dessas somas, o residuo
+   r pode ser trocado pela maior soma alcancavel <= r sem mudar as
+   complementacoes viaveis; estados que ficam iguais sao o mesmo estado e so o
+   de maior valor eh mantido (tabela de dispersao por camada);
+ - mochilas de mesma capacidade sao intercambiaveis: os residuos de cada
+   classe ficam em ordem decrescente e o item so eh tentado na primeira de
+   residuos iguais. Em camadas pequenas (ate PD_DOMINANCIA estados), os
+   estados com residuos todos menores e valor menor que o de outro estado sao
+   descartados (dominancia);
+ - cada estado eh podado pelo limitante da surrogate (uma unica mochila com a
+   soma dos residuos), lido de uma tabela da mochila 0-1 dos itens que faltam
+   por capacidade, calculada uma vez por programacao dinamica classica. A
+   solucao inicial (gulosa + busca local) eh melhorada em cada camada
+   completando de forma gulosa o estado de maior limitante e uma amostra dos
+   demais.
+
+A camada guarda so o pai e a escolha de cada estado; a solucao otima eh
+reconstruida refazendo as escolhas a partir da raiz.
+
+A memoria da tabela e dos bitsets eh estimada antes de comecar; se ela, ou a
+dos estados ao longo das camadas (com a camada seguinte projetada pelo
+crescimento da ultima), passar de PD_MEMORIA bytes, ou se o tempo limite
+acabar, o metodo cai para o branch-and-bound MTM (bb_mkp) com o tempo
+restante.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <float.h>
+#include <glpk.h>
+#include "mochila_multipla.h"
+
+#define PD_MEMORIA (256.0 * 1024 * 1024) /* memoria maxima (em bytes) */
+#define PD_DOMINANCIA 4096                /* maior camada em que a dominancia eh testada */
+#define PD_FRACAO_INICIAL 0.05            /* fracao do tempo limite para a solucao inicial */
+#define PD_CHECA_TEMPO 4096               /* estados entre duas consultas ao relogio */
+#define PD_COMPLETA 64                    /* estados completados de forma gulosa por camada */
+
+// estado da programacao dinamica
+typedef struct
+{
+  int n;            /* itens considerados (positivos e que cabem em alguma mochila) */
+  int k;            /* total de mochilas */
+  int *ord;         /* itens em ordem decrescente de valor/peso (posicoes em I.item) */
+  int *peso;        /* peso de cada item na ordem */
+  double *valor;    /* valor de cada item na ordem */
+  int palavras;     /* palavras de 64 bits de cada bitset */
+  uint64_t *alc;    /* somas alcancaveis pelos itens t..n-1 (n+1 bitsets) */
+  int W;            /* maior capacidade da surrogate (soma das capacidades) */
+  double *sur;      /* sur[t*(W+1)+w]: mochila 0-1 dos itens t..n-1 com capacidade w */
+  int *classe;      /* classe (capacidade) de cada posicao do vetor de residuos */
+  int inteiro;      /* 1 se todos os valores sao inteiros */
+  double z_inc;     /* valor da melhor solucao conhecida */
+  // proxima camada
+  int ns, cap;      /* estados e espaco alocado */
+  int *res;         /* residuos (ns x k) */
+  double *val;      /* valor */
+  int *pai;         /* estado pai (na camada atual) */
+  unsigned short *escolha; /* 0 = item fora, j = posicao j-1 do vetor do pai */
+  int *hash;        /* tabela de dispersao */
+  int tam_hash;
+  // historico (pai e escolha de cada estado de cada camada)
+  int **hpai;
+  unsigned short **hescolha;
+  double memoria;   /* bytes usados */
+  long long gerados;
+  Tarena *arena;    /* vetores de trabalho (as camadas e as tabelas sao alocadas a parte) */
+} Tpd;
+
+/* maior soma alcancavel <= r no bitset b (usada tambem pelo preprocessamento) */
+int bitset_piso(const uint64_t *b, int r)
+{
+  int w = r >> 6, d = r & 63;
+  uint64_t x = b[w] & ((d == 63) ? ~0ull : ((2ull << d) - 1));
+
+  while (x == 0)
+    x = b[--w]; // o bit 0 (soma vazia) sempre esta ligado
+  return 64 * w + 63 - __builtin_clzll(x);
+}
+
+/* dst = src | src << p (bitsets de palavras palavras de 64 bits) */
+void bitset_desloca_ou(uint64_t *restrict dst, const uint64_t *restrict src, int palavras, int p)
+{
+  int q = p >> 6, d = p & 63, w;
+
+  for (w = 0; w < q && w < palavras; w++)
+    dst[w] = src[w];
+  if (d == 0)
+    for (w = q; w < palavras; w++)
+      dst[w] = src[w] | src[w - q];
+  else
+  {
+    if (q < palavras)
+      dst[q] = src[q] | (src[0] << d);
+    for (w = q + 1; w < palavras; w++)
+      dst[w] = src[w] | (src[w - q] << d) | (src[w - q - 1] >> (64 - d));
+  }
+}
+
+/* normaliza o vetor de residuos para a camada t: cada residuo vira a maior
+   soma alcancavel pelos itens t..n-1 e cada classe fica em ordem decrescente
+   (ids, se nao for NULL, acompanha a permutacao) */
+static void normaliza(Tpd *P, int t, int *r, int *ids)
+{
+  const uint64_t *b = P->alc + (size_t)t * P->palavras;
+  int j, l, x, y;
+
+  for (j = 0; j < P->k; j++)
+    r[j] = bitset_piso(b, r[j]);
+  for (j = 1; j < P->k; j++)
+  {
+    x = r[j];
+    y = ids ? ids[j] : 0;
+    for (l = j; l > 0 && P->classe[l - 1] == P->classe[j] && r[l - 1] < x; l--)
+    {
+      r[l] = r[l - 1];
+      if (ids)
+        ids[l] = ids[l - 1];
+    }
+    r[l] = x;
+    if (ids)
+      ids[l] = y;
+  }
+}
+
+/* limitante dos itens t..n-1 com os residuos r: a surrogate */
+static double limitante(Tpd *P, int t, const int *r)
+{
+  long long w = 0;
+  int j;
+
+  for (j = 0; j < P->k; j++)
+    w += r[j];
+  return P->sur[(size_t)t * (P->W + 1) + (w < P->W ? w : P->W)];
+}
+
+/* dispersao de um vetor de residuos */
+static unsigned dispersao(const int *r, int k)
+{
+  unsigned h = 2166136261u;
+  int j;
+
+  for (j = 0; j < k; j++)
+    h = (h ^ (unsigned)r[j]) * 16777619u;
+  return h;
+}
+
+/* refaz a tabela de dispersao da proxima camada com o dobro do tamanho */
+static void refaz_hash(Tpd *P)
+{
+  int s, h;
+
+  P->tam_hash *= 2;
+  P->hash = (int *)realloc(P->hash, sizeof(int) * P->tam_hash);
+  for (h = 0; h < P->tam_hash; h++)
+    P->hash[h] = -1;
+  for (s = 0; s < P->ns; s++)
+  {
+    h = dispersao(P->res + (size_t)s * P->k, P->k) & (P->tam_hash - 1);
+    while (P->hash[h] >= 0)
+      h = (h + 1) & (P->tam_hash - 1);
+    P->hash[h] = s;
+  }
+}
+
+/* acrescenta o estado r (ja normalizado para a camada t) com valor v na
+   proxima camada, se nao for podado; devolve 0 se a memoria acabou */
+static int acrescenta(Tpd *P, int t, const int *r, double v, int pai, int escolha)
+{
+  double ub;
+  int h, s;
+
+  ub = v + limitante(P, t, r);
+  if (P->inteiro)
+    ub = floor(ub + EPSILON);
+  if (ub <= P->z_inc + EPSILON)
+    return 1;
+
+  h = dispersao(r, P->k) & (P->tam_hash - 1);
+  while ((s = P->hash[h]) >= 0)
+  {
+    if (memcmp(P->res + (size_t)s * P->k, r, sizeof(int) * P->k) == 0)
+    {
+      if (v > P->val[s])
+      {
+        P->val[s] = v;
+        P->pai[s] = pai;
+        P->escolha[s] = escolha;
+      }
+      return 1;
+    }
+    h = (h + 1) & (P->tam_hash - 1);
+  }
+
+  if (P->ns == P->cap)
+  {
+    P->memoria += (sizeof(int) * P->k + sizeof(double) + sizeof(int) + sizeof(short)) * (double)P->cap;
+    if (P->memoria > PD_MEMORIA)
+      return 0;
+    P->cap *= 2;
+    P->res = (int *)realloc(P->res, sizeof(int) * P->k * (size_t)P->cap);
+    P->val = (double *)realloc(P->val, sizeof(double) * P->cap);
+    P->pai = (int *)realloc(P->pai, sizeof(int) * P->cap);
+    P->escolha = (unsigned short *)realloc(P->escolha, sizeof(unsigned short) * P->cap);
+  }
+  s = P->ns++;
+  memcpy(P->res + (size_t)s * P->k, r, sizeof(int) * P->k);
+  P->val[s] = v;
+  P->pai[s] = pai;
+  P->escolha[s] = escolha;
+  P->hash[h] = s;
+  if (2 * P->ns > P->tam_hash)
+    refaz_hash(P);
+  return 1;
+}
+
+/* ordem crescente de inteiros (qsort) */
+static int crescente(const void *a, const void *b)
+{
+  return *(const int *)a - *(const int *)b;
+}
+
+/* descarta os estados dominados da proxima camada: residuos todos menores ou
+   iguais e valor menor ou igual ao de outro estado */
+static void dominancia(Tpd *P)
+{
+  Tchave *chaves;
+  int *manter, a, b, s, j, nm = 0, dominado;
+  Tmarca m = arena_marca(P->arena);
+
+  chaves = (Tchave *)arena_aloca(P->arena, sizeof(Tchave) * P->ns);
+  manter = (int *)arena_aloca(P->arena, sizeof(int) * P->ns);
+  for (s = 0; s < P->ns; s++)
+  {
+    chaves[s].chave = P->val[s];
+    chaves[s].i = s;
+  }
+  qsort(chaves, P->ns, sizeof(Tchave), comparador_chave);
+  for (a = 0; a < P->ns; a++)
+  {
+    s = chaves[a].i;
+    dominado = 0;
+    for (b = 0; b < nm && !dominado; b++)
+    {
+      for (j = 0; j < P->k && P->res[(size_t)manter[b] * P->k + j] >= P->res[(size_t)s * P->k + j]; j++)
+        ;
+      dominado = (j == P->k);
+    }
+    if (!dominado)
+      manter[nm++] = s;
+  }
+  // compacta os estados mantidos (na ordem original)
+  qsort(manter, nm, sizeof(int), crescente);
+  for (a = 0; a < nm; a++)
+  {
+    s = manter[a];
+    memmove(P->res + (size_t)a * P->k, P->res + (size_t)s * P->k, sizeof(int) * P->k);
+    P->val[a] = P->val[s];
+    P->pai[a] = P->pai[s];
+    P->escolha[a] = P->escolha[s];
+  }
+  P->ns = nm;
+  arena_volta(P->arena, m);
+}
+
+/* refaz as escolhas do caminho da raiz ate o estado s da camada t: index
+   recebe a mochila de cada item (posicoes em I.item, 0 = fora), r os residuos
+   normalizados do estado e ids a mochila de cada posicao de r */
+static void reconstroi(Tpd *P, Tinstance I, int t, int s, int *r, int *ids, int *index)
+{
+  int *escolhas, l, j;
+  Tmarca m = arena_marca(P->arena);
+
+  escolhas = (int *)arena_aloca(P->arena, sizeof(int) * (t + 1));
+  for (l = t; l > 0; l--)
+  {
+    escolhas[l - 1] = P->hescolha[l][s];
+    s = P->hpai[l][s];
+  }
+  memset(index, 0, sizeof(int) * I.n);
+  for (j = 0; j < P->k; j++)
+    r[j] = I.C[ids[j]];
+  normaliza(P, 0, r, ids);
+  for (l = 0; l < t; l++)
+  {
+    if (escolhas[l] > 0)
+    {
+      index[P->ord[l]] = ids[escolhas[l] - 1] + 1;
+      r[escolhas[l] - 1] -= P->peso[l];
+    }
+    normaliza(P, l + 1, r, ids);
+  }
+  arena_volta(P->arena, m);
+}
+
+/* valor da complementacao gulosa (primeira mochila em que cabe) dos itens
+   t..n-1 a partir dos residuos r; as mochilas dos itens vao para index, se
+   nao for NULL (posicoes de r traduzidas por ids) */
+static double completa_estado(Tpd *P, int t, int *r, const int *ids, int *index)
+{
+  double z = 0.0;
+  int l, j;
+
+  for (l = t; l < P->n; l++)
+  {
+    j = primeira_mochila(r, P->k, P->peso[l]);
+    if (j >= 0)
+    {
+      r[j] -= P->peso[l];
+      z += P->valor[l];
+      if (index != NULL)
+        index[P->ord[l]] = ids[j] + 1;
+    }
+  }
+  return z;
+}
+
+/* completa de forma gulosa o estado de maior limitante da camada t e uma
+   amostra de PD_COMPLETA estados espalhados pela camada; se a melhor
+   solucao obtida for melhor que a conhecida, ela vai para melhor[] */
+static void completa(Tpd *P, Tinstance I, int t, int ncur, const int *cur_res, const double *cur_val,
+                     const int *ids0, int *melhor)
+{
+  int *r, *ids, *index, s, m = -1, passo;
+  double ub, ub_m = -DBL_MAX, z, z_m = -DBL_MAX;
+  Tmarca marca = arena_marca(P->arena);
+
+  r = (int *)arena_aloca(P->arena, sizeof(int) * P->k);
+  for (s = 0; s < ncur; s++)
+  {
+    ub = cur_val[s] + limitante(P, t, cur_res + (size_t)s * P->k);
+    if (ub > ub_m)
+    {
+      ub_m = ub;
+      m = s;
+    }
+  }
+  if (m >= 0)
+  {
+    memcpy(r, cur_res + (size_t)m * P->k, sizeof(int) * P->k);
+    z_m = cur_val[m] + completa_estado(P, t, r, NULL, NULL);
+  }
+  passo = (ncur > PD_COMPLETA) ? ncur / PD_COMPLETA : 1;
+  for (s = 0; s < ncur; s += passo)
+  {
+    memcpy(r, cur_res + (size_t)s * P->k, sizeof(int) * P->k);
+    z = cur_val[s] + completa_estado(P, t, r, NULL, NULL);
+    if (z > z_m)
+    {
+      z_m = z;
+      m = s;
+    }
+  }
+  if (m >= 0 && z_m > P->z_inc + EPSILON)
+  {
+    ids = (int *)arena_aloca(P->arena, sizeof(int) * P->k);
+    index = (int *)arena_aloca(P->arena, sizeof(int) * I.n);
+    memcpy(ids, ids0, sizeof(int) * P->k);
+    reconstroi(P, I, t, m, r, ids, index);
+    completa_estado(P, t, r, ids, index);
+    memcpy(melhor, index, sizeof(int) * I.n);
+    P->z_inc = z_m;
+    PRINTF("pd_mkp: camada %d, solucao %.0lf\n", t, z_m);
+  }
+  arena_volta(P->arena, marca);
+}
+
+/* resolve a instancia pela programacao dinamica (ou pelo bb_mkp, se a
+   memoria ou o tempo acabarem); a solucao fica em I.item[].index */
+double pd_mkp(Tinstance I, double limite, my_infoT *info)
+{
+  Tpd P;
+  Tchave *chaves;
+  double inicio, z, resta, projecao, *cur_val = NULL, *linha, *prox;
+  int *cur_res = NULL, *r, *ids, *capacidade, *melhor, *index;
+  int i, j, t, s, w, ncur = 0, maxC, maior_camada = 0, ok = 1, m, anterior = 1;
+  long long soma;
+  Tarena *A = info->arena;
+  Tmarca marca = arena_marca(A);
+
+  inicio = glp_mono_time();
+  P.k = I.k;
+  P.arena = A;
+
+  // solucao inicial: gulosa + busca local
+  capacidade = (int *)arena_aloca(A, sizeof(int) * I.k);
+  memcpy(capacidade, I.C, sizeof(int) * I.k);
+  guloso(I, A);
+  memcpy(I.C, capacidade, sizeof(int) * I.k);
+  P.z_inc = busca_local(I, limite * PD_FRACAO_INICIAL, info);
+  melhor = (int *)arena_aloca(A, sizeof(int) * I.n);
+  for (i = 0; i < I.n; i++)
+    melhor[i] = I.item[i].index;
+
+  // itens em ordem de valor/peso
+  maxC = 0;
+  soma = 0;
+  for (j = 0; j < I.k; j++)
+  {
+    soma += I.C[j];
+    if (I.C[j] > maxC)
+      maxC = I.C[j];
+  }
+  chaves = (Tchave *)arena_aloca(A, sizeof(Tchave) * (I.n > I.k ? I.n : I.k));
+  P.n = 0;
+  P.inteiro = 1;
+  for (i = 0; i < I.n; i++)
+  {
+    if (I.item[i].valor != floor(I.item[i].valor))
+      P.inteiro = 0;
+    if (I.item[i].peso <= maxC && I.item[i].valor > 0)
+    {
+      chaves[P.n].chave = (I.item[i].peso > 0) ? I.item[i].valor / I.item[i].peso : DBL_MAX;
+      chaves[P.n].i = i;
+      P.n++;
+    }
+  }
+  qsort(chaves, P.n, sizeof(Tchave), comparador_chave);
+  P.ord = (int *)arena_aloca(A, sizeof(int) * (P.n + 1));
+  P.peso = (int *)arena_aloca(A, sizeof(int) * (P.n + 1));
+  P.valor = (double *)arena_aloca(A, sizeof(double) * (P.n + 1));
+  for (t = 0; t < P.n; t++)
+  {
+    P.ord[t] = chaves[t].i;
+    P.peso[t] = I.item[P.ord[t]].peso;
+    P.valor[t] = I.item[P.ord[t]].valor;
+  }
+
+  // mochilas em ordem decrescente de capacidade; classes de capacidades iguais
+  ids = (int *)arena_aloca(A, sizeof(int) * I.k);
+  P.classe = (int *)arena_aloca(A, sizeof(int) * I.k);
+  for (j = 0; j < I.k; j++)
+  {
+    chaves[j].chave = I.C[j];
+    chaves[j].i = j;
+  }
+  qsort(chaves, I.k, sizeof(Tchave), comparador_chave);
+  for (j = 0; j < I.k; j++)
+  {
+    ids[j] = chaves[j].i;
+    P.classe[j] = (j > 0 && chaves[j].chave == chaves[j - 1].chave) ? P.classe[j - 1] : j;
+  }
+
+  // a surrogate nunca usa mais que a soma dos pesos
+  for (t = 0, w = 0; t < P.n && w < soma; t++)
+    w += P.peso[t];
+  P.W = (int)((soma < w) ? soma : w);
+
+  // memoria estimada dos bitsets e da tabela da surrogate
+  P.palavras = maxC / 64 + 1;
+  P.memoria = (sizeof(uint64_t) * (double)P.palavras + sizeof(double) * (P.W + 1.0)) * (P.n + 1);
+  P.alc = NULL;
+  P.sur = NULL;
+  P.hpai = (int **)arena_aloca_zerada(A, sizeof(int *) * (P.n + 1));
+  P.hescolha = (unsigned short **)arena_aloca_zerada(A, sizeof(unsigned short *) * (P.n + 1));
+  P.res = NULL;
+  P.val = NULL;
+  P.pai = NULL;
+  P.escolha = NULL;
+  P.hash = NULL;
+  P.gerados = 0;
+  if (P.memoria > PD_MEMORIA || I.k > 65535)
+    ok = 0;
+  else
+  {
+    // somas alcancaveis pelos itens t..n-1, de tras para frente
+    P.alc = (uint64_t *)calloc((size_t)P.palavras * (P.n + 1), sizeof(uint64_t));
+    P.alc[(size_t)P.n * P.palavras] = 1;
+    for (t = P.n - 1; t >= 0; t--)
+      bitset_desloca_ou(P.alc + (size_t)t * P.palavras, P.alc + (size_t)(t + 1) * P.palavras, P.palavras, P.peso[t]);
+    // mochila 0-1 dos itens t..n-1 para cada capacidade
+    P.sur = (double *)calloc((size_t)(P.W + 1) * (P.n + 1), sizeof(double));
+    for (t = P.n - 1; t >= 0; t--)
+    {
+      prox = P.sur + (size_t)(t + 1) * (P.W + 1);
+      linha = P.sur + (size_t)t * (P.W + 1);
+      for (w = 0; w < P.peso[t] && w <= P.W; w++)
+        linha[w] = prox[w];
+      for (w = P.peso[t]; w <= P.W; w++)
+        linha[w] = (prox[w - P.peso[t]] + P.valor[t] > prox[w]) ? prox[w - P.peso[t]] + P.valor[t] : prox[w];
+    }
+  }
+  PRINTF("pd_mkp: n=%d k=%d maxC=%d W=%d solucao inicial %.0lf\n", P.n, P.k, maxC, P.W, P.z_inc);
+
+  // camadas
+  r = (int *)arena_aloca(A, sizeof(int) * I.k);
+  index = (int *)arena_aloca(A, sizeof(int) * I.n);
+  if (ok)
+  {
+    P.cap = 1024;
+    P.res = (int *)malloc(sizeof(int) * I.k * (size_t)P.cap);
+    P.val = (double *)malloc(sizeof(double) * P.cap);
+    P.pai = (int *)malloc(sizeof(int) * P.cap);
+    P.escolha = (unsigned short *)malloc(sizeof(unsigned short) * P.cap);
+    P.tam_hash = 2048;
+    P.hash = (int *)malloc(sizeof(int) * P.tam_hash);
+
+    // raiz: capacidades normalizadas para a camada 0
+    for (j = 0; j < I.k; j++)
+      r[j] = I.C[ids[j]];
+    normaliza(&P, 0, r, NULL);
+    cur_res = (int *)malloc(sizeof(int) * I.k);
+    cur_val = (double *)malloc(sizeof(double));
+    memcpy(cur_res, r, sizeof(int) * I.k);
+    cur_val[0] = 0.0;
+    ncur = 1;
+  }
+  for (t = 0; ok && t < P.n && ncur > 0; t++)
+  {
+    P.ns = 0;
+    for (i = 0; i < P.tam_hash; i++)
+      P.hash[i] = -1;
+
+    for (s = 0; ok && s < ncur; s++)
+    {
+      const int *rs = cur_res + (size_t)s * I.k;
+
+      // item t fora
+      memcpy(r, rs, sizeof(int) * I.k);
+      normaliza(&P, t + 1, r, NULL);
+      ok = acrescenta(&P, t + 1, r, cur_val[s], s, 0);
+      // item t em cada mochila em que cabe (so a primeira de residuos iguais
+      // em cada classe)
+      for (j = 0; ok && j < I.k; j++)
+      {
+        if (rs[j] < P.peso[t] || (j > 0 && P.classe[j] == P.classe[j - 1] && rs[j] == rs[j - 1]))
+          continue;
+        memcpy(r, rs, sizeof(int) * I.k);
+        r[j] -= P.peso[t];
+        normaliza(&P, t + 1, r, NULL);
+        ok = acrescenta(&P, t + 1, r, cur_val[s] + P.valor[t], s, j + 1);
+      }
+      if (s % PD_CHECA_TEMPO == PD_CHECA_TEMPO - 1 && glp_difftime(glp_mono_time(), inicio) * 1000 >= limite)
+        ok = 0;
+    }
+    if (!ok)
+      break;
+
+    if (P.ns <= PD_DOMINANCIA)
+      dominancia(&P);
+    P.gerados += P.ns;
+    if (P.ns > maior_camada)
+      maior_camada = P.ns;
+
+    // a proxima camada vira a atual; pai e escolha vao para o historico
+    P.hpai[t + 1] = (int *)malloc(sizeof(int) * (P.ns + 1));
+    P.hescolha[t + 1] = (unsigned short *)malloc(sizeof(unsigned short) * (P.ns + 1));
+    memcpy(P.hpai[t + 1], P.pai, sizeof(int) * P.ns);
+    memcpy(P.hescolha[t + 1], P.escolha, sizeof(unsigned short) * P.ns);
+    P.memoria += (sizeof(int) + sizeof(unsigned short)) * (double)P.ns;
+    cur_res = (int *)realloc(cur_res, sizeof(int) * I.k * (size_t)(P.ns + 1));
+    cur_val = (double *)realloc(cur_val, sizeof(double) * (P.ns + 1));
+    memcpy(cur_res, P.res, sizeof(int) * I.k * (size_t)P.ns);
+    memcpy(cur_val, P.val, sizeof(double) * P.ns);
+    ncur = P.ns;
+    // a camada seguinte, se crescer na mesma proporcao, ainda cabe?
+    projecao = (double)P.ns * P.ns / (anterior > 0 ? anterior : 1) *
+               (2.0 * (sizeof(int) * I.k + sizeof(double)) + 2.0 * (sizeof(int) + sizeof(unsigned short)) + 2.0 * sizeof(int));
+    anterior = P.ns;
+    if (P.memoria > PD_MEMORIA || (P.ns > PD_DOMINANCIA && P.memoria + projecao > PD_MEMORIA))
+      ok = 0;
+    else if (t + 1 < P.n)
+      completa(&P, I, t + 1, ncur, cur_res, cur_val, ids, melhor);
+  }
+
+  z = P.z_inc;
+  if (ok)
+  {
+    // melhor estado da ultima camada (se algum sobreviveu as podas); sem
+    // estados, a melhor solucao conhecida eh otima
+    m = -1;
+    if (t == P.n)
+      for (s = 0; s < ncur; s++)
+        if (m < 0 || cur_val[s] > cur_val[m])
+          m = s;
+    if (m >= 0 && cur_val[m] > P.z_inc + EPSILON)
+    {
+      reconstroi(&P, I, P.n, m, r, ids, index);
+      memcpy(melhor, index, sizeof(int) * I.n);
+      z = cur_val[m];
+    }
+    for (i = 0; i < I.n; i++)
+      I.item[i].index = melhor[i];
+    info->nodes = (int)(P.gerados < INT32_MAX ? P.gerados : INT32_MAX);
+    info->ativos = maior_camada;
+    info->best_primalBound = z;
+    info->best_dualBound = z;
+    info->gap = 0.0;
+    PRINTF("pd_mkp: z=%.0lf otimo, estados=%lld maior camada=%d memoria=%.0lf\n", z, P.gerados, maior_camada, P.memoria);
+  }
+  else
+  {
+    // memoria ou tempo esgotados: branch-and-bound MTM com o tempo restante
+    resta = limite - glp_difftime(glp_mono_time(), inicio) * 1000;
+    PRINTF("pd_mkp: memoria ou tempo esgotados na camada %d (memoria=%.0lf), usando o bb_mkp\n", t, P.memoria);
+    z = bb_mkp(I, (resta > 0) ? resta : 0, info);
+    if (P.z_inc > z + EPSILON)
+    {
+      for (i = 0; i < I.n; i++)
+        I.item[i].index = melhor[i];
+      z = P.z_inc;
+      info->best_primalBound = z;
+      if (info->best_dualBound < z)
+        info->best_dualBound = z;
+      info->gap = (info->best_dualBound - z) / (z + 2.2204460492503131e-16);
+    }
+  }
+
+  // libera memoria: as camadas e as tabelas (que entram no pico da arena,
+  // se chegaram a ser alocadas) e o resto, que volta para a arena
+  if (P.alc != NULL)
+    arena_pico_auxiliar(A, (size_t)P.memoria);
+  for (t = 0; t <= P.n; t++)
+  {
+    free(P.hpai[t]);
+    free(P.hescolha[t]);
+  }
+  free(P.alc);
+  free(P.sur);
+  free(P.res);
+  free(P.val);
+  free(P.pai);
+  free(P.escolha);
+  free(P.hash);
+  free(cur_res);
+  free(cur_val);
+  arena_volta(A, marca);
+  return z;
+}
+
+/* eof */
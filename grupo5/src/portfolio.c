@@ -0,0 +1,366 @@
+/* portfolio.c
+portfolio de metodos em paralelo com uma incumbente compartilhada (tipo 30)
+
+Tres threads resolvem a mesma instancia, cada uma com a sua copia dos itens
+e o seu ambiente do GLPK:
+ - construtivas: as 12 heuristicas construtivas (tipos 17 a 28), cada uma
+   publicada assim que termina, e a busca local sobre a melhor delas;
+ - LNS (tipo 15): a cada iteracao a solucao atual passa a ser a incumbente
+   compartilhada, se ela for melhor;
+ - branch-and-bound do GLPK (tipo 2, com as opcoes -g, -e, -h e -c; sem -p,
+   pois as colunas precisam ser as do modelo completo).
+A incumbente fica em uma unica posicao compartilhada: o valor e a mochila de
+cada item (pelo numero do item) sao protegidos por uma trava e uma versao
+atomica muda a cada melhoria, de modo que os metodos so pegam a trava quando
+ha novidade. Na callback do GLPK (my_callback, no B&B e nos sub-MIPs da LNS),
+as solucoes inteiras novas (GLP_IBINGO) sao publicadas e, so no B&B, uma
+incumbente melhor que a do problema eh entregue em GLP_IHEUR com
+glp_ios_heur_sol, podando os nos. Nos sub-MIPs da LNS a incumbente violaria os
+limites das colunas fixadas (o GLPK nao confere): a LNS a pega entre as
+iteracoes (portfolio_atualiza).
+
+O primeiro entre o B&B e a LNS que terminar (otimo provado ou tempo limite)
+liga a parada atomica e a callback encerra o outro com glp_ios_terminate. As
+construtivas nao param o portfolio: elas so dao a primeira incumbente. Cada
+melhoria da incumbente vai para a trajetoria (<instancia>-30.traj).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <glpk.h>
+#include "mochila_multipla.h"
+
+#define PF_BUSCA 0.1 /* fracao do tempo limite da busca local das construtivas */
+
+enum
+{
+  PF_CONSTRUTIVAS,
+  PF_LNS,
+  PF_BB,
+  PF_METODOS
+};
+#ifdef DEBUG
+static const char *nome_metodo[PF_METODOS] = {"construtivas", "lns", "bb"};
+#endif
+
+// incumbente compartilhada
+typedef struct
+{
+  int n, k;
+  pthread_mutex_t trava; /* protege z, index, metodo, melhorias e traj */
+  double z;
+  int *index;            /* mochila de cada item, pelo numero (0 = fora) */
+  int metodo;            /* metodo que achou a incumbente */
+  int melhorias[PF_METODOS];
+  atomic_int versao;     /* muda a cada nova incumbente */
+  atomic_int parar;      /* 1 = um metodo terminou */
+  double inicio;
+  Ttrajetoria *traj;
+} Tincumbente;
+
+// visao de cada metodo (my_infoT.portfolio)
+struct Tportfolio
+{
+  Tincumbente *S;
+  int metodo;
+  int versao;   /* ultima versao lida */
+  int *index;   /* copia da incumbente */
+  double *x;    /* incumbente nas colunas j*n + i + 1 (glp_ios_heur_sol) */
+};
+
+// argumentos de cada thread
+typedef struct
+{
+  Tportfolio P;
+  Tinstance I;     /* copia da instancia, itens na ordem do numero */
+  Tparametros par;
+  unsigned semente;
+  my_infoT info;
+  Tarena arena;    /* memoria de trabalho da thread (info.arena) */
+  double z, dual;
+} Tpapel;
+
+/* publica a solucao index (por numero) se ela melhora a incumbente */
+static void publica(Tincumbente *S, const int *index, double z, int metodo)
+{
+  pthread_mutex_lock(&S->trava);
+  if (z > S->z + EPSILON)
+  {
+    memcpy(S->index, index, sizeof(int) * S->n);
+    S->z = z;
+    S->metodo = metodo;
+    S->melhorias[metodo]++;
+    registra_melhoria(S->traj, glp_difftime(glp_mono_time(), S->inicio), z);
+    atomic_fetch_add(&S->versao, 1);
+    PRINTF("portfolio: %s z=%.0lf\n", nome_metodo[metodo], z);
+  }
+  pthread_mutex_unlock(&S->trava);
+}
+
+/* publica a solucao em I.item[].index */
+void portfolio_publica(Tportfolio *P, Tinstance I, double z)
+{
+  int i;
+
+  for (i = 0; i < I.n; i++)
+    P->index[I.item[i].num - 1] = I.item[i].index;
+  publica(P->S, P->index, z, P->metodo);
+}
+
+/* copia a incumbente compartilhada para P->index se houver versao nova;
+   devolve o seu valor ou -1 se nao houver novidade */
+static double le_incumbente(Tportfolio *P)
+{
+  Tincumbente *S = P->S;
+  double z;
+
+  if (atomic_load(&S->versao) == P->versao)
+    return -1.0;
+  pthread_mutex_lock(&S->trava);
+  memcpy(P->index, S->index, sizeof(int) * S->n);
+  z = S->z;
+  P->versao = atomic_load(&S->versao);
+  pthread_mutex_unlock(&S->trava);
+  return z;
+}
+
+/* LNS: troca a solucao atual (itens na ordem do numero) pela incumbente
+   compartilhada, se ela for melhor; devolve o valor da solucao atual */
+double portfolio_atualiza(Tportfolio *P, double z, int *atual)
+{
+  double zs = le_incumbente(P);
+
+  if (zs > z + EPSILON)
+  {
+    memcpy(atual, P->index, sizeof(int) * P->S->n);
+    return zs;
+  }
+  return z;
+}
+
+int portfolio_parou(Tportfolio *P)
+{
+  return atomic_load(&P->S->parar);
+}
+
+/* callback: parada, publicacao das solucoes do GLPK e entrega da incumbente;
+   devolve 1 se o B&B foi encerrado */
+int portfolio_callback(glp_tree *tree, Tportfolio *P)
+{
+  Tincumbente *S = P->S;
+  glp_prob *lp = glp_ios_get_prob(tree);
+  double z;
+  int c, i, m = S->n * S->k;
+
+  if (atomic_load(&S->parar))
+  {
+    glp_ios_terminate(tree);
+    return 1;
+  }
+  if (glp_get_num_cols(lp) != m)
+    return 0;
+  switch (glp_ios_reason(tree))
+  {
+  case GLP_IBINGO:
+    z = glp_mip_obj_val(lp);
+    for (i = 0; i < S->n; i++)
+      P->index[i] = 0;
+    for (c = 1; c <= m; c++)
+      if (glp_mip_col_val(lp, c) > 0.5)
+        P->index[(c - 1) % S->n] = (c - 1) / S->n + 1;
+    publica(S, P->index, z, P->metodo);
+    break;
+  case GLP_IHEUR:
+    if (P->metodo != PF_BB)
+      break;
+    z = le_incumbente(P);
+    if (z < 0.0 || (glp_mip_status(lp) == GLP_FEAS && z <= glp_mip_obj_val(lp) + EPSILON))
+      break;
+    for (c = 1; c <= m; c++)
+      P->x[c] = 0.0;
+    for (i = 0; i < S->n; i++)
+      if (P->index[i] != 0)
+        P->x[(P->index[i] - 1) * S->n + i + 1] = 1.0;
+    glp_ios_heur_sol(tree, P->x);
+    break;
+  default:
+    break;
+  }
+  return 0;
+}
+
+/* construtivas seguidas da busca local na melhor */
+static void *construtivas(void *arg)
+{
+  Tpapel *A = (Tpapel *)arg;
+  Tinstance I = A->I;
+  int *melhor, ordem, encaixe, i;
+  double z;
+
+  glp_term_out(GLP_OFF);
+  melhor = (int *)malloc(sizeof(int) * I.n);
+  A->z = -1.0;
+  for (ordem = 0; ordem < ORDENS && !portfolio_parou(&A->P); ordem++)
+    for (encaixe = 0; encaixe < ENCAIXES; encaixe++)
+    {
+      z = construtiva(I, ordem, encaixe, A->info.arena);
+      portfolio_publica(&A->P, I, z);
+      if (z > A->z)
+      {
+        A->z = z;
+        for (i = 0; i < I.n; i++)
+          melhor[i] = I.item[i].index;
+      }
+    }
+  if (A->z >= 0.0 && !portfolio_parou(&A->P))
+  {
+    for (i = 0; i < I.n; i++)
+      I.item[i].index = melhor[i];
+    A->z = busca_local(I, A->par.limite * PF_BUSCA, &A->info);
+    portfolio_publica(&A->P, I, A->z);
+  }
+  free(melhor);
+  glp_free_env();
+  return NULL;
+}
+
+/* LNS iterada (pega a incumbente a cada iteracao, ver lns.c) */
+static void *lns_portfolio(void *arg)
+{
+  Tpapel *A = (Tpapel *)arg;
+  Ttrajetoria traj = {0, 0, NULL, NULL};
+  glp_rng *rng;
+
+  glp_term_out(GLP_OFF);
+  rng = glp_rng_create((int)(A->semente & 0x7FFFFFFF));
+  A->z = lns(A->I, &A->par, rng, &A->info, &traj);
+  A->dual = A->info.best_dualBound;
+  portfolio_publica(&A->P, A->I, A->z);
+  atomic_store(&A->P.S->parar, 1);
+  glp_rng_delete(rng);
+  free(traj.tempo);
+  free(traj.z);
+  glp_free_env();
+  return NULL;
+}
+
+/* branch-and-bound do GLPK, como no tipo 2 */
+static void *bb_portfolio(void *arg)
+{
+  Tpapel *A = (Tpapel *)arg;
+  Treducao red;
+  double *x;
+  int i, j;
+
+  glp_term_out(GLP_OFF);
+  if (A->par.lagrangiano)
+    limite_lagrangiano_bb(A->I, &A->par, &A->info);
+  x = (double *)malloc(sizeof(double) * (A->I.n * A->I.k));
+  A->z = otimiza_PLI(A->I, 2, &A->par, x, &A->info, &red);
+  A->dual = A->info.best_dualBound;
+  atomic_store(&A->P.S->parar, 1);
+  for (i = 0; i < A->I.n; i++)
+  {
+    A->P.index[i] = 0;
+    for (j = 0; j < A->I.k; j++)
+      if (x[j * A->I.n + i] > 0.5)
+        A->P.index[i] = j + 1;
+  }
+  if (A->z > 0.0)
+    publica(A->P.S, A->P.index, A->z, PF_BB);
+  free(x);
+  glp_free_env();
+  return NULL;
+}
+
+/* portfolio; a melhor solucao fica em I.item[].index e as melhorias da
+   incumbente em traj */
+double portfolio(Tinstance I, Tparametros *par, unsigned semente, my_infoT *info, Ttrajetoria *traj)
+{
+  static void *(*corpo[PF_METODOS])(void *) = {construtivas, lns_portfolio, bb_portfolio};
+  Tincumbente S;
+  Tpapel A[PF_METODOS];
+  pthread_t threads[PF_METODOS];
+  size_t pico = 0;
+  int t, i;
+
+  S.n = I.n;
+  S.k = I.k;
+  S.z = -1.0;
+  S.index = (int *)calloc(I.n, sizeof(int));
+  S.metodo = -1;
+  memset(S.melhorias, 0, sizeof(S.melhorias));
+  atomic_init(&S.versao, 0);
+  atomic_init(&S.parar, 0);
+  S.inicio = glp_mono_time();
+  S.traj = traj;
+  pthread_mutex_init(&S.trava, NULL);
+
+  for (t = 0; t < PF_METODOS; t++)
+  {
+    A[t].P.S = &S;
+    A[t].P.metodo = t;
+    A[t].P.versao = 0;
+    A[t].P.index = (int *)malloc(sizeof(int) * I.n);
+    A[t].P.x = (double *)malloc(sizeof(double) * (I.n * I.k + 1));
+    // copia da instancia com os itens na ordem do numero (colunas j*n + i + 1)
+    A[t].I = I;
+    A[t].I.mapa = NULL;
+    A[t].I.item = (Titem *)malloc(sizeof(Titem) * I.n);
+    memcpy(A[t].I.item, I.item, sizeof(Titem) * I.n);
+    qsort(A[t].I.item, I.n, sizeof(Titem), comparador_num);
+    A[t].I.C = (int *)malloc(sizeof(int) * I.k);
+    memcpy(A[t].I.C, I.C, sizeof(int) * I.k);
+    A[t].par = *par;
+    A[t].par.preprocessa = 0;
+    A[t].semente = semente;
+    // cada thread tem o seu info e a sua arena; o cronometro nao eh
+    // compartilhado e so o B&B grava a telemetria
+    A[t].info = *info;
+    A[t].info.crono = NULL;
+    A[t].info.telemetria = (t == PF_BB) ? info->telemetria : NULL;
+    A[t].info.portfolio = &A[t].P;
+    arena_cria(&A[t].arena);
+    arena_prepara(&A[t].arena, I.n, I.k);
+    A[t].info.arena = &A[t].arena;
+    A[t].z = -1.0;
+    A[t].dual = DBL_MAX;
+  }
+  for (t = 0; t < PF_METODOS; t++)
+    pthread_create(&threads[t], NULL, corpo[t], &A[t]);
+  for (t = 0; t < PF_METODOS; t++)
+  {
+    pthread_join(threads[t], NULL);
+    pico += A[t].arena.pico;
+  }
+  arena_pico_auxiliar(info->arena, pico);
+
+  // melhor solucao (pelo numero do item) e limitantes
+  for (i = 0; i < I.n; i++)
+    I.item[i].index = (S.z >= 0.0) ? S.index[I.item[i].num - 1] : 0;
+  info->best_primalBound = S.z;
+  info->best_dualBound = A[PF_BB].dual < A[PF_LNS].dual ? A[PF_BB].dual : A[PF_LNS].dual;
+  if (info->best_dualBound < S.z)
+    info->best_dualBound = S.z;
+  info->nodes = A[PF_BB].info.nodes;
+  info->ativos = A[PF_BB].info.ativos;
+  info->gap = (info->best_dualBound - S.z) / (S.z + DBL_EPSILON);
+  PRINTF("portfolio: z=%.0lf (%s) melhorias construtivas=%d lns=%d bb=%d\n", S.z, S.metodo >= 0 ? nome_metodo[S.metodo] : "-", S.melhorias[PF_CONSTRUTIVAS], S.melhorias[PF_LNS], S.melhorias[PF_BB]);
+
+  for (t = 0; t < PF_METODOS; t++)
+  {
+    free(A[t].P.index);
+    free(A[t].P.x);
+    free_instancia(A[t].I);
+    arena_libera(&A[t].arena);
+  }
+  pthread_mutex_destroy(&S.trava);
+  free(S.index);
+  return S.z;
+}
+
+/* eof */
@@ -0,0 +1,408 @@
+/* preprocessamento.c
+reducoes do modelo F1 antes do branch-and-bound do GLPK (tipo 2 com -p 1)
+
+O modelo de carga_lp tem uma coluna x_ij para cada item i e mochila j, mesmo
+quando o item nao cabe na mochila. As reducoes abaixo sao repetidas enquanto
+alguma delas muda alguma coisa:
+
+ - itens de valor nao positivo ou mais pesados que todas as mochilas saem do
+   modelo;
+ - dominancia: o item l domina o item i se p_l <= p_i e v_l >= v_i (empates
+   pelo indice). Trocar i por l em uma solucao otima nao perde valor nem
+   capacidade, por isso existe uma solucao otima em que, se i esta nas
+   mochilas, todos os que o dominam tambem estao; se a soma dos pesos de i e
+   dos que o dominam passa da soma das capacidades, i sai. A soma dos pesos
+   dos dominantes de cada item eh obtida em O(n log n): os itens sao
+   percorridos em ordem de peso e uma arvore de Fenwick indexada pela ordem
+   dos valores acumula os pesos ja vistos;
+ - reducao das capacidades: a carga de uma mochila eh uma soma de pesos dos
+   itens que restam, por isso C_j pode ser trocada pela maior soma alcancavel
+   <= C_j (bitset das somas, calculado por deslocamento de palavras de 64 bits
+   como em pd_mkp.c). As colunas dos itens mais pesados que a capacidade
+   reduzida saem do modelo.
+
+O modelo reduzido so tem as colunas restantes (col[] leva cada coluna a
+variavel x_ij), e a restricao de unicidade dos itens com uma unica coluna nao
+eh criada (o limite da variavel binaria ja basta). Depois da relaxacao, as
+colunas nao basicas sao fixadas pelos custos reduzidos d contra a solucao
+heuristica (gulosa + busca local) de valor LB: uma coluna no limite inferior
+com z_LP + d < LB (+1 com valores inteiros) so aparece em solucoes que nao
+melhoram a heuristica e eh retirada do modelo; uma coluna no limite superior
+com z_LP - d < LB eh fixada em 1. Por isso o resultado final eh a melhor entre
+a solucao do B&B e a heuristica.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <glpk.h>
+#include "mochila_multipla.h"
+
+#define PRE_BITSET_MAX 1e8 /* maior custo (itens x palavras) da reducao das capacidades */
+
+// item na ordem da dominancia
+typedef struct
+{
+  int peso;
+  double valor;
+  int i;
+} Tdominancia;
+
+/* peso crescente, valor decrescente e indice crescente: os dominantes de um
+   item sao os anteriores a ele de valor >= ao seu */
+static int comparador_dominancia(const void *a, const void *b)
+{
+  const Tdominancia *x = (const Tdominancia *)a, *y = (const Tdominancia *)b;
+
+  if (x->peso != y->peso)
+    return (x->peso < y->peso) ? -1 : 1;
+  if (x->valor != y->valor)
+    return (x->valor > y->valor) ? -1 : 1;
+  return (x->i > y->i) - (x->i < y->i);
+}
+
+static int decrescente(const void *a, const void *b)
+{
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) ? -1 : (x < y);
+}
+
+/* ultima posicao de valores[] (em ordem decrescente) com valor >= v */
+static int ultima_posicao(const double *valores, int n, double v)
+{
+  int a = 0, b = n; // primeira posicao com valor < v
+
+  while (a < b)
+  {
+    int m = (a + b) / 2;
+    if (valores[m] >= v)
+      a = m + 1;
+    else
+      b = m;
+  }
+  return a - 1;
+}
+
+/* retira os itens dominados por itens que, junto com eles, nao cabem nas
+   mochilas; devolve 1 se algum item saiu */
+static int dominancia(Tinstance I, Tpreprocessamento *P, long long somaC, Tarena *A)
+{
+  Tdominancia *d;
+  double *valores;
+  long long *fenwick, soma;
+  int i, t, nv = 0, p, r, mudou = 0;
+  Tmarca m = arena_marca(A);
+
+  d = (Tdominancia *)arena_aloca(A, sizeof(Tdominancia) * I.n);
+  valores = (double *)arena_aloca(A, sizeof(double) * I.n);
+  for (i = 0; i < I.n; i++)
+  {
+    if (!P->vivo[i])
+      continue;
+    d[nv].peso = I.item[i].peso;
+    d[nv].valor = I.item[i].valor;
+    d[nv].i = i;
+    valores[nv] = I.item[i].valor;
+    nv++;
+  }
+  qsort(d, nv, sizeof(Tdominancia), comparador_dominancia);
+  qsort(valores, nv, sizeof(double), decrescente);
+
+  fenwick = (long long *)arena_aloca_zerada(A, sizeof(long long) * (nv + 1));
+  for (t = 0; t < nv; t++)
+  {
+    // soma dos pesos dos anteriores de valor >= v (posicoes 1..r da arvore);
+    // o item entra na posicao r, que as consultas de valores <= v incluem
+    r = ultima_posicao(valores, nv, d[t].valor) + 1;
+    soma = 0;
+    for (p = r; p > 0; p -= p & -p)
+      soma += fenwick[p];
+    if (soma + d[t].peso > somaC)
+    {
+      P->vivo[d[t].i] = 0;
+      mudou = 1;
+    }
+    for (p = r; p <= nv; p += p & -p)
+      fenwick[p] += d[t].peso;
+  }
+
+  arena_volta(A, m);
+  return mudou;
+}
+
+/* troca cada capacidade pela maior soma alcancavel pelos itens que restam;
+   devolve 1 se alguma capacidade diminuiu */
+static int reduz_capacidades(Tinstance I, Tpreprocessamento *P, int maxC, Tarena *A)
+{
+  uint64_t *a, *b, *aux;
+  int i, j, c, palavras, vivos = 0, mudou = 0;
+  Tmarca m;
+
+  palavras = maxC / 64 + 1;
+  for (i = 0; i < I.n; i++)
+    vivos += P->vivo[i];
+  if ((double)vivos * palavras > PRE_BITSET_MAX)
+    return 0;
+
+  m = arena_marca(A);
+  a = (uint64_t *)arena_aloca_zerada(A, sizeof(uint64_t) * palavras);
+  b = (uint64_t *)arena_aloca(A, sizeof(uint64_t) * palavras);
+  a[0] = 1; // soma vazia
+  for (i = 0; i < I.n; i++)
+  {
+    if (!P->vivo[i] || I.item[i].peso > maxC)
+      continue;
+    bitset_desloca_ou(b, a, palavras, I.item[i].peso);
+    aux = a;
+    a = b;
+    b = aux;
+  }
+  for (j = 0; j < I.k; j++)
+  {
+    if (P->C[j] < 0)
+      continue;
+    c = bitset_piso(a, P->C[j]);
+    if (c < P->C[j])
+    {
+      P->red.capacidade += P->C[j] - c;
+      P->C[j] = c;
+      mudou = 1;
+    }
+  }
+  arena_volta(A, m);
+  return mudou;
+}
+
+/* calcula a solucao heuristica e as reducoes estruturais (itens e
+   capacidades) e monta a lista das colunas do modelo reduzido; limite eh o
+   tempo (em ms) da busca local da solucao heuristica. Os vetores de P saem
+   de info->arena e sao devolvidos por quem chamou (arena_volta) */
+void preprocessa(Tinstance I, double limite, my_infoT *info, Tpreprocessamento *P)
+{
+  int i, j, c, maxC, mudou, *capacidade, *colunas;
+  long long somaC;
+  Tarena *A = info->arena;
+  Tmarca m;
+
+  memset(&P->red, 0, sizeof(Treducao));
+  P->red.feito = 1;
+  P->n = I.n;
+  P->k = I.k;
+  P->C = (int *)arena_aloca(A, sizeof(int) * I.k);
+  memcpy(P->C, I.C, sizeof(int) * I.k);
+  P->vivo = (int *)arena_aloca(A, sizeof(int) * I.n);
+  P->inteiro = 1;
+  for (i = 0; i < I.n; i++)
+  {
+    P->vivo[i] = (I.item[i].valor > 0);
+    if (I.item[i].valor != floor(I.item[i].valor))
+      P->inteiro = 0;
+  }
+
+  // solucao heuristica: gulosa + busca local
+  FASE_INICIO(info->crono, FASE_HEURISTICA);
+  m = arena_marca(A);
+  capacidade = (int *)arena_aloca(A, sizeof(int) * I.k);
+  memcpy(capacidade, I.C, sizeof(int) * I.k);
+  guloso(I, A);
+  memcpy(I.C, capacidade, sizeof(int) * I.k);
+  arena_volta(A, m);
+  FASE_FIM(info->crono);
+  P->z_inc = busca_local(I, limite, info);
+  P->red.lb = P->z_inc;
+  P->x_inc = (double *)arena_aloca_zerada(A, sizeof(double) * I.n * (size_t)I.k);
+  for (i = 0; i < I.n; i++)
+    if (I.item[i].index != 0)
+      P->x_inc[(size_t)(I.item[i].index - 1) * I.n + i] = 1.0;
+
+  FASE_INICIO(info->crono, FASE_MODELO);
+  do
+  {
+    maxC = 0;
+    somaC = 0;
+    for (j = 0; j < I.k; j++)
+    {
+      if (P->C[j] > maxC)
+        maxC = P->C[j];
+      if (P->C[j] > 0)
+        somaC += P->C[j];
+    }
+    mudou = 0;
+    for (i = 0; i < I.n; i++)
+    {
+      if (P->vivo[i] && I.item[i].peso > maxC)
+      {
+        P->vivo[i] = 0;
+        mudou = 1;
+      }
+    }
+    mudou |= dominancia(I, P, somaC, A);
+    mudou |= reduz_capacidades(I, P, maxC, A);
+  } while (mudou);
+
+  // colunas restantes, na ordem de carga_lp (mochila a mochila)
+  P->col = (int *)arena_aloca(A, sizeof(int) * ((size_t)I.n * I.k + 1));
+  m = arena_marca(A);
+  colunas = (int *)arena_aloca_zerada(A, sizeof(int) * I.n);
+  P->m = 0;
+  for (j = 0; j < I.k; j++)
+  {
+    for (i = 0; i < I.n; i++)
+    {
+      if (P->vivo[i] && I.item[i].peso <= P->C[j])
+      {
+        P->col[++P->m] = j * I.n + i;
+        colunas[i]++;
+      }
+    }
+  }
+  for (i = 0; i < I.n; i++)
+  {
+    if (colunas[i] == 0)
+      P->red.itens++;
+    if (colunas[i] <= 1)
+      P->red.linhas++;
+  }
+  for (c = 0; c < I.n; c++)
+    P->vivo[c] = (colunas[c] > 0);
+  P->red.colunas = I.n * I.k - P->m;
+  P->red.restantes = P->m;
+  arena_volta(A, m);
+  FASE_FIM(info->crono);
+
+  PRINTF("preprocessamento: lb=%.0lf itens=%d colunas=%d linhas=%d capacidade=%lld\n", P->z_inc, P->red.itens, P->red.colunas, P->red.linhas, P->red.capacidade);
+}
+
+/* carrega o modelo F1 so com as colunas de P->col e as capacidades reduzidas
+   (as restricoes de unicidade dos itens com uma coluna nao sao criadas); os
+   vetores de triplas saem da arena A */
+int carga_lp_reduzido(glp_prob **lp, Tinstance I, Tpreprocessamento *P, Tarena *A)
+{
+  int *ptr, *ind, *linha, i, j, c, nz, nrows;
+  double *val;
+  Tmarca m = arena_marca(A);
+
+  // linha da restricao de unicidade de cada item (0 = sem restricao)
+  linha = (int *)arena_aloca_zerada(A, sizeof(int) * I.n);
+  for (c = 1; c <= P->m; c++)
+    linha[P->col[c] % I.n]++;
+  nrows = I.k;
+  for (i = 0; i < I.n; i++)
+    linha[i] = (linha[i] > 1) ? ++nrows : 0;
+
+  ptr = (int *)arena_aloca(A, sizeof(int) * (P->m + 2));
+  ind = (int *)arena_aloca(A, sizeof(int) * (2 * P->m + 1));
+  val = (double *)arena_aloca(A, sizeof(double) * (2 * P->m + 1));
+
+  *lp = glp_create_prob();
+  glp_set_prob_name(*lp, "mochila_multipla");
+  glp_set_obj_dir(*lp, GLP_MAX);
+  glp_add_rows(*lp, nrows);
+  for (j = 0; j < I.k; j++)
+    glp_set_row_bnds(*lp, j + 1, GLP_UP, 0.0, P->C[j]);
+  for (i = 0; i < I.n; i++)
+    if (linha[i] != 0)
+      glp_set_row_bnds(*lp, linha[i], GLP_UP, 0.0, 1.0);
+
+  if (P->m > 0)
+    glp_add_cols(*lp, P->m);
+  nz = 1;
+  for (c = 1; c <= P->m; c++)
+  {
+    j = P->col[c] / I.n;
+    i = P->col[c] % I.n;
+    glp_set_obj_coef(*lp, c, I.item[i].valor);
+    glp_set_col_kind(*lp, c, GLP_BV);
+    ptr[c] = nz;
+    ind[nz] = j + 1;
+    val[nz] = I.item[i].peso;
+    nz++;
+    if (linha[i] != 0)
+    {
+      ind[nz] = linha[i];
+      val[nz] = 1.0;
+      nz++;
+    }
+  }
+  ptr[P->m + 1] = nz;
+  if (P->m > 0)
+    glp_load_cols(*lp, ptr, ind, val);
+
+  arena_volta(A, m);
+  return 1;
+}
+
+/* fixa as colunas nao basicas da relaxacao otima pelos custos reduzidos
+   (retira as fixadas em 0); devolve 1 se a relaxacao ja prova que a solucao
+   heuristica eh otima */
+int fixa_custos_reduzidos(glp_prob *lp, Tpreprocessamento *P, Tarena *A)
+{
+  double z, d, limiar;
+  int c, nd = 0, m = 0, *num;
+  Tmarca marca;
+
+  if (glp_get_status(lp) != GLP_OPT)
+    return 0;
+  z = glp_get_obj_val(lp);
+  // com valores inteiros, uma solucao de valor < LB + 1 nao melhora LB
+  limiar = P->inteiro ? P->z_inc + 1.0 - EPSILON : P->z_inc;
+  if (z < limiar)
+    return 1;
+
+  marca = arena_marca(A);
+  num = (int *)arena_aloca(A, sizeof(int) * (P->m + 1));
+  for (c = 1; c <= P->m; c++)
+  {
+    d = glp_get_col_dual(lp, c);
+    if (glp_get_col_stat(lp, c) == GLP_NL && z + d < limiar)
+      num[++nd] = c;
+    else
+    {
+      if (glp_get_col_stat(lp, c) == GLP_NU && z - d < limiar)
+      {
+        glp_set_col_bnds(lp, c, GLP_FX, 1.0, 1.0);
+        P->red.fixadas++;
+      }
+      P->col[++m] = P->col[c]; // glp_del_cols mantem a ordem das colunas
+    }
+  }
+  // as colunas retiradas sao nao basicas: a base continua valida
+  if (nd > 0)
+    glp_del_cols(lp, nd, num);
+  P->m = m;
+  P->red.colunas += nd;
+  P->red.restantes = m;
+  arena_volta(A, marca);
+
+  PRINTF("preprocessamento: z_LP=%.2lf custo reduzido: %d colunas retiradas, %d fixadas em 1\n", z, nd, P->red.fixadas);
+  return 0;
+}
+
+/* solucao heuristica nas colunas do modelo reduzido (1..m), tirada da arena
+   A, ou NULL se ela usar uma coluna retirada ou violar uma fixacao */
+double *solucao_reduzida(Tpreprocessamento *P, glp_prob *lp, Tarena *A)
+{
+  double *x, usadas = 0, total = 0;
+  int c, i;
+  Tmarca m = arena_marca(A);
+
+  for (i = 0; i < P->n * P->k; i++)
+    total += P->x_inc[i];
+  x = (double *)arena_aloca_zerada(A, sizeof(double) * (P->m + 1));
+  for (c = 1; c <= P->m; c++)
+  {
+    x[c] = P->x_inc[P->col[c]];
+    usadas += x[c];
+    if (x[c] < glp_get_col_lb(lp, c))
+      break;
+  }
+  if (c <= P->m || usadas < total)
+  {
+    arena_volta(A, m);
+    return NULL;
+  }
+  return x;
+}
+
+/* eof */
@@ -0,0 +1,526 @@
+/* servico.c
+modo servico: um processo de vida longa recebe instancias pela entrada padrao
+ou por um socket local (unix) e as resolve em um conjunto de threads criadas
+uma so vez. Cada thread inicia o seu ambiente do GLPK na criacao e o mantem
+ate o fim do servico (como no modo em lote), e a instancia eh analisada a
+partir do proprio pedido, em memoria: o custo de criar um processo, iniciar o
+GLPK e ler arquivos nao se repete para cada instancia.
+
+Pedido (uma linha de texto seguida da instancia):
+   <tipo> <limite> <bytes>
+   <bytes bytes da instancia, no formato .mochila ou .mkpb>
+com limite o tempo limite do metodo em ms (0 = o de -l) e tipo de 2 a
+TIPO_MAX (a relaxacao nao tem solucao inteira). O formato da instancia eh
+reconhecido pelo cabecalho "MKPB" do formato binario. A linha "fim" encerra o
+servico; na entrada padrao o fim do arquivo tambem.
+
+Resposta de cada pedido, na ordem em que terminam:
+   <id> ok <tempo>
+   <solucao no formato .sol: "z k" e, para cada mochila, "mochila j t" e os itens>
+ou "<id> erro <motivo>", com id o numero do pedido na conexao (1, 2, ...) e
+tempo o tempo do metodo em segundos. Como as threads terminam fora de ordem, o
+cliente associa as respostas aos pedidos pelo id.
+
+No socket, cada conexao tem uma thread leitora, que so le os pedidos e os poe
+na fila comum; as respostas de uma conexao sao escritas sob a sua trava e a
+conexao eh fechada quando o leitor termina e o ultimo pedido eh respondido. No
+fim, o servico mostra os pedidos atendidos, o tempo medio dos metodos, a
+espera media na fila, a sobrecarga media por pedido (da retirada da fila ate
+a resposta escrita, fora o tempo do metodo) e o maior pico da memoria de
+trabalho. Cada thread tem a sua arena (ver arena.c), reaproveitada entre os
+pedidos.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <glpk.h>
+#include "mochila_multipla.h"
+
+#define SV_LINHA 256 /* tamanho maximo da linha de um pedido */
+#define SV_FILA 64   /* conexoes aguardando o accept */
+
+// conexao de um cliente (ou a entrada e a saida padrao)
+typedef struct Tconexao
+{
+  FILE *saida;           /* respostas */
+  int fd;                /* socket da conexao (-1 na entrada padrao) */
+  int pendentes;         /* pedidos sem resposta + 1 enquanto o leitor le */
+  pthread_mutex_t trava; /* protege saida e pendentes */
+  struct Tconexao *prox; /* lista das conexoes com leitor ativo */
+} Tconexao;
+
+// pedido na fila do servico
+typedef struct Tpedido
+{
+  Tconexao *con;
+  int id;          /* numero do pedido na conexao */
+  int tipo;
+  double limite;   /* tempo limite (em ms; 0 = o do servico) */
+  char *dados;     /* instancia (texto ou binaria) */
+  size_t tam;
+  double chegada;  /* instante em que o pedido terminou de ser lido */
+  struct Tpedido *prox;
+} Tpedido;
+
+// estado compartilhado entre leitores e threads
+typedef struct
+{
+  Tpedido *primeiro, *ultimo; /* fila dos pedidos */
+  Tconexao *conexoes;         /* conexoes com leitor ativo */
+  int leitores;               /* leitores ativos */
+  int fim;                    /* 1 = as threads terminam com a fila vazia */
+  int parar;                  /* 1 = o socket nao aceita mais conexoes */
+  int escuta;                 /* socket de escuta (-1 na entrada padrao) */
+  Tparametros par;            /* parametros dos metodos */
+  long atendidos, falhas;
+  double tempo_metodos;       /* soma dos tempos dos metodos (em s) */
+  double espera;              /* soma das esperas na fila (em s) */
+  double sobrecarga;          /* soma das sobrecargas dos pedidos (em s) */
+  size_t memoria;             /* maior pico da memoria de trabalho */
+  pthread_mutex_t trava;      /* protege todos os campos acima */
+  pthread_cond_t sinal;       /* fila nao vazia ou fim */
+  pthread_cond_t sem_leitores;
+} Tservico;
+
+// argumento da thread leitora de uma conexao do socket
+typedef struct
+{
+  Tservico *S;
+  Tconexao *con;
+} Tleitor;
+
+static Tconexao *cria_conexao(FILE *saida, int fd)
+{
+  Tconexao *con = (Tconexao *)malloc(sizeof(Tconexao));
+
+  con->saida = saida;
+  con->fd = fd;
+  con->pendentes = 1;
+  con->prox = NULL;
+  pthread_mutex_init(&con->trava, NULL);
+  return con;
+}
+
+/* desconta um pedido (ou o leitor) da conexao e a fecha com o ultimo */
+static void solta_conexao(Tconexao *con)
+{
+  int resta;
+
+  pthread_mutex_lock(&con->trava);
+  resta = --con->pendentes;
+  pthread_mutex_unlock(&con->trava);
+  if (resta > 0)
+    return;
+  if (con->fd >= 0)
+    fclose(con->saida);
+  else
+    fflush(con->saida);
+  pthread_mutex_destroy(&con->trava);
+  free(con);
+}
+
+/* resposta de erro (o pedido nao chega as threads) */
+static void responde_erro(Tconexao *con, int id, const char *motivo)
+{
+  pthread_mutex_lock(&con->trava);
+  fprintf(con->saida, "%d erro %s\n", id, motivo);
+  fflush(con->saida);
+  pthread_mutex_unlock(&con->trava);
+}
+
+/* carrega a instancia do pedido; as capacidades do formato binario apontam
+   para os dados do pedido e por isso sao copiadas */
+static int carrega_pedido(Tpedido *p, Tinstance *I)
+{
+  int *C;
+
+  if (p->tam >= 4 && memcmp(p->dados, MKPB_MAGICO, 4) == 0)
+  {
+    if (!carga_instancia_mkpb(p->dados, p->tam, I))
+      return 0;
+    C = (int *)malloc(sizeof(int) * I->k);
+    memcpy(C, I->C, sizeof(int) * I->k);
+    I->C = C;
+    return 1;
+  }
+  return carga_instancia_texto(p->dados, p->tam, I);
+}
+
+/* laco de cada thread: resolve os pedidos da fila ate o fim do servico */
+static void *trabalhador(void *arg)
+{
+  Tservico *S = (Tservico *)arg;
+  Tparametros par = S->par;
+  Tresultado res;
+  Tarena arena;
+  Tinstance I;
+  Tpedido *p;
+  double inicio, sobrecarga;
+  int ok;
+
+  // nenhuma saida do GLPK no terminal nesta thread (e o ambiente do GLPK
+  // desta thread eh criado aqui, uma vez para todos os pedidos)
+  glp_term_out(GLP_OFF);
+  arena_cria(&arena);
+
+  for (;;)
+  {
+    pthread_mutex_lock(&S->trava);
+    while (S->primeiro == NULL && !S->fim)
+      pthread_cond_wait(&S->sinal, &S->trava);
+    p = S->primeiro;
+    if (p != NULL)
+    {
+      S->primeiro = p->prox;
+      if (S->primeiro == NULL)
+        S->ultimo = NULL;
+    }
+    pthread_mutex_unlock(&S->trava);
+    if (p == NULL)
+      break;
+
+    inicio = glp_mono_time();
+    par.limite = (p->limite > 0) ? p->limite : S->par.limite;
+    ok = carrega_pedido(p, &I);
+    if (ok)
+    {
+      inicia_resultado(NULL, p->tipo, &par, &arena, &res);
+      resolve_instancia(I, p->tipo, &par, &res);
+    }
+
+    pthread_mutex_lock(&p->con->trava);
+    if (ok)
+    {
+      fprintf(p->con->saida, "%d ok %.6lf\n", p->id, res.tempo);
+      imprime_solucao(p->con->saida, res.z, I);
+    }
+    else
+      fprintf(p->con->saida, "%d erro instancia invalida\n", p->id);
+    fflush(p->con->saida);
+    pthread_mutex_unlock(&p->con->trava);
+    sobrecarga = glp_difftime(glp_mono_time(), inicio);
+
+    pthread_mutex_lock(&S->trava);
+    if (ok)
+    {
+      S->atendidos++;
+      S->tempo_metodos += res.tempo;
+      S->espera += glp_difftime(inicio, p->chegada);
+      S->sobrecarga += sobrecarga - res.tempo;
+      if (res.memoria > S->memoria)
+        S->memoria = res.memoria;
+    }
+    else
+      S->falhas++;
+    pthread_mutex_unlock(&S->trava);
+
+    if (ok)
+    {
+      free(res.traj.tempo);
+      free(res.traj.z);
+      free_instancia(I);
+    }
+    solta_conexao(p->con);
+    free(p->dados);
+    free(p);
+  }
+
+  // libera a arena e o ambiente do GLPK desta thread
+  arena_libera(&arena);
+  glp_free_env();
+  return NULL;
+}
+
+/* le os pedidos da entrada e os poe na fila; devolve 1 se leu "fim" */
+static int le_pedidos(Tservico *S, Tconexao *con, FILE *entrada)
+{
+  char linha[SV_LINHA], resto;
+  Tpedido *p;
+  double limite;
+  size_t tam;
+  char *dados;
+  int id = 0, tipo, lidos;
+
+  while (fgets(linha, sizeof(linha), entrada) != NULL)
+  {
+    lidos = sscanf(linha, "%d %lf %zu %c", &tipo, &limite, &tam, &resto);
+    if (lidos <= 0)
+    {
+      if (strncmp(linha, "fim", 3) == 0)
+        return 1;
+      if (strspn(linha, " \t\r\n") == strlen(linha))
+        continue; // linha em branco
+    }
+    id++;
+    if (lidos != 3 || limite < 0)
+    {
+      // sem o tamanho da instancia a leitura nao tem como continuar
+      responde_erro(con, id, "pedido invalido");
+      return 0;
+    }
+    dados = (char *)malloc(tam + 1);
+    if (dados == NULL || fread(dados, 1, tam, entrada) != tam)
+    {
+      responde_erro(con, id, "instancia incompleta");
+      free(dados);
+      return 0;
+    }
+    if (tipo < 2 || tipo > TIPO_MAX)
+    {
+      responde_erro(con, id, "tipo invalido");
+      free(dados);
+      continue;
+    }
+
+    p = (Tpedido *)malloc(sizeof(Tpedido));
+    p->con = con;
+    p->id = id;
+    p->tipo = tipo;
+    p->limite = limite;
+    p->dados = dados;
+    p->tam = tam;
+    p->chegada = glp_mono_time();
+    p->prox = NULL;
+
+    pthread_mutex_lock(&con->trava);
+    con->pendentes++;
+    pthread_mutex_unlock(&con->trava);
+
+    pthread_mutex_lock(&S->trava);
+    if (S->ultimo != NULL)
+      S->ultimo->prox = p;
+    else
+      S->primeiro = p;
+    S->ultimo = p;
+    pthread_cond_signal(&S->sinal);
+    pthread_mutex_unlock(&S->trava);
+  }
+  return 0;
+}
+
+/* thread leitora de uma conexao do socket */
+static void *leitor(void *arg)
+{
+  Tleitor *L = (Tleitor *)arg;
+  Tservico *S = L->S;
+  Tconexao *con = L->con, **c;
+  FILE *entrada;
+  int fim = 0;
+
+  free(L);
+  entrada = fdopen(dup(con->fd), "r");
+  if (entrada != NULL)
+  {
+    fim = le_pedidos(S, con, entrada);
+    fclose(entrada);
+  }
+
+  pthread_mutex_lock(&S->trava);
+  for (c = &S->conexoes; *c != con; c = &(*c)->prox)
+    ;
+  *c = con->prox;
+  if (fim && !S->parar)
+  {
+    // acorda o accept
+    S->parar = 1;
+    shutdown(S->escuta, SHUT_RDWR);
+  }
+  S->leitores--;
+  if (S->leitores == 0)
+    pthread_cond_signal(&S->sem_leitores);
+  pthread_mutex_unlock(&S->trava);
+
+  solta_conexao(con);
+  return NULL;
+}
+
+/* aceita conexoes no socket ate um pedido "fim" */
+static int atende_socket(Tservico *S, char *caminho)
+{
+  struct sockaddr_un end;
+  Tconexao *con;
+  Tleitor *L;
+  FILE *saida;
+  pthread_t t;
+  int fd;
+
+  if (strlen(caminho) >= sizeof(end.sun_path))
+  {
+    printf("Caminho do socket muito longo: %s\n", caminho);
+    return 0;
+  }
+  S->escuta = socket(AF_UNIX, SOCK_STREAM, 0);
+  memset(&end, 0, sizeof(end));
+  end.sun_family = AF_UNIX;
+  strcpy(end.sun_path, caminho);
+  unlink(caminho);
+  if (S->escuta < 0 || bind(S->escuta, (struct sockaddr *)&end, sizeof(end)) != 0 || listen(S->escuta, SV_FILA) != 0)
+  {
+    printf("\nProblema na abertura do socket %s\n", caminho);
+    if (S->escuta >= 0)
+      close(S->escuta);
+    return 0;
+  }
+  // um cliente que fecha a conexao antes da resposta nao derruba o servico
+  signal(SIGPIPE, SIG_IGN);
+
+  for (;;)
+  {
+    fd = accept(S->escuta, NULL, NULL);
+    pthread_mutex_lock(&S->trava);
+    if (S->parar)
+    {
+      pthread_mutex_unlock(&S->trava);
+      if (fd >= 0)
+        close(fd);
+      break;
+    }
+    pthread_mutex_unlock(&S->trava);
+    if (fd < 0)
+    {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      printf("\nProblema no accept do socket %s\n", caminho);
+      break;
+    }
+    saida = fdopen(fd, "w");
+    if (saida == NULL)
+    {
+      close(fd);
+      continue;
+    }
+    con = cria_conexao(saida, fd);
+    L = (Tleitor *)malloc(sizeof(Tleitor));
+    L->S = S;
+    L->con = con;
+
+    pthread_mutex_lock(&S->trava);
+    con->prox = S->conexoes;
+    S->conexoes = con;
+    S->leitores++;
+    pthread_mutex_unlock(&S->trava);
+    if (pthread_create(&t, NULL, leitor, L) != 0)
+    {
+      // sem thread leitora a conexao eh desfeita
+      pthread_mutex_lock(&S->trava);
+      S->conexoes = con->prox;
+      S->leitores--;
+      pthread_mutex_unlock(&S->trava);
+      free(L);
+      solta_conexao(con);
+      continue;
+    }
+    pthread_detach(t);
+  }
+
+  // encerra a leitura das outras conexoes e espera os leitores, que ainda
+  // podem por pedidos na fila (as respostas continuam sendo escritas)
+  pthread_mutex_lock(&S->trava);
+  S->parar = 1;
+  for (con = S->conexoes; con != NULL; con = con->prox)
+    shutdown(con->fd, SHUT_RD);
+  while (S->leitores > 0)
+    pthread_cond_wait(&S->sem_leitores, &S->trava);
+  pthread_mutex_unlock(&S->trava);
+  close(S->escuta);
+  unlink(caminho);
+  return 1;
+}
+
+/* executa o servico; caminho "-" le os pedidos da entrada padrao e escreve as
+   respostas na saida padrao (as demais saidas vao para a de erro), e
+   nthreads <= 0 usa todos os nucleos */
+int executa_servico(char *caminho, int nthreads, Tparametros *par)
+{
+  Tservico S;
+  Tconexao *con;
+  FILE *saida;
+  pthread_t *threads;
+  double antes, agora;
+  int i, fd, ok = 1;
+
+  S.primeiro = S.ultimo = NULL;
+  S.conexoes = NULL;
+  S.leitores = 0;
+  S.fim = 0;
+  S.parar = 0;
+  S.escuta = -1;
+  S.atendidos = S.falhas = 0;
+  S.tempo_metodos = S.espera = S.sobrecarga = 0.0;
+  S.memoria = 0;
+
+  // as threads ja estao ocupadas com os pedidos: cada metodo usa uma so
+  // thread; a telemetria e a solucao inicial dependem do nome do arquivo e os
+  // arquivos de depuracao de nome fixo seriam gravados ao mesmo tempo
+  S.par = *par;
+  S.par.nthreads = 1;
+  S.par.grava_modelo = 0;
+  S.par.amostragem = 0.0;
+  S.par.solucao = NULL;
+  pthread_mutex_init(&S.trava, NULL);
+  pthread_cond_init(&S.sinal, NULL);
+  pthread_cond_init(&S.sem_leitores, NULL);
+
+  if (nthreads <= 0)
+    nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (nthreads < 1)
+    nthreads = 1;
+
+  antes = glp_mono_time();
+  threads = (pthread_t *)malloc(sizeof(pthread_t) * nthreads);
+  for (i = 0; i < nthreads; i++)
+    pthread_create(&threads[i], NULL, trabalhador, &S);
+
+  if (strcmp(caminho, "-") == 0)
+  {
+    // as respostas vao para uma copia do descritor da saida padrao e a saida
+    // padrao passa a ser a de erro: as saidas de depuracao (PRINTF) e as do
+    // GLPK nao se misturam as respostas
+    fflush(stdout);
+    fd = dup(STDOUT_FILENO);
+    saida = (fd >= 0) ? fdopen(fd, "w") : NULL;
+    if (saida == NULL || dup2(STDERR_FILENO, STDOUT_FILENO) < 0)
+    {
+      perror("servico: saida padrao");
+      if (saida != NULL)
+        fclose(saida);
+      else if (fd >= 0)
+        close(fd);
+      ok = 0;
+    }
+    else
+    {
+      con = cria_conexao(saida, fd);
+      le_pedidos(&S, con, stdin);
+      solta_conexao(con);
+    }
+  }
+  else
+    ok = atende_socket(&S, caminho);
+
+  // as threads terminam quando a fila esvazia
+  pthread_mutex_lock(&S.trava);
+  S.fim = 1;
+  pthread_cond_broadcast(&S.sinal);
+  pthread_mutex_unlock(&S.trava);
+  for (i = 0; i < nthreads; i++)
+    pthread_join(threads[i], NULL);
+  agora = glp_mono_time();
+
+  fprintf(stderr, "servico: %ld pedidos atendidos, %ld falhas, %d threads, tempo medio dos metodos=%lf, espera media na fila=%lf, sobrecarga media=%.1lf us, maior pico de memoria=%zu bytes, tempo total=%lf\n", S.atendidos, S.falhas, nthreads, S.atendidos ? S.tempo_metodos / S.atendidos : 0.0, S.atendidos ? S.espera / S.atendidos : 0.0, S.atendidos ? 1e6 * S.sobrecarga / S.atendidos : 0.0, S.memoria, glp_difftime(agora, antes));
+
+  pthread_cond_destroy(&S.sem_leitores);
+  pthread_cond_destroy(&S.sinal);
+  pthread_mutex_destroy(&S.trava);
+  free(threads);
+  return ok;
+}
+
+/* eof */
@@ -0,0 +1,134 @@
+/* solucao.c
+leitura e validacao dos arquivos de solucao (.sol) gravados por
+gerar_arquivo_sol
+
+Formato:
+   z k
+   mochila j t      (para cada mochila j = 1..k, com t itens)
+   i1 i2 ... it     (numeros dos itens da mochila j)
+
+A solucao lida vira o vetor index (mochila de cada posicao de I.item, 0 =
+fora das mochilas) e eh validada: cada item em no maximo uma mochila, a carga
+de cada mochila dentro da capacidade e o valor recalculado a partir dos itens
+(o z do arquivo so eh comparado). Com -w, a melhor solucao valida eh a solucao
+inicial do branch-and-bound do tipo 2 (injetada pela callback em GLP_IHEUR).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mochila_multipla.h"
+
+/* valida a solucao index (carga de cada mochila <= capacidade) e calcula o
+   seu valor em *z; devolve 0 se ela for inviavel */
+int valida_solucao(Tinstance I, const int *index, double *z)
+{
+  long long *carga;
+  int i, j, ok = 1;
+
+  carga = (long long *)calloc(I.k, sizeof(long long));
+  *z = 0.0;
+  for (i = 0; i < I.n; i++)
+  {
+    j = index[i] - 1;
+    if (j < 0)
+      continue;
+    if (j >= I.k)
+    {
+      ok = 0;
+      break;
+    }
+    carga[j] += I.item[i].peso;
+    *z += I.item[i].valor;
+  }
+  for (j = 0; ok && j < I.k; j++)
+    if (carga[j] > I.C[j])
+    {
+      PRINTF("solucao: mochila %d com carga %lld > %d\n", j + 1, carga[j], I.C[j]);
+      ok = 0;
+    }
+  free(carga);
+  return ok;
+}
+
+/* le o arquivo .sol da instancia I em index; devolve o valor da solucao ou
+   -1 se o arquivo nao existir ou a solucao for invalida */
+double le_arquivo_sol(char *arquivo, Tinstance I, int *index)
+{
+  FILE *fin;
+  double z_arquivo, z = -1.0;
+  int *posicao, k, j, t, r, num, l, ok = 0;
+
+  fin = fopen(arquivo, "r");
+  if (!fin)
+    return -1.0;
+
+  // posicao em I.item de cada numero de item
+  posicao = (int *)malloc(sizeof(int) * (I.n + 1));
+  for (num = 0; num <= I.n; num++)
+    posicao[num] = -1;
+  for (l = 0; l < I.n; l++)
+    if (I.item[l].num >= 1 && I.item[l].num <= I.n)
+      posicao[I.item[l].num] = l;
+  for (l = 0; l < I.n; l++)
+    index[l] = 0;
+
+  if (fscanf(fin, "%lf %d", &z_arquivo, &k) != 2 || k != I.k)
+    goto fim;
+  for (j = 1; j <= k; j++)
+  {
+    if (fscanf(fin, " mochila %d %d", &r, &t) != 2 || r != j || t < 0)
+      goto fim;
+    for (; t > 0; t--)
+    {
+      if (fscanf(fin, "%d", &num) != 1 || num < 1 || num > I.n || posicao[num] < 0)
+        goto fim;
+      if (index[posicao[num]] != 0) // item em duas mochilas
+        goto fim;
+      index[posicao[num]] = j;
+    }
+  }
+  ok = valida_solucao(I, index, &z);
+  if (ok && (z_arquivo > z + 0.5 || z_arquivo < z - 0.5))
+    PRINTF("solucao: %s informa z=%.0lf, mas os itens somam %.0lf\n", arquivo, z_arquivo, z);
+
+fim:
+  if (!ok)
+  {
+    fprintf(stderr, "Solucao invalida no arquivo %s\n", arquivo);
+    z = -1.0;
+  }
+  fclose(fin);
+  free(posicao);
+  return z;
+}
+
+/* procura a melhor solucao valida entre os arquivos <instancia>.sol e
+   <instancia>-<tipo>.sol; devolve o seu valor (em index) ou -1 */
+double melhor_arquivo_sol(char *instancia, Tinstance I, int *index)
+{
+  char nome[FILENAME_MAX];
+  double z, melhor = -1.0;
+  int *atual, tipo, i;
+
+  atual = (int *)malloc(sizeof(int) * I.n);
+  for (tipo = 0; tipo <= TIPO_MAX; tipo++)
+  {
+    if (tipo == 0)
+      snprintf(nome, sizeof(nome), "%s.sol", instancia);
+    else
+      snprintf(nome, sizeof(nome), "%s-%d.sol", instancia, tipo);
+    z = le_arquivo_sol(nome, I, atual);
+    if (z > melhor)
+    {
+      melhor = z;
+      for (i = 0; i < I.n; i++)
+        index[i] = atual[i];
+      PRINTF("solucao: %s z=%.0lf\n", nome, z);
+    }
+  }
+  free(atual);
+  return melhor;
+}
+
+/* eof */
@@ -0,0 +1,172 @@
+/* telemetria.c
+amostras do branch-and-bound ao longo do tempo (-m <ms>), gravadas em
+<instancia>-<tipo>.bb para as curvas de gap x tempo
+
+Formato (csv, uma linha por amostra):
+   tempo;nos;ativos;primal;dual;gap
+com o tempo em segundos desde o inicio do metodo e o gap relativo do GLPK
+(vazio enquanto nao ha solucao inteira). A callback registra uma amostra a
+cada periodo e sempre que o B&B acha uma solucao melhor (GLP_IBINGO); a ultima
+linha tem os limitantes finais do metodo. Os metodos sem o B&B do GLPK (sem a
+callback) deixam so o cabecalho.
+
+A callback nao grava nada: a amostra vai para um anel de TL_ANEL posicoes
+alocado na abertura e uma thread gravadora esvazia o anel quando ele passa de
+TL_LOTE amostras (e no fechamento). A callback so espera pela trava do anel,
+que a gravadora segura apenas para copiar as amostras; com o anel cheio (disco
+lento) a amostra eh descartada e contada, mas o solver nunca espera pelo
+arquivo.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <pthread.h>
+#include <glpk.h>
+#include "mochila_multipla.h"
+
+#define TL_ANEL 4096 /* amostras no anel */
+#define TL_LOTE 1024 /* amostras que acordam a gravadora */
+
+typedef struct
+{
+  double tempo;
+  int nos, ativos;
+  double primal, dual, gap;
+} Tamostra;
+
+struct Ttelemetria
+{
+  FILE *arq;
+  double inicio;          /* instante de abertura (glp_mono_time) */
+  double periodo;         /* intervalo entre amostras (em ms) */
+  double proxima;         /* instante da proxima amostra periodica */
+  Tamostra anel[TL_ANEL];
+  Tamostra lote[TL_ANEL]; /* copia da gravadora */
+  long escritas, lidas;   /* amostras postas e tiradas do anel */
+  long descartadas;       /* amostras perdidas com o anel cheio */
+  int fim;                /* 1 = esvaziar o anel e terminar */
+  pthread_mutex_t trava;  /* protege o anel, escritas, lidas e fim */
+  pthread_cond_t sinal;
+  pthread_t gravadora;
+};
+
+/* laco da thread gravadora: copia as amostras do anel e grava fora da trava */
+static void *gravadora(void *arg)
+{
+  Ttelemetria *T = (Ttelemetria *)arg;
+  Tamostra *a;
+  long t, n;
+  int fim;
+
+  for (;;)
+  {
+    pthread_mutex_lock(&T->trava);
+    while (!T->fim && T->escritas - T->lidas < TL_LOTE)
+      pthread_cond_wait(&T->sinal, &T->trava);
+    n = T->escritas - T->lidas;
+    for (t = 0; t < n; t++)
+      T->lote[t] = T->anel[(T->lidas + t) % TL_ANEL];
+    T->lidas += n;
+    fim = T->fim;
+    pthread_mutex_unlock(&T->trava);
+
+    for (t = 0; t < n; t++)
+    {
+      a = &T->lote[t];
+      fprintf(T->arq, "%.6lf;%d;%d;%.0lf;%.2lf;", a->tempo, a->nos, a->ativos, a->primal, a->dual);
+      if (a->gap < DBL_MAX)
+        fprintf(T->arq, "%.6lf", a->gap);
+      fputc('\n', T->arq);
+    }
+    if (fim)
+      break;
+  }
+  return NULL;
+}
+
+/* abre o arquivo <filename>-<tipo>.bb e a gravadora; periodo em ms. Devolve
+   NULL se o arquivo nao puder ser criado */
+Ttelemetria *telemetria_abre(char *filename, int tipo, double periodo)
+{
+  Ttelemetria *T;
+  char nomeArquivo[FILENAME_MAX];
+  FILE *arq;
+
+  snprintf(nomeArquivo, sizeof(nomeArquivo), "%s-%d.bb", filename, tipo);
+  arq = fopen(nomeArquivo, "w");
+  if (arq == NULL)
+    return NULL;
+  fprintf(arq, "tempo;nos;ativos;primal;dual;gap\n");
+
+  T = (Ttelemetria *)malloc(sizeof(Ttelemetria));
+  T->arq = arq;
+  T->inicio = glp_mono_time();
+  T->periodo = periodo;
+  T->proxima = T->inicio;
+  T->escritas = T->lidas = T->descartadas = 0;
+  T->fim = 0;
+  pthread_mutex_init(&T->trava, NULL);
+  pthread_cond_init(&T->sinal, NULL);
+  pthread_create(&T->gravadora, NULL, gravadora, T);
+  return T;
+}
+
+/* poe no anel os limitantes de info (sem testar o periodo) */
+static void registra(Ttelemetria *T, double agora, my_infoT *info)
+{
+  Tamostra *a;
+
+  pthread_mutex_lock(&T->trava);
+  if (T->escritas - T->lidas == TL_ANEL)
+    T->descartadas++;
+  else
+  {
+    a = &T->anel[T->escritas % TL_ANEL];
+    a->tempo = glp_difftime(agora, T->inicio);
+    a->nos = info->nodes;
+    a->ativos = info->ativos;
+    a->primal = info->best_primalBound;
+    a->dual = info->best_dualBound;
+    a->gap = info->gap;
+    T->escritas++;
+    if (T->escritas - T->lidas == TL_LOTE)
+      pthread_cond_signal(&T->sinal);
+  }
+  pthread_mutex_unlock(&T->trava);
+}
+
+/* amostra da callback: a cada periodo ou, com melhoria = 1, sempre */
+void telemetria_amostra(Ttelemetria *T, int melhoria, my_infoT *info)
+{
+  double agora = glp_mono_time();
+
+  if (!melhoria && agora < T->proxima)
+    return;
+  if (agora >= T->proxima)
+    T->proxima = agora + T->periodo;
+  registra(T, agora, info);
+}
+
+/* grava a amostra final (limitantes de info, se o metodo passou pela
+   callback), espera a gravadora e fecha o arquivo */
+void telemetria_fecha(Ttelemetria *T, my_infoT *info)
+{
+  if (T->escritas > 0)
+    registra(T, glp_mono_time(), info);
+  pthread_mutex_lock(&T->trava);
+  T->fim = 1;
+  pthread_cond_signal(&T->sinal);
+  pthread_mutex_unlock(&T->trava);
+  pthread_join(T->gravadora, NULL);
+
+  if (T->descartadas > 0)
+    PRINTF("telemetria: %ld amostras descartadas (anel cheio)\n", T->descartadas);
+  fclose(T->arq);
+  pthread_cond_destroy(&T->sinal);
+  pthread_mutex_destroy(&T->trava);
+  free(T);
+}
+
+/* eof */
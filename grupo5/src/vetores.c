@@ -0,0 +1,163 @@
+/* vetores.c
+itens como vetores separados (SoA) e os lacos das heuristicas construtivas
+
+O vetor de Titem continua sendo a forma de troca entre os metodos (a ordem das
+colunas do modelo, o B&B e a LNS dependem dele), mas as heuristicas que
+percorrem todos os itens copiam valor, peso e mochila para vetores separados
+(Tsoa), trabalham sobre eles e devolvem so as mochilas. A copia eh O(n) e os
+lacos abaixo percorrem memoria contigua de um unico tipo, sem desvios
+dependentes dos dados, de modo que o compilador os vetoriza (-O2 ou -O3, sem
+intrinsics, para continuar portavel).
+
+As ordenacoes nao movem os itens: ordena_permutacao devolve a permutacao das
+posicoes (radix sort estavel dos bits da chave; empates ficam na ordem das
+posicoes, o que torna as heuristicas deterministicas).
+
+Os vetores separados e os da ordenacao saem da arena de quem chama (ver
+arena.c) e voltam com ela.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <float.h>
+#include "mochila_multipla.h"
+
+// mochilas testadas de cada vez em primeira_mochila
+#define BLOCO_MOCHILAS 16
+
+/* copia os itens de I para vetores separados (alocados na arena A); todos
+   fora das mochilas */
+void soa_carrega(Tsoa *S, Tinstance I, Tarena *A)
+{
+  int i;
+
+  S->n = I.n;
+  S->valor = (double *)arena_aloca(A, sizeof(double) * I.n);
+  S->peso = (int *)arena_aloca(A, sizeof(int) * I.n);
+  S->index = (int *)arena_aloca_zerada(A, sizeof(int) * I.n);
+  S->razao = (double *)arena_aloca(A, sizeof(double) * I.n);
+  S->ordem = (int *)arena_aloca(A, sizeof(int) * I.n);
+  for (i = 0; i < I.n; i++)
+  {
+    S->valor[i] = I.item[i].valor;
+    S->peso[i] = I.item[i].peso;
+  }
+}
+
+/* devolve as mochilas dos itens para I.item[].index */
+void soa_devolve(Tsoa *S, Tinstance I)
+{
+  int i;
+
+  for (i = 0; i < I.n; i++)
+    I.item[i].index = S->index[i];
+}
+
+/* razao valor/peso de cada item (itens de peso zero ficam na frente) */
+void calcula_razao(const double *restrict valor, const int *restrict peso, double *restrict razao, int n)
+{
+  int i;
+
+  for (i = 0; i < n; i++)
+    razao[i] = (peso[i] > 0) ? valor[i] / (double)peso[i] : DBL_MAX;
+}
+
+/* bits de um double que, comparados como inteiros sem sinal, seguem a ordem
+   decrescente dos valores */
+static uint64_t bits_decrescente(double x)
+{
+  uint64_t u;
+
+  memcpy(&u, &x, sizeof(u));
+  u = (u >> 63) ? ~u : (u | 0x8000000000000000ull); // ordem crescente
+  return ~u;
+}
+
+/* ordem[] recebe as posicoes 0..n-1 em ordem decrescente de chave[] (radix
+   sort de 8 bits por passada, pulando os bytes iguais em todas as chaves) */
+void ordena_permutacao(const double *chave, int n, int *ordem, Tarena *A)
+{
+  uint64_t *u, *u2, *ut;
+  int *o, *o2, *ot, cont[256], d, i, b, soma, t;
+  Tmarca m = arena_marca(A);
+
+  u = (uint64_t *)arena_aloca(A, sizeof(uint64_t) * n);
+  u2 = (uint64_t *)arena_aloca(A, sizeof(uint64_t) * n);
+  o2 = (int *)arena_aloca(A, sizeof(int) * n);
+  o = ordem;
+  for (i = 0; i < n; i++)
+  {
+    u[i] = bits_decrescente(chave[i]);
+    o[i] = i;
+  }
+
+  for (d = 0; d < 64 && n > 0; d += 8)
+  {
+    memset(cont, 0, sizeof(cont));
+    for (i = 0; i < n; i++)
+      cont[(u[i] >> d) & 0xFF]++;
+    if (cont[(u[0] >> d) & 0xFF] == n)
+      continue; // byte igual em todas as chaves
+    for (soma = 0, b = 0; b < 256; b++)
+    {
+      t = cont[b];
+      cont[b] = soma;
+      soma += t;
+    }
+    for (i = 0; i < n; i++)
+    {
+      b = (u[i] >> d) & 0xFF;
+      u2[cont[b]] = u[i];
+      o2[cont[b]++] = o[i];
+    }
+    ut = u, u = u2, u2 = ut;
+    ot = o, o = o2, o2 = ot;
+  }
+  if (o != ordem)
+    memcpy(ordem, o, sizeof(int) * n);
+
+  arena_volta(A, m);
+}
+
+/* primeira mochila (first-fit) em que cabe um item de peso p, ou -1; cada
+   bloco de mochilas eh testado inteiro, sem desvio, e so o bloco em que o
+   item cabe eh percorrido de novo */
+int primeira_mochila(const int *restrict C, int k, int peso)
+{
+  int j0, j, fim, cabe;
+
+  for (j0 = 0; j0 < k; j0 += BLOCO_MOCHILAS)
+  {
+    fim = (j0 + BLOCO_MOCHILAS < k) ? j0 + BLOCO_MOCHILAS : k;
+    cabe = 0;
+    for (j = j0; j < fim; j++)
+      cabe |= (C[j] >= peso);
+    if (cabe)
+      for (j = j0; j < fim; j++)
+        if (C[j] >= peso)
+          return j;
+  }
+  return -1;
+}
+
+/* valor da solucao: soma dos valores dos itens dentro das mochilas (quatro
+   somas parciais, que o compilador pode manter em registradores vetoriais) */
+double objetivo(const double *restrict valor, const int *restrict index, int n)
+{
+  double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+  int i;
+
+  for (i = 0; i + 3 < n; i += 4)
+  {
+    s0 += (index[i] != 0) ? valor[i] : 0.0;
+    s1 += (index[i + 1] != 0) ? valor[i + 1] : 0.0;
+    s2 += (index[i + 2] != 0) ? valor[i + 2] : 0.0;
+    s3 += (index[i + 3] != 0) ? valor[i + 3] : 0.0;
+  }
+  for (; i < n; i++)
+    s0 += (index[i] != 0) ? valor[i] : 0.0;
+  return (s0 + s1) + (s2 + s3);
+}
+
+/* eof */
@@ -0,0 +1,33 @@
+#!/bin/sh
+# confere o branch-and-price (tipo 16) com o otimo da programacao dinamica
+# (tipo 29) em instancias pequenas com capacidades iguais, em que a simetria
+# das mochilas deixa a relaxacao do mestre fracionaria
+#
+# uso: testes/confere_16.sh [programa]   (padrao: ./mochila_multipla-DEBUG)
+
+programa=${1:-./mochila_multipla-DEBUG}
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+erros=0
+total=0
+
+for k in 3 4; do
+  for classe in 1 2 3 4 5; do
+    for semente in 1 2 3; do
+      inst="$dir/i$k-$classe-$semente.mochila"
+      "$programa" -gera 11 "$k" 100 "$classe" s "$semente" "$inst" > /dev/null 2>&1 || exit 2
+      # capacidades iguais: todas recebem a primeira
+      awk -v k="$k" 'NR == 2 { c = $1 } NR >= 2 && NR <= k + 1 { print c; next } { print }' "$inst" > "$inst.t" && mv "$inst.t" "$inst"
+      z16=$("$programa" "$inst" 16 -l 2000 2> /dev/null | tail -n 1 | cut -d';' -f5)
+      z29=$("$programa" "$inst" 29 -l 10000 2> /dev/null | tail -n 1 | cut -d';' -f5)
+      total=$((total + 1))
+      if [ -z "$z16" ] || [ "$z16" != "$z29" ]; then
+        echo "$(basename "$inst"): tipo 16 = $z16, tipo 29 = $z29"
+        erros=$((erros + 1))
+      fi
+    done
+  done
+done
+
+echo "tipo 16: $((total - erros)) de $total instancias no otimo"
+[ "$erros" -eq 0 ]